@@ -0,0 +1,964 @@
+/**************************************************************************************************************
+
+    NAME
+        bench.c
+
+    DESCRIPTION
+        Benchmarks for the expression evaluator.
+	This file includes eval.c, so that internal structures can be inspected ; it must be compiled alone :
+
+		$ cc -O2 bench.c -lm -lpthread
+		$ ./a.out [iterations [benchmark...]]
+
+	where benchmark is one of the names listed below ; all benchmarks are run when none is specified.
+	Each benchmark reports the time taken by one operation, the number of operations per second, and the
+	number of calls to eval_malloc() and eval_realloc() per operation, which eval.c is made to count by
+	redefining these macros.
+
+	- dispatch :
+		Runs a few compiled programs through evaluator_run_bound(), and reports the time taken by one
+		run, and by one instruction of the program. Compile with -DEVAL_NO_COMPUTED_GOTO to measure the
+		switch-based dispatch instead of the threaded one.
+	- size :
+		Runs small, medium and huge programs, the huge ones having thousands of instructions.
+	- functions :
+		Runs calls to functions having many arguments, such as avg(), var() and dev().
+	- callback :
+		Runs programs referencing many variables, whose values are supplied by a callback through
+		evaluator_run(), then the same programs through evaluator_run_bound().
+	- registers :
+		Runs programs that save values into registers and recall them.
+	- formulas :
+		Compiles a corpus of real-world formulas with evaluator_compile(), and evaluates them with
+		evaluate_ex(), which takes compiled programs from the cache.
+	- lexer :
+		Generates a corpus of random formulas, then reports the time taken by eval_lex() to split them
+		into tokens, and the time taken by evaluator_compile() to compile them.
+	- folding :
+		Compiles operations whose operands are constants, which are folded at compile time, and reports
+		the compile time. Each folded value is checked against the value computed at run time by the same
+		operation applied to variables, for eval_double and double programs ; mismatches are listed.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+# include	<stdlib.h>
+# include	<string.h>
+
+
+/*==============================================================================================================
+
+	Memory allocation functions used by eval.c, which count the number of allocations.
+
+  ==============================================================================================================*/
+static unsigned long	bench_allocations	=  0 ;
+
+
+static void *	bench_malloc ( size_t  size )
+   {
+	bench_allocations ++ ;
+
+	return ( malloc ( size ) ) ;
+    }
+
+
+static void *	bench_realloc ( void *  p, size_t  size )
+   {
+	bench_allocations ++ ;
+
+	return ( realloc ( p, size ) ) ;
+    }
+
+
+# define	eval_malloc( size )		bench_malloc ( size )
+# define	eval_realloc( p, size )		bench_realloc ( p, size )
+
+# include	"eval.c"
+
+
+// Default number of runs of each expression
+# define	BENCH_ITERATIONS		1000000
+
+// Number of formulas in the lexer benchmark corpus, and number of times the corpus is lexed
+# define	BENCH_LEXER_FORMULAS		20000
+# define	BENCH_LEXER_PASSES		10
+
+// Size of the buffer used to generate one formula
+# define	BENCH_FORMULA_SIZE		65536
+
+// Number of terms of the huge expressions, which are run iterations / BENCH_HUGE_DIVISOR times
+# define	BENCH_HUGE_TERMS		2000
+# define	BENCH_HUGE_DIVISOR		100
+
+// Number of arguments of the function calls ; calls are run less often when they have more arguments
+# define	BENCH_FEW_ARGUMENTS		8
+# define	BENCH_MANY_ARGUMENTS		100
+
+// The formula corpus is compiled and evaluated iterations / BENCH_FORMULA_DIVISOR times
+# define	BENCH_FORMULA_DIVISOR		100
+
+// Max number of variables of a benchmarked expression
+# define	BENCH_VALUES			16
+
+
+/*==============================================================================================================
+
+	Expressions used by the dispatch benchmark. They only use cheap operators, so that the dispatch cost
+	is not hidden by the cost of the operations themselves.
+
+  ==============================================================================================================*/
+static char *	bench_dispatch_expressions []	=
+   {
+	"$x + $y",
+	"$x * $y + $x - $y",
+	"( $x + 1 ) * ( $y - 2 ) + ( $x - 3 ) * ( $y + 4 ) - ( $x + 5 ) * ( $y - 6 )",
+	"$x + $y * 2 - $x / 3 + $y * 4 - $x / 5 + $y * 6 - $x / 7 + $y * 8 - $x / 9 + $y * 10 - $x / 11",
+	"- $x + - $y * - ( $x - $y ) / - ( $x + $y ) - - $x",
+	"( $x + $y ) #0! * #0? + #0? / 2",
+	"abs ( $x - $y ) + abs ( $y - $x )",
+	NULL
+    } ;
+
+
+/*==============================================================================================================
+
+	Expressions used by the size, callback and registers benchmarks. Huge expressions are generated by
+	bench_size().
+
+  ==============================================================================================================*/
+static char *	bench_small_expressions []	=
+   {
+	"$x + 1",
+	"$x * $y - 3",
+	NULL
+    } ;
+
+static char *	bench_medium_expressions []	=
+   {
+	"sqrt ( ( $x - $a ) ** 2 + ( $y - $b ) ** 2 ) / ( 1 + abs ( $c ) ) - $d * log ( 1 + $x * $x )",
+	"( $a * $x ** 3 + $b * $x ** 2 + $c * $x + $d ) / ( $a * $y ** 3 + $b * $y ** 2 + $c * $y + $d + 1 )",
+	NULL
+    } ;
+
+static char *	bench_callback_expressions []	=
+   {
+	"$a + $b + $c + $d + $e + $f + $x + $y",
+	"$a * $x + $b * $y + $c * $x * $y + $d * ( $x + $e ) * ( $y + $f ) - $a * $b * $c * $d * $e * $f",
+	"( $rate + $a ) * ( $amount - $b ) / ( $period + $c ) + ( $rate - $d ) * ( $amount + $e ) / ( $period - $f )",
+	NULL
+    } ;
+
+static char *	bench_register_expressions []	=
+   {
+	"( $x + $y ) #0! * #0? + #0? / 2",
+	"( $x * $x ) #0! + ( $y * $y ) #1! + #0? * #1? + sqrt ( #0? + #1? ) - #0? / ( 1 + #1? )",
+	"$x #0! + 1 #1! + #0? * #1? #2! + #1? * #2? #3! + #2? * #3? #4! + #3? * #4? + #4?",
+	NULL
+    } ;
+
+
+/*==============================================================================================================
+
+	Real-world formulas used by the formulas benchmark.
+
+  ==============================================================================================================*/
+static char *	bench_formula_corpus []	=
+   {
+	// Finance
+	"$principal * ( $rate / 12 ) / ( 1 - ( 1 + $rate / 12 ) ** ( - $months ) )",
+	"$principal * ( 1 + $rate / $periods ) ** ( $periods * $years )",
+	"$cashflow / ( 1 + $rate ) + $cashflow / ( 1 + $rate ) ** 2 + $cashflow / ( 1 + $rate ) ** 3 - $investment",
+	"( $price - $cost ) / $price * 100",
+	"$spot * exp ( ( $rate - $dividend ) * $time )",
+	// Physics
+	"$mass * $velocity ** 2 / 2 + $mass * 9.80665 * $height",
+	"6.674e-11 * $m1 * $m2 / $distance ** 2",
+	"$v0 * $t * cos ( $angle ) + $x0",
+	"$v0 * $t * sin ( $angle ) - 9.80665 * $t ** 2 / 2 + $y0",
+	"2 * PI * sqrt ( $length / 9.80665 )",
+	"$pressure * $volume / ( 8.314462618 * $temperature )",
+	// Geometry
+	"sqrt ( ( $x2 - $x1 ) ** 2 + ( $y2 - $y1 ) ** 2 + ( $z2 - $z1 ) ** 2 )",
+	"dist ( $x1, $y1, $x2, $y2 )",
+	"atan2 ( $y2 - $y1, $x2 - $x1 ) * 180 / PI",
+	"PI * $radius ** 2 * $height / 3",
+	"sqrt ( $s * ( $s - $a ) * ( $s - $b ) * ( $s - $c ) )",
+	// Statistics
+	"avg ( $q1, $q2, $q3, $q4 )",
+	"dev ( $q1, $q2, $q3, $q4 ) / avg ( $q1, $q2, $q3, $q4 ) * 100",
+	"exp ( - ( $x - $mean ) ** 2 / ( 2 * $sigma ** 2 ) ) / ( $sigma * sqrt ( 2 * PI ) )",
+	"1 / ( 1 + exp ( - ( $w0 + $w1 * $x1 + $w2 * $x2 + $w3 * $x3 ) ) )",
+	// Engineering
+	"$voltage ** 2 / $resistance * $hours / 1000",
+	"20 * log10 ( $output / $input )",
+	"$celsius * 9 / 5 + 32",
+	"floor ( $width * $height * $depth / 1728 * 100 ) / 100",
+	"abs ( $value - $low ) / ( $high - $low ) * 100",
+	NULL
+    } ;
+
+
+/*==============================================================================================================
+
+	Items used to generate the formulas of the lexer benchmark.
+
+  ==============================================================================================================*/
+static char *	bench_lexer_operators []	=
+   { "+", "-", "*", "/", "\\", "%", "**", "<<", ">>", "&", "|", "^" } ;
+
+static char *	bench_lexer_constants []	=
+   { "pi", "e", "PI_2", "SQRT2", "phi", "LOG10E" } ;
+
+static char *	bench_lexer_variables []	=
+   { "$x", "$y", "$width", "$height", "$rate_1", "$rate_2" } ;
+
+static char *	bench_lexer_functions []	=
+   { "sqrt", "abs", "log", "exp", "atan2", "avg", "dist" } ;
+
+static int	bench_lexer_function_args []	=
+   {  1,      1,     1,     1,     2,       3,     4 } ;
+
+# define	BENCH_COUNT(array)		( ( int ) ( sizeof ( array ) / sizeof ( array [0] ) ) )
+
+static unsigned int	bench_seed	=  1 ;
+
+
+/*==============================================================================================================
+
+    bench_random -
+        Returns a pseudo-random number between 0 and count - 1. A local generator is used, so that the corpus
+	is the same on every platform.
+
+  ==============================================================================================================*/
+static int	bench_random ( int  count )
+   {
+	bench_seed	=  bench_seed * 1103515245u + 12345u ;
+
+	return ( ( int ) ( ( bench_seed >> 16 ) % ( unsigned int ) count ) ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_generate_expression, bench_generate_operand -
+        Appends a random expression or operand to the specified buffer and returns a pointer to its end.
+
+  ==============================================================================================================*/
+static char *	bench_generate_expression ( char *  p, int  depth ) ;
+
+static char *	bench_generate_operand ( char *  p, int  depth )
+   {
+	int	i, j ;
+
+
+	switch  ( bench_random ( ( depth  >  0 ) ?  7 : 5 ) )
+	   {
+		case	0 :
+			p	+=  sprintf ( p, "%d", bench_random ( 100000 ) ) ;
+			break ;
+
+		case	1 :
+			p	+=  sprintf ( p, "%d.%03de%d", bench_random ( 1000 ), bench_random ( 1000 ), bench_random ( 10 ) ) ;
+			break ;
+
+		case	2 :
+			p	+=  sprintf ( p, "0x%X", bench_random ( 65536 ) ) ;
+			break ;
+
+		case	3 :
+			p	+=  sprintf ( p, "%s", bench_lexer_constants [ bench_random ( BENCH_COUNT ( bench_lexer_constants ) ) ] ) ;
+			break ;
+
+		case	4 :
+			p	+=  sprintf ( p, "%s", bench_lexer_variables [ bench_random ( BENCH_COUNT ( bench_lexer_variables ) ) ] ) ;
+			break ;
+
+		case	5 :
+			i	 =  bench_random ( BENCH_COUNT ( bench_lexer_functions ) ) ;
+			p	+=  sprintf ( p, "%s ( ", bench_lexer_functions [i] ) ;
+
+			for  ( j = 0 ; j  <  bench_lexer_function_args [i] ; j ++ )
+			   {
+				if  ( j )
+					p	+=  sprintf ( p, ", " ) ;
+
+				p	=  bench_generate_expression ( p, depth - 1 ) ;
+			    }
+
+			p	+=  sprintf ( p, " )" ) ;
+			break ;
+
+		case	6 :
+			p	+=  sprintf ( p, "( " ) ;
+			p	 =  bench_generate_expression ( p, depth - 1 ) ;
+			p	+=  sprintf ( p, " )" ) ;
+			break ;
+	    }
+
+	return ( p ) ;
+    }
+
+
+static char *	bench_generate_expression ( char *  p, int  depth )
+   {
+	int	count	=  1 + bench_random ( 4 ) ;
+	int	i ;
+
+
+	if  ( ! bench_random ( 4 ) )
+		p	+=  sprintf ( p, "-" ) ;
+
+	p	=  bench_generate_operand ( p, depth ) ;
+
+	for  ( i = 1 ; i  <  count ; i ++ )
+	   {
+		p	+=  sprintf ( p, " %s ", bench_lexer_operators [ bench_random ( BENCH_COUNT ( bench_lexer_operators ) ) ] ) ;
+		p	 =  bench_generate_operand ( p, depth ) ;
+	    }
+
+	return ( p ) ;
+    }
+
+/*==============================================================================================================
+
+    bench_time -
+        Returns the current processor time, in seconds.
+
+  ==============================================================================================================*/
+static double	bench_time ( )
+   {
+	return ( ( double ) clock ( ) / CLOCKS_PER_SEC ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_report -
+        Prints the time taken by one operation, the number of operations per second and the number of
+	allocations per operation. The caller completes the line.
+
+  ==============================================================================================================*/
+static void	bench_report ( double  elapsed, double  count, unsigned long  allocations, char *  unit )
+   {
+	if  ( elapsed  <=  0 )
+		elapsed		=  1e-9 ;
+
+	printf ( "\t%9.1f ns/%-7s %10.0f %ss/s  %6.2f allocs/%-7s  ",
+			elapsed * 1e9 / count, unit,
+			count / elapsed, unit,
+			( double ) allocations / count, unit ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_callback -
+        Variable callback used by the callback and formulas benchmarks. Variables are looked up in a table,
+	as an application would do ; the value of $x changes on each run, so that runs cannot be optimized
+	away, and variables that are not in the table are given a value depending on the length of their
+	name.
+
+  ==============================================================================================================*/
+static char *		bench_variable_names []		=
+   { "a", "b", "c", "d", "e", "f", "y", "rate", "amount", "period" } ;
+
+static eval_double	bench_variable_values []	=
+   { 0.5, 1.5,  2.5, 3.5, 4.5, 5.5, 0.5,  0.05,   1000,     12 } ;
+
+static eval_double	bench_x		=  0 ;
+
+
+static int	EVAL_CALLBACK ( bench_callback )
+   {
+	int	i ;
+
+
+	if  ( ! strcmp ( vname, "x" ) )
+	   {
+		* value		=  bench_x ;
+		return ( EVAL_CALLBACK_OK ) ;
+	    }
+
+	for  ( i = 0 ; i  <  BENCH_COUNT ( bench_variable_names ) ; i ++ )
+	   {
+		if  ( ! strcmp ( vname, bench_variable_names [i] ) )
+		   {
+			* value		=  bench_variable_values [i] ;
+			return ( EVAL_CALLBACK_OK ) ;
+		    }
+	    }
+
+	* value		=  ( eval_double ) ( 1 + strlen ( vname ) ) ;
+
+	return ( EVAL_CALLBACK_OK ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_run -
+        Compiles the specified expression, then measures the cost of running it, either through
+	evaluator_run_bound() or, when a callback is specified, through evaluator_run().
+
+  ==============================================================================================================*/
+static void	bench_run ( char *  expression, int  iterations, int  flags, eval_callback  callback )
+   {
+	evaluator_program *	program ;
+	eval_double		values [ BENCH_VALUES ] ;
+	double			result, sum ;
+	double			start, elapsed ;
+	unsigned long		allocations ;
+	int			instructions ;
+	int			i ;
+
+
+	program		=  evaluator_compile_ex ( expression, flags ) ;
+
+	if  ( program  ==  NULL )
+	   {
+		evaluator_perror ( ) ;
+		return ;
+	    }
+
+	if  ( program -> variable_count  >  BENCH_VALUES )
+	   {
+		printf ( "\tToo many variables (%d) : %.60s\n", program -> variable_count, expression ) ;
+		evaluator_free_program ( program ) ;
+		return ;
+	    }
+
+	for  ( i = 0 ; i  <  BENCH_VALUES ; i ++ )
+		values [i]	=  0.5 + i ;
+
+	instructions	=  program -> code_size ;
+	sum		=  0 ;
+	allocations	=  bench_allocations ;
+	start		=  bench_time ( ) ;
+
+	for  ( i = 0 ; i  <  iterations ; i ++ )
+	   {
+		values [0]	=  ( eval_double ) i ;
+		bench_x		=  ( eval_double ) i ;
+
+		if  ( callback  !=  NULL )
+			evaluator_run ( program, & result, callback ) ;
+		else
+			evaluator_run_bound ( program, & result, values ) ;
+
+		sum	+=  result ;
+	    }
+
+	elapsed		=  bench_time ( ) - start ;
+	allocations	=  bench_allocations - allocations ;
+
+	bench_report ( elapsed, iterations, allocations, "run" ) ;
+	printf ( "%6.2f ns/instruction  (%4d instructions)  %.60s%s\n",
+			elapsed * 1e9 / iterations / ( ( instructions ) ?  instructions : 1 ),
+			instructions, expression, ( strlen ( expression )  >  60 ) ?  "..." : "" ) ;
+
+	// Prevent the compiler from optimizing the loop away
+	if  ( sum  ==  -1 )
+		printf ( "%g\n", sum ) ;
+
+	evaluator_free_program ( program ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_run_list -
+        Runs a NULL-terminated list of expressions.
+
+  ==============================================================================================================*/
+static void	bench_run_list ( char **  expressions, int  iterations, int  flags, eval_callback  callback )
+   {
+	for  ( ; * expressions  !=  NULL ; expressions ++ )
+		bench_run ( * expressions, iterations, flags, callback ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_dispatch -
+        Measures the cost of running the dispatch expressions.
+
+  ==============================================================================================================*/
+static void	bench_dispatch ( int  iterations )
+   {
+	printf ( "Dispatch (%s), eval_double values :\n", ( EVAL_COMPUTED_GOTO ) ?  "computed goto" : "switch" ) ;
+	bench_run_list ( bench_dispatch_expressions, iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+
+	printf ( "Dispatch (%s), double values :\n", ( EVAL_COMPUTED_GOTO ) ?  "computed goto" : "switch" ) ;
+	bench_run_list ( bench_dispatch_expressions, iterations, EVAL_COMPILE_DOUBLE, NULL ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_size -
+        Measures the cost of running small, medium and huge expressions. Huge expressions are run fewer
+	times, so that the benchmark does not last too long.
+
+  ==============================================================================================================*/
+static void	bench_size ( int  iterations )
+   {
+	char *		buffer		=  ( char * ) malloc ( BENCH_FORMULA_SIZE ) ;
+	char *		p ;
+	int		huge_iterations	=  ( iterations  >=  BENCH_HUGE_DIVISOR ) ?  iterations / BENCH_HUGE_DIVISOR : 1 ;
+	int		i ;
+
+
+	printf ( "Small expressions :\n" ) ;
+	bench_run_list ( bench_small_expressions, iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+
+	printf ( "Medium expressions :\n" ) ;
+	bench_run_list ( bench_medium_expressions, iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+
+	printf ( "Huge expressions (%d terms) :\n", BENCH_HUGE_TERMS ) ;
+
+	// Sum of products ; coefficients are all different, so that no subexpression is eliminated
+	for  ( i = 0, p = buffer ; i  <  BENCH_HUGE_TERMS ; i ++ )
+		p	+=  sprintf ( p, "%s$x * %d.%d", ( i ) ?  " + " : "", i / 10, i % 10 ) ;
+
+	bench_run ( buffer, huge_iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+
+	// Same, with nested subexpressions and every kind of cheap operator
+	for  ( i = 0, p = buffer ; i  <  BENCH_HUGE_TERMS / 2 ; i ++ )
+	   {
+		if  ( i )
+			p	+=  sprintf ( p, " %s ", bench_lexer_operators [ i % 4 ] ) ;
+
+		p	+=  sprintf ( p, "( $x %s %d ) * ( $y %s %d )", bench_lexer_operators [ ( i + 1 ) % 2 ], i, bench_lexer_operators [ i % 2 ], i + 1 ) ;
+	    }
+
+	bench_run ( buffer, huge_iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+
+	free ( buffer ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_functions -
+        Measures the cost of calling functions having many arguments.
+
+  ==============================================================================================================*/
+static char *	bench_function_names []		=  { "avg", "var", "dev" } ;
+static int	bench_function_argc []		=  { BENCH_FEW_ARGUMENTS, BENCH_MANY_ARGUMENTS } ;
+
+
+static void	bench_functions ( int  iterations )
+   {
+	char *		buffer		=  ( char * ) malloc ( BENCH_FORMULA_SIZE ) ;
+	char *		p ;
+	int		argc, i, j, k ;
+
+
+	printf ( "Function calls :\n" ) ;
+
+	for  ( k = 0 ; k  <  BENCH_COUNT ( bench_function_argc ) ; k ++ )
+	   {
+		argc	=  bench_function_argc [k] ;
+
+		for  ( i = 0 ; i  <  BENCH_COUNT ( bench_function_names ) ; i ++ )
+		   {
+			p	=  buffer + sprintf ( buffer, "%s ( $x", bench_function_names [i] ) ;
+
+			for  ( j = 1 ; j  <  argc ; j ++ )
+				p	+=  sprintf ( p, ", $x + %d", j ) ;
+
+			sprintf ( p, " )" ) ;
+			bench_run ( buffer, iterations / argc * BENCH_FEW_ARGUMENTS, EVAL_COMPILE_DEFAULT, NULL ) ;
+		    }
+	    }
+
+	// Calls with a fixed number of arguments
+	bench_run ( "sqrt ( abs ( $x ) ) + log ( 1 + abs ( $y ) ) + cos ( $x ) * sin ( $y )", iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+	bench_run ( "dist ( $x, $y, $y, $x ) + slope ( $x, $y, $y, $x + 1 ) + atan2 ( $y, $x )", iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+
+	free ( buffer ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_callbacks -
+        Measures the cost of running expressions that reference many variables, through a callback then
+	through bound values.
+
+  ==============================================================================================================*/
+static void	bench_callbacks ( int  iterations )
+   {
+	printf ( "Variables supplied by a callback :\n" ) ;
+	bench_run_list ( bench_callback_expressions, iterations, EVAL_COMPILE_DEFAULT, bench_callback ) ;
+
+	printf ( "Variables supplied as bound values :\n" ) ;
+	bench_run_list ( bench_callback_expressions, iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_registers -
+        Measures the cost of running expressions that use registers.
+
+  ==============================================================================================================*/
+static void	bench_registers ( int  iterations )
+   {
+	printf ( "Registers :\n" ) ;
+	bench_run_list ( bench_register_expressions, iterations, EVAL_COMPILE_DEFAULT, NULL ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_formulas -
+        Measures the cost of compiling the corpus of real-world formulas, and of evaluating them through the
+	string interface.
+
+  ==============================================================================================================*/
+static void	bench_formulas ( int  iterations )
+   {
+	evaluator_program *	program ;
+	char **			formula ;
+	int			passes		=  ( iterations  >=  BENCH_FORMULA_DIVISOR ) ?  iterations / BENCH_FORMULA_DIVISOR : 1 ;
+	double			bytes		=  0,
+				count		=  0 ;
+	double			result, sum	=  0 ;
+	double			start, elapsed ;
+	unsigned long		allocations ;
+	int			errors		=  0 ;
+	int			pass ;
+
+
+	for  ( formula = bench_formula_corpus ; * formula  !=  NULL ; formula ++ )
+	   {
+		bytes	+=  strlen ( * formula ) ;
+		count	++ ;
+	    }
+
+	printf ( "Formulas (%.0f formulas, %.0f bytes) :\n", count, bytes ) ;
+
+	// Compile the corpus
+	allocations	=  bench_allocations ;
+	start		=  bench_time ( ) ;
+
+	for  ( pass = 0 ; pass  <  passes ; pass ++ )
+	   {
+		for  ( formula = bench_formula_corpus ; * formula  !=  NULL ; formula ++ )
+		   {
+			program		=  evaluator_compile ( * formula ) ;
+
+			if  ( program  ==  NULL )
+				errors ++ ;
+			else
+				evaluator_free_program ( program ) ;
+		    }
+	    }
+
+	elapsed		=  bench_time ( ) - start ;
+	allocations	=  bench_allocations - allocations ;
+
+	bench_report ( elapsed, count * passes, allocations, "formula" ) ;
+	printf ( "%8.1f MB/s  (%d errors)  evaluator_compile\n", bytes * passes / elapsed / 1e6, errors / passes ) ;
+
+	// Evaluate the corpus ; after the first pass, programs are taken from the cache
+	errors		=  0 ;
+	allocations	=  bench_allocations ;
+	start		=  bench_time ( ) ;
+
+	for  ( pass = 0 ; pass  <  passes ; pass ++ )
+	   {
+		bench_x		=  ( eval_double ) pass ;
+
+		for  ( formula = bench_formula_corpus ; * formula  !=  NULL ; formula ++ )
+		   {
+			if  ( evaluate_ex ( * formula, & result, bench_callback ) )
+				sum	+=  result ;
+			else
+				errors ++ ;
+		    }
+	    }
+
+	elapsed		=  bench_time ( ) - start ;
+	allocations	=  bench_allocations - allocations ;
+
+	bench_report ( elapsed, count * passes, allocations, "formula" ) ;
+	printf ( "%8.1f MB/s  (%d errors)  evaluate_ex\n", bytes * passes / elapsed / 1e6, errors / passes ) ;
+
+	// Prevent the compiler from optimizing the loop away
+	if  ( sum  ==  -1 )
+		printf ( "%g\n", sum ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_lexer -
+        Measures the cost of lexing and compiling a corpus of random formulas.
+
+  ==============================================================================================================*/
+static void	bench_lexer ( int  iterations )
+   {
+	char **			corpus		=  ( char ** ) malloc ( BENCH_LEXER_FORMULAS * sizeof ( char * ) ) ;
+	char *			buffer		=  ( char * ) malloc ( BENCH_FORMULA_SIZE ) ;
+	evaluator_program *	program ;
+	char *			p,
+	     *			startp,
+	     *			endp ;
+	void *			param ;
+	int			line, character, register_id ;
+	int			token ;
+	double			bytes		=  0,
+				tokens		=  0 ;
+	double			start, elapsed ;
+	unsigned long		allocations ;
+	int			errors		=  0 ;
+	int			i, pass ;
+
+
+	// The corpus is always lexed BENCH_LEXER_PASSES times
+	( void ) iterations ;
+
+	EVAL_INITIALIZE ( ) ;
+
+	// Generate the corpus ; the expression depth is limited so that formulas fit in the generation buffer
+	for  ( i = 0 ; i  <  BENCH_LEXER_FORMULAS ; i ++ )
+	   {
+		bench_generate_expression ( buffer, 1 + bench_random ( 3 ) ) ;
+		corpus [i]	 =  strdup ( buffer ) ;
+		bytes		+=  strlen ( buffer ) ;
+	    }
+
+	printf ( "Lexer (%d formulas, %.0f bytes) :\n", BENCH_LEXER_FORMULAS, bytes ) ;
+
+	// Split the corpus into tokens
+	allocations	=  bench_allocations ;
+	start		=  bench_time ( ) ;
+
+	for  ( pass = 0 ; pass  <  BENCH_LEXER_PASSES ; pass ++ )
+	   {
+		for  ( i = 0 ; i  <  BENCH_LEXER_FORMULAS ; i ++ )
+		   {
+			line		=  1 ;
+			character	=  1 ;
+
+			for  ( p = corpus [i] ; ; p = endp )
+			   {
+				token	=  eval_lex ( p, & startp, & endp, & param, & line, & character, & register_id ) ;
+
+				if  ( token  ==  TOKEN_EOF )
+					break ;
+
+				if  ( token  ==  TOKEN_ERROR )
+				   {
+					errors ++ ;
+					break ;
+				    }
+
+				tokens ++ ;
+			    }
+		    }
+	    }
+
+	elapsed		=  bench_time ( ) - start ;
+	allocations	=  bench_allocations - allocations ;
+
+	bench_report ( elapsed, tokens, allocations, "token" ) ;
+	printf ( "%8.1f MB/s  (%.0f tokens, %d errors)  eval_lex\n",
+			bytes * BENCH_LEXER_PASSES / elapsed / 1e6,
+			tokens / BENCH_LEXER_PASSES, errors / BENCH_LEXER_PASSES ) ;
+
+	// Compile the corpus
+	errors		=  0 ;
+	allocations	=  bench_allocations ;
+	start		=  bench_time ( ) ;
+
+	for  ( i = 0 ; i  <  BENCH_LEXER_FORMULAS ; i ++ )
+	   {
+		program		=  evaluator_compile ( corpus [i] ) ;
+
+		if  ( program  ==  NULL )
+			errors ++ ;
+		else
+			evaluator_free_program ( program ) ;
+	    }
+
+	elapsed		=  bench_time ( ) - start ;
+	allocations	=  bench_allocations - allocations ;
+
+	bench_report ( elapsed, BENCH_LEXER_FORMULAS, allocations, "formula" ) ;
+	printf ( "%8.1f MB/s  (%d errors)  evaluator_compile\n", bytes / elapsed / 1e6, errors ) ;
+
+	for  ( i = 0 ; i  <  BENCH_LEXER_FORMULAS ; i ++ )
+		free ( corpus [i] ) ;
+
+	free ( corpus ) ;
+	free ( buffer ) ;
+    }
+
+
+/*==============================================================================================================
+
+    bench_folding -
+        Measures the cost of compiling operations on constants, and checks that folding them gives the same
+	results as computing them at run time. The operand pairs are values whose quotient, product or sum
+	differ when computed using long doubles then rounded to double, and when computed using doubles.
+
+  ==============================================================================================================*/
+static char *	bench_folding_operands [] [2]	=
+   {
+	{ "22.148"		, "36.615838515546642"	},
+	{ "27.705000000000002"	, "55.28584854563691"	},
+	{ "87.788000000000011"	, "57.563682046138418"	},
+	{ "0.1"			, "0.7"			},
+	{ "1e300"		, "3.3e-5"		}
+    } ;
+
+static int	bench_folding_flags []		=  { EVAL_COMPILE_DEFAULT, EVAL_COMPILE_DOUBLE } ;
+
+
+static void	bench_folding ( int  iterations )
+   {
+	evaluator_program *	folded ;
+	evaluator_program *	computed ;
+	char			buffer [ 256 ] ;
+	eval_double		values [2] ;
+	double			folded_result, computed_result ;
+	double			elapsed		=  0,
+				start ;
+	unsigned long		allocations	=  0,
+				before ;
+	int			count		=  0,
+				errors		=  0 ;
+	int			f, i, j ;
+
+
+	( void ) iterations ;
+
+	printf ( "Constant folding :\n" ) ;
+
+	for  ( f = 0 ; f  <  BENCH_COUNT ( bench_folding_flags ) ; f ++ )
+	   {
+		for  ( i = 0 ; i  <  BENCH_COUNT ( bench_folding_operands ) ; i ++ )
+		   {
+			for  ( j = 0 ; j  <  BENCH_COUNT ( bench_lexer_operators ) ; j ++ )
+			   {
+				sprintf ( buffer, "%s %s %s", bench_folding_operands [i] [0], bench_lexer_operators [j], bench_folding_operands [i] [1] ) ;
+
+				before		 =  bench_allocations ;
+				start		 =  bench_time ( ) ;
+				folded		 =  evaluator_compile_ex ( buffer, bench_folding_flags [f] ) ;
+				elapsed		+=  bench_time ( ) - start ;
+				allocations	+=  bench_allocations - before ;
+				count ++ ;
+
+				sprintf ( buffer, "$a %s $b", bench_lexer_operators [j] ) ;
+				computed	=  evaluator_compile_ex ( buffer, bench_folding_flags [f] ) ;
+
+				if  ( folded  ==  NULL  ||  computed  ==  NULL )
+				   {
+					evaluator_perror ( ) ;
+					errors ++ ;
+				    }
+				else
+				   {
+					// Operands are parsed as doubles
+					values [0]	=  strtod ( bench_folding_operands [i] [0], NULL ) ;
+					values [1]	=  strtod ( bench_folding_operands [i] [1], NULL ) ;
+
+					evaluator_run_bound ( folded, & folded_result, values ) ;
+					evaluator_run_bound ( computed, & computed_result, values ) ;
+
+					// NaN results are never equal
+					if  ( memcmp ( & folded_result, & computed_result, sizeof ( double ) )  &&
+					      ( folded_result  ==  folded_result  ||  computed_result  ==  computed_result ) )
+					   {
+						printf ( "\tMismatch (%s) : %s %s %s folded to %.17g, computed as %.17g\n",
+								( bench_folding_flags [f] & EVAL_COMPILE_DOUBLE ) ?  "double" : "eval_double",
+								bench_folding_operands [i] [0], bench_lexer_operators [j], bench_folding_operands [i] [1],
+								folded_result, computed_result ) ;
+						errors ++ ;
+					    }
+				    }
+
+				evaluator_free_program ( folded ) ;
+				evaluator_free_program ( computed ) ;
+			    }
+		    }
+	    }
+
+	bench_report ( elapsed, count, allocations, "formula" ) ;
+	printf ( "(%d mismatches)  evaluator_compile_ex\n", errors ) ;
+    }
+
+
+/*==============================================================================================================
+
+	Benchmark table.
+
+  ==============================================================================================================*/
+typedef struct  bench_definition
+   {
+	char *		name ;
+	void		( * function ) ( int  iterations ) ;
+    }  bench_definition ;
+
+
+static bench_definition		bench_definitions []	=
+   {
+	{ "dispatch"	, bench_dispatch	},
+	{ "size"	, bench_size		},
+	{ "functions"	, bench_functions	},
+	{ "callback"	, bench_callbacks	},
+	{ "registers"	, bench_registers	},
+	{ "formulas"	, bench_formulas	},
+	{ "lexer"	, bench_lexer		},
+	{ "folding"	, bench_folding		}
+    } ;
+
+
+/*==============================================================================================================
+
+	Main program.
+
+  ==============================================================================================================*/
+int	main ( int  argc, char **  argv )
+   {
+	int	iterations	=  ( argc  >  1 ) ?  atoi ( argv [1] ) : BENCH_ITERATIONS ;
+	int	i, j ;
+
+
+	if  ( iterations  <=  0 )
+		iterations	=  BENCH_ITERATIONS ;
+
+	// Check benchmark names before running anything
+	for  ( j = 2 ; j  <  argc ; j ++ )
+	   {
+		for  ( i = 0 ; i  <  BENCH_COUNT ( bench_definitions )  &&  strcmp ( argv [j], bench_definitions [i]. name ) ; i ++ )
+			;
+
+		if  ( i  ==  BENCH_COUNT ( bench_definitions ) )
+		   {
+			fprintf ( stderr, "Unknown benchmark '%s'\n", argv [j] ) ;
+			return ( 1 ) ;
+		    }
+	    }
+
+	for  ( i = 0 ; i  <  BENCH_COUNT ( bench_definitions ) ; i ++ )
+	   {
+		for  ( j = 2 ; j  <  argc  &&  strcmp ( argv [j], bench_definitions [i]. name ) ; j ++ )
+			;
+
+		if  ( argc  <=  2  ||  j  <  argc )
+			bench_definitions [i]. function ( iterations ) ;
+	    }
+
+	return ( 0 ) ;
+    }
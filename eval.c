@@ -1,2028 +1,4264 @@
-/**************************************************************************************************************
-
-    NAME
-        eval.c
-
-    DESCRIPTION
-        Implements an expression evaluator, evaluate().
-	Based on Wikipedia shunting-yard algorightm description :
-
-		https://en.wikipedia.org/wiki/Shunting-yard_algorithm
-
-    AUTHOR
-        Christian Vigh, 09/2015.
-
-    HISTORY
-    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
-        Initial version.
-
- **************************************************************************************************************/
-
-# define	_USE_MATH_DEFINES
-
-# include   	<stdio.h>
-# include 	<string.h>
-# include 	<ctype.h>
-# include 	<malloc.h>
-# include 	<math.h>
-# include	<float.h>
-# include 	<stdarg.h>
-# include	<stdlib.h>
-# include	<time.h>
-
-# include	"eval.h"
-# include	"evalfuncs.h"
-
-
-/*==============================================================================================================
- *
- *  Define the EVAL_DEBUG macro for debugging information.
- *
- *==============================================================================================================*/
-# ifndef	EVAL_DEBUG
-#	define	EVAL_DEBUG		0
-# else
-#	undef	EVAL_DEBUG
-#	define	EVAL_DEBUG		1
-# endif
-
-
-
-/*==============================================================================================================
- *
- *  Redefine these macros if needed to integrate the eval package into your environment.
- *
- *==============================================================================================================*/
-
-# ifndef	eval_malloc
-#	define 	eval_malloc( size ) 		malloc ( size )
-# endif
-
-# ifndef	eval_realloc
-#	define 	eval_realloc( p, size )		realloc ( p, size )
-# endif
-
-# ifndef	eval_strdup
-#	define 	eval_strdup( p )		strdup ( p ) 
-# endif
-
-# ifndef	eval_strndup
-#	define 	eval_strndup( s, size )		__eval_strndup__ ( s, size )
-# endif
-
-# ifndef	eval_free
-#	define 	eval_free( p )			free ( p ) 
-# endif
-
- 
-// Indicates whetyher empty strings are to be considered as an error or converted to zero
-# ifndef	EVAL_DENY_EMPTY_STRINGS
-#	define	EVAL_DENY_EMPTY_STRINGS			0
-# else
-#	undef	EVAL_DENY_EMPTY_STRINGS
-#	define	EVAL_DENY_EMPTY_STRINGS			1
-# endif
-
-
-/*==============================================================================================================
- *
- *  Constants.
- *
- *==============================================================================================================*/
-
-// Token classification
-# define 	TOKEN_ERROR 			0x8000 			// Invalid character found
-# define 	TOKEN_EOF 			0x0001			// Everything has been processed from the supplied input string
-# define 	TOKEN_NUMBER			0x0002			// Number (integer or float)
-# define 	TOKEN_NAME 			0x0004 			// Function name
-# define 	TOKEN_OPERATOR			0x0008			// Operator
-# define 	TOKEN_COMMA			0x0010 			// Argument separator for a function call
-# define	TOKEN_LEFT_PARENT		0x0020			// Left and right parentheses
-# define	TOKEN_RIGHT_PARENT		0x0040
-# define	TOKEN_REGISTER_SAVE		0x0080			// Save last computed value ($x! construct)
-# define	TOKEN_REGISTER_RECALL		0x0100			// Recall the specified computed value ($x?)
-# define	TOKEN_VARIABLE			0x0200			// Variable reference
-
-// Operators
-# define	OP_PLUS 			 1
-# define 	OP_MINUS 			 2
-# define 	OP_MUL				 3
-# define 	OP_DIV 				 4
-# define 	OP_IDIV 			 5
-# define 	OP_POWER 			 6
-# define 	OP_MOD 				 7
-# define 	OP_AND				 8
-# define	OP_OR				 9
-# define	OP_XOR		  		10
-# define 	OP_NOT				11
-# define	OP_UNARY_PLUS			12
-# define	OP_UNARY_MINUS			13
-# define	OP_SHL				14
-# define	OP_SHR				15
-# define	OP_FACTORIAL			16
-# define	OP_LEFT_PARENT			50
-# define	OP_RIGHT_PARENT			51
-# define	OP_COMMA			52
-
-// Operator associativity
-# define 	ASSOC_NONE 			0
-# define 	ASSOC_LEFT 			1
-# define 	ASSOC_RIGHT 			2
-
-// Stack initial sizes
-# define 	OUTPUT_STACK_SIZE 		64
-# define 	OPERATOR_STACK_SIZE 		32
-
-// Registers, numbered from 0 to MAX_REGISTERS - 1 
-# define	MAX_REGISTERS			64
-
-// Max nested function calls
-# define	MAX_NESTED_FUNCTION_CALLS	64
-
-/*==============================================================================================================
- *
- *  Operator definitions.
- *
- *==============================================================================================================*/
-typedef struct operator_token
-   {
-	char *		token ;
-	int 		length ;
-	int 		type ;
-	int 		precedence:8 ;
-	int 		associativity:2 ;
-	int 		unary:1 ;
-    }  operator_token ;
-
-
-/*==============================================================================================================
- *
- *  Save/recall value constructs ($x! and $x?).
- *
- *==============================================================================================================*/
-static eval_double	eval_registers		[ MAX_REGISTERS ] ;
-static char		eval_registers_set	[ MAX_REGISTERS ] ;
-static int		eval_last_register			=  -1 ;
-
-
-/*==============================================================================================================
- *
- *  Stack definitions.
- *
- *==============================================================================================================*/
-
-// A "compiled" expression stack is generated by the eval_parse() function, then interpreted by eval_compute().
-// All stack entries have one of these types
-# define 	STACK_ENTRY_NUMERIC 		0		// Numeric value
-# define 	STACK_ENTRY_NAME 		1		// Constant name
-# define 	STACK_ENTRY_OPERATOR 		2		// Operator
-# define	STACK_ENTRY_REGISTER_SAVE	3		// Save value on top of stack to te specified register
-# define	STACK_ENTRY_REGISTER_RECALL	4		// Push the specified register value on top of stack
-# define	STACK_ENTRY_FUNCTION_CALL	5		// Start of a function call
-# define	STACK_ENTRY_VARIABLE		6		// Variable reference
-
-// Output stack entry definition
-typedef struct eval_stack_entry
-   {
-	int 	type ;						// Stack entry type	
-	union
-	   {
-		eval_double 		double_value ;		// Value
-		char *			string_value ;		// Constant or function name
-		operator_token *	operator_value ;	// Operator definition
-		int			register_value ;	// Register
-
-		struct						// Function call
-		   {
-			char *		name ;
-			int		argc ;
-		    } function_value ;
-	    } value ;	
-    }  eval_stack_entry ;
-    
-
-// Generic stack for values and operators
-typedef struct  eval_stack
-   {
-	int 			size ;				// Current number of items in the stack
-	int 			item_size ;			// Size of a stack item
-	int 			last_item ;			// Last item of the stack
-	eval_stack_entry *	data ;				// Stack data
-    }  eval_stack ;
-
-
-
-/*==============================================================================================================
-
-        Error information.
-
-  ==============================================================================================================*/    
-int		evaluator_errno ;
-char 		evaluator_error [ 1024 ] ;
-
-
-/*==============================================================================================================
-
-        Operator definitions.
-
-  ==============================================================================================================*/    
-static operator_token 		operators []	=
-   {
-	{ "+"	, 1, OP_PLUS		,  5, ASSOC_LEFT , 0	},
-	{ "-"	, 1, OP_MINUS		,  5, ASSOC_LEFT , 0 	},
-	{ "*"	, 1, OP_MUL		,  8, ASSOC_LEFT , 0 	},
-	{ "/"	, 1, OP_DIV		,  8, ASSOC_LEFT , 0 	},
-	{ "\\"	, 1, OP_IDIV		,  8, ASSOC_LEFT , 0 	},
-	{ "**"	, 2, OP_POWER		,  9, ASSOC_RIGHT, 0	},
-	{ "%"	, 1, OP_MOD		,  8, ASSOC_LEFT , 0 	},
-	{ "&"	, 1, OP_AND		,  5, ASSOC_LEFT , 0 	},
-	{ "|"	, 1, OP_OR		,  5, ASSOC_LEFT , 0 	},
-	{ "^"	, 1, OP_XOR		,  5, ASSOC_LEFT , 0 	},
-	{ "~"	, 1, OP_NOT		, 10, ASSOC_RIGHT, 1  	},
-	{ "<<"	, 2, OP_SHL		,  5, ASSOC_LEFT , 0	},
-	{ ">>"	, 2, OP_SHR		,  5, ASSOC_LEFT , 0	},
-	{ "!"   , 1, OP_FACTORIAL	, 10, ASSOC_LEFT , 1    },
-	
-	{ NULL  , 0		,  0,           0, 0    }
-    } ;
-
-// Unary plus/minus need a special processing, since they use the same characters as their binary counterpart
-static operator_token		unary_minus		=
-	{ "-"	, 1, OP_UNARY_MINUS	, 10, ASSOC_RIGHT, 1	} ; 
-
-// Same for parentheses
-static operator_token		left_parenthesis	=
-	{ "("	, 1, OP_LEFT_PARENT	, 50, ASSOC_NONE , 0	} ;
-
-/*==============================================================================================================
- *
- *  Structures for constant and function definitions.
- *
- *==============================================================================================================*/
-
-// Increments for constant and function stores
-# define	PRIMITIVE_INCREMENT		64
-# define	ARGUMENT_INCREMENT		64
-# define	NEXT_INCREMENT(x,incr)		( ( ( (x) + (incr) - 1 ) / (incr) ) * (incr) )
-
-
-// Some kind of "base" class for constant and function definitions
-typedef struct  primitive_definition
-   {
-	char *		name ;
-    }  primitive_definition ;
-
-
-// Implements either a list of constants or functions
-typedef struct  primitive_list 
-   {
-	int		length ;
-	int		item_count ;
-	int		item_size ;
-	void *		data ;
-    }  primitive_list ;
-
-// Constants and functions list
-static primitive_list		eval_constant_definitions	=  { 0, 0, sizeof ( evaluator_constant_definition ), NULL },
-				eval_function_definitions	=  { 0, 0, sizeof ( evaluator_function_definition ), NULL } ;
-
-
-/*==============================================================================================================
-
-    eval_skip_spaces -
-	Skips spaces from the current position.
-
-  ==============================================================================================================*/    
-static char *	eval_skip_spaces ( char *  str, int *  line, int *  character )
-   {
-	while  ( * str  &&  isspace ( ( int ) * str ) )
-	   {
-		( * character ) ++ ;
-
-		if  ( * str  ==  '\n' )
-		   {
-			( * line ) ++ ;
-			* character	=  1 ;
-		    }
-		else if  ( * str  !=  '\r' )
-			( * character ) ++ ;
-
-		str ++ ;
-	    }
-
-	return ( str ) ;
-     }
-
-
-/*==============================================================================================================
-
-    eval_register -
-        Called for registering constants & functions.
-
-  ==============================================================================================================*/
-static int	__eval_primitive_sort__ ( const void *  a, const void *  b )
-   {
-	return
-	   (
-		strcmp 
-		   (
-			( ( primitive_definition * ) a ) -> name,
-			( ( primitive_definition * ) b ) -> name
-		    )
-	    ) ;
-    }
-
-
-static void	eval_register ( primitive_list *  list, const void *  definitions )
-   {
-	int		count		=  0 ;
-	int		total_count ;
-	int		copy_size ;
-	int		new_length ;
-	const void *	p		=  definitions ;
-	void *		q ;
-
-
-	// First, count the number of new definitions ; the last definition must be an empty one (ie, at least the
-	// 'name' member must be null)
-	while  ( ( ( primitive_definition * ) p ) -> name  !=  NULL )
-	   {
-		count ++ ;
-		p		=  ( void * ) ( ( ( char * ) p ) + list -> item_size ) ;
-	    }
-
-	// Compute the total number of primitives to be stored
-	total_count	=  list -> item_count + count ;
-
-	// Total number of bytes to copy
-	copy_size	=  count * list -> item_size ;
-
-	// If the total number of primitives is greater than the actual size of the primitive list,
-	// then we will have some allocation work to perform
-	if  ( total_count  >  list -> length )
-	   {
-		new_length	=  NEXT_INCREMENT ( total_count, PRIMITIVE_INCREMENT ) ;
-
-		if  ( list -> length )   
-		   {
-			list -> length	=  new_length ;
-			list -> data	=  eval_realloc ( list -> data, new_length * list -> item_size ) ;
-		    }
-		else
-		   {
-			list -> length	 =  new_length ;
-			list -> data	 =  eval_malloc ( new_length * list -> item_size ) ;
-		    }
-	    }
-
-	// Make 'q' point to the first slot after the very last primitive of the list
-	q	=  ( void * ) ( ( ( char * ) ( list -> data ) ) + ( list -> item_count * list -> item_size ) ) ;
-
-	// Now copy the definitions after the last primitive of the list 
-	memcpy ( q, definitions,  copy_size ) ;
-	list -> item_count	+=  count ;
-
-	// And finally, sort primitive list
-	qsort ( list -> data, list -> item_count, list -> item_size, __eval_primitive_sort__ ) ;
-    }
-
-
-/*==============================================================================================================
-
-    eval_find_primitive -
-        Finds a primitive (constant or function).
-
-  ==============================================================================================================*/
-static primitive_definition *	eval_find_primitive ( primitive_list *  list, char *  value )
-   {
-	int			low		=  0,
-				high		=  list -> item_count - 1,
-				middle ;
-	int			cmpresult ;
-	primitive_definition *	p ;
-
-
-	while  ( low  <=  high )
-	   {
-		middle		=  low + ( high - low ) / 2 ;
-		p		=  ( primitive_definition * ) ( ( ( char * ) list -> data ) + ( list -> item_size * middle ) ) ;
-		cmpresult	=  strcasecompare ( p -> name, value ) ;
-
-
-		if  ( cmpresult  <  0 )
-			low	=  middle + 1 ;
-		else if  ( cmpresult  >  0 )
-			high	=  middle - 1 ;
-		else
-			return ( p ) ;
-	    }
-
-	return ( NULL ) ;
-    }
-
-
-# if	EVAL_DEBUG
-/*==============================================================================================================
-
-	Debug functions for dumping constant and function definitions.
-
-  ==============================================================================================================*/
-void	eval_dump_constants ( )
-   {
-	int					i ;
-	evaluator_constant_definition *		p	=  ( evaluator_constant_definition * ) eval_constant_definitions. data ;
-
-
-	printf ( "Defined constants :\n" ) ;
-
-	for  ( i = 0 ; i  <  eval_constant_definitions. item_count ; i ++, p ++ )
-	   {
-		printf ( "\t%-32s = %lg\n", p -> name, ( double ) p -> value ) ;
-	    }
-    }
-
-
-void	eval_dump_functions ( )
-   {
-	int					i ;
-	evaluator_function_definition *		p	=  ( evaluator_function_definition * ) eval_function_definitions. data ;
-
-
-	printf ( "Defined functions :\n" ) ;
-
-	for  ( i = 0 ; i  <  eval_function_definitions. item_count ; i ++, p ++ )
-	   {
-		printf ( "\t%-32s (%d..%d)\n", p -> name, p -> min_args, p -> max_args ) ;
-	    }
-    }
-
-
-static void	eval_dump_stack ( eval_stack *  stack, char *  title )
-   {
-	int		i ;
-
-
-	printf ( "Dumping %s :\n", title ) ;
-
-	for  ( i = 0 ; i  <=  stack -> last_item ; i ++ )
-	   {
-		printf ( "\t" ) ;
-
-		switch ( stack -> data [i]. type )
-		   {
-			case	STACK_ENTRY_NUMERIC :
-				printf ( "NUMBER   : %lg\n", ( double ) stack -> data [i]. value. double_value ) ;
-				break ;
-
-			case	STACK_ENTRY_NAME :
-				printf ( "CONSTANT : %s\n", stack -> data [i]. value. string_value ) ;
-				break ;
-
-			case	STACK_ENTRY_OPERATOR :
-				printf ( "OPERATOR : %s\n", stack -> data [i]. value. operator_value -> token ) ;
-				break ;
-
-			case	STACK_ENTRY_REGISTER_SAVE :
-				printf ( "REGSAVE  : %d\n", stack -> data [i]. value. register_value ) ;
-				break ;
-
-			case	STACK_ENTRY_REGISTER_RECALL :
-				printf ( "REGCALL  : %d\n", stack -> data [i]. value. register_value ) ;
-				break ;
-
-			case	STACK_ENTRY_FUNCTION_CALL :
-				printf ( "FUNCTION : %s\n", stack -> data [i]. value. string_value ) ;
-				break ;
-
-			case	STACK_ENTRY_VARIABLE :
-				printf ( "VARIABLE : %s\n", stack -> data [i]. value. string_value ) ;
-				break ;
-
-			default :
-				printf ( "UNKNOWN  : type = %d\n", stack -> data [i]. type ) ;
-		    }
-	    }
-    }
-# endif
-
-
-/*==============================================================================================================
- *
- *  eval_initialize -
- *	Initializes the eval package.
- *
- *==============================================================================================================*/	
-static int	eval_initialized		=  0 ;
-
-static int	__eval_sort_operators__ ( const void *  a, const void *  b )
-   {
-	return
-	   (
-		( ( operator_token * ) b ) -> length -
-		( ( operator_token * ) a ) -> length 
-	    ) ;
-    }
-
-
-static void  eval_initialize ( )
-   {
-	// Do nothing if initialization has been already performed
-	if  ( eval_initialized )
-		return ;
-
-	// Register default constants and functions
-	eval_register ( & eval_constant_definitions, default_constant_definitions ) ;
-	eval_register ( & eval_function_definitions, default_function_definitions ) ;
-
-	// Sort operator by descending length
-	qsort ( operators, ( sizeof ( operators ) - 1 ) / sizeof ( operator_token ), sizeof ( operator_token ), __eval_sort_operators__ ) ;
-	
-	// All done
-	eval_initialized	=  1 ;
-    }
-
-
-static void	eval_instance_initialize ( )
-   {
-	time_t		seed	=  time ( NULL ) ;
-
-	// Initialize the pseudo-random number generator
-	srand ( ( int ) seed ) ;
-
-	// Reset last error code
-	evaluator_errno		=  E_EVAL_OK ;
-	* evaluator_error	=  '\0' ;
-
-	// Reset register values
-	memset ( eval_registers, 0, sizeof ( eval_registers ) ) ;
-	memset ( eval_registers_set, 0, sizeof ( eval_registers_set ) ) ;
-	eval_last_register	=  -1 ;
-    }
-
-
-/*==============================================================================================================
- *
- *  eval_error -
- *	Sets the evaluator_errno and evaluator_error variables.
- *
- *==============================================================================================================*/	
-static void  eval_error ( int  err, int  line, int character, char *  fmt, ... )
-   {
-	va_list 	ap ;
-	int		length ;
-	   
-	   
-	evaluator_errno		=  err ;
-
-	if  ( line  ==  -1 )
-		length		=  sprintf ( evaluator_error, "Eval error : " ) ;
-	else
-		length		=  sprintf ( evaluator_error, "Eval error [line#%d, col#%d] : ", line, character + 1 ) ;
-
-	va_start ( ap, fmt ) ;
-	vsprintf ( evaluator_error + length, fmt, ap ) ;
-	va_end ( ap ) ;
-    }
-    
-
-/*==============================================================================================================
- *
- *  __eval_strndup__ -
- *	Duplicates a fixed-length string.
- *
- *==============================================================================================================*/	
-static char *  __eval_strndup__ ( char *  s, int size )
-   {
-	char *		p	=  eval_malloc ( size ) ;
-
-	strncpy ( p, s, size ) ;
-
-	return ( p ) ;
-    }
-    
-
-
-/*==============================================================================================================
- *
- *   	Stack functions.
- *
- *==============================================================================================================*/	
-
-static void * 	eval_stack_alloc ( int  size, int  item_size )
-   {
-	int 			byte_count 		=  size * sizeof ( eval_stack_entry * ) ;
-	eval_stack * 		stack 			=  ( eval_stack * ) eval_malloc ( sizeof ( eval_stack ) ) ;   
-	   
-	
-	stack -> size	 	=  size ;
-	stack -> item_size 	=  item_size ;
-	stack -> last_item	=  -1 ;
-	stack -> data 		=  eval_malloc ( byte_count ) ;
-	   
-	return ( stack ) ;
-   }
-   
-   
-static void 	eval_stack_realloc ( eval_stack *  stack, int  new_size )
-   {
-	int	byte_count 	=  new_size * stack -> item_size ;
-	   
-	   
-	stack -> data 	=  ( eval_stack_entry * ) eval_realloc ( stack -> data, byte_count ) ;
-	stack -> size 	=  new_size ;
-    }
-    
-    
-static void  	eval_stack_push ( eval_stack *  stack, void *  item )
-   {
-	if  ( stack -> last_item + 1  >=  stack -> size )
-		eval_stack_realloc ( stack, stack -> size * 2 ) ;
-	
-	memcpy ( stack -> data + ( ++ stack -> last_item ), ( eval_stack_entry * ) item, sizeof ( eval_stack_entry ) ) ;
-    }
-   
-    
-static void * 	eval_stack_pop ( eval_stack *  stack )
-   {
-	if  ( stack -> last_item  <  0 )
-		return ( NULL ) ;
-	else
-		return ( stack -> data + ( stack -> last_item -- ) ) ;
-    }
-    
-    
-static void 	eval_stack_free ( eval_stack *  stack )
-   {
-	int		i ;
-
-	for  ( i = 0 ; i  <=  stack -> last_item ; i ++ )
-	   {
-		switch ( stack -> data [i]. type )
-		   {
-			case	STACK_ENTRY_NAME :
-				eval_free ( stack -> data [i]. value. string_value ) ;
-				break ;
-
-			case	STACK_ENTRY_FUNCTION_CALL :
-				eval_free ( stack -> data [i]. value. function_value. name ) ;
-				break ;
-		    }
-	    }
-
-	eval_free ( stack -> data ) ;
-	eval_free ( stack ) ;
-    }
- 
-
-static int	eval_stack_is_empty ( eval_stack *  stack )
-   {
-	return ( stack -> last_item  <  0 ) ;
-    }
-
-
-/*==============================================================================================================
- *
- *  eval_double_value -
- *	Converts a string to a double.
- *	At that point, no sign is present and we are sure that incorrect mixing between integer and double
- *	syntax are absent ; for example, we will never see a string such as "0xFF.01E10".
- *	Returns 1 if parsing is OK, 0 otherwise.
- *
- *==============================================================================================================*/	
-static int	eval_double_value ( char *  str, int  length, eval_double *  result )
-   {
-	char *		tail ;
-	eval_double	numeric_value ;
-
-
-	* result	=  0 ;
-
-# if	EVAL_DENY_EMPTY_STRINGS
-	if  ( ! * str )
-		return ( 0 ) ;
-# else
-	if  ( ! * str )
-	   {
-		* result	=  0 ;
-
-		return ( 1 ) ;
-	    }
-# endif
-
-	// Process integer values that have a base specifier or that start with zero
-	if  ( * str  ==  '0'  &&  length  >  1 )
-	   {
-		char *		p		=  str + 1 ;
-		int		base		=  10 ;
-		double		value		=  0 ;
-		char		ch, ich ;
-
-
-		switch ( toupper ( ( int ) * p ) )
-		   {
-			case	'B'	:  base	 =   2 ; break ;
-			case	'O'	:  base	 =   8 ; break ;
-			case	'D'	:  base  =  10 ; break ;
-			case	'X'	:  base  =  16 ; break ;
-
-			default :
-				if  ( * p  >=  '0'  &&  * p  <=  '7' )
-					base	=  8 ;
-				else
-					return ( 0 ) ;
-		    }
-
-		p ++ ;
-
-		while  ( * p ) 
-		   {
-			ich	=  toupper ( ( int ) * p ) ;
-			ch	=  ( ich  >=  'A' ) ?  ich - 'A' + 10 : ich - '0' ;
-
-			value   =  ( value * base ) + ch ;
-			p ++ ;
-		    }
-
-		* result	=  value ;
-
-		return ( 1 ) ;
-	    }
-
-	// Floating-point value - convert it
-	numeric_value	=  strtod ( str, & tail ) ;
-
-	// Fail if supplied input string does not completely match a float
-	if  ( tail  !=  str + length )
-		return ( 0 ) ;
-
-	// Match found : return the numeric result
-	* result	=  numeric_value ;
-
-	return ( 1 ) ;
-    }
-
-    
-/*==============================================================================================================
- *
- *  eval_lex -
- *	Parses the supplied input string to retrieve the next token.
- *
- *==============================================================================================================*/	
-static int eval_lex ( char *  str, char **  startp, char **  endp, void **  op, int *  line, int *  character )
-   {
-	static int	register_id ;
-	int 		i ;
-	int 		token 		=  TOKEN_EOF ;
-	   
-	   
-	str	=  eval_skip_spaces ( str, line, character ) ;
-	
-	if  ( ! * str )
-		return ( token ) ;
-	
-	// *startp will point to the start of the token (and end,... guess what ?)
-	* startp 	=  str ;
-	
-	// If an operator has been found, *op will point to the operator description structure
-	* op 		=  NULL ;
-			
-	// Name found (maybe a function name)
-	if  ( isalpha (( int )  * str )  ||  * str  ==  '_' )
-	   {
-		while  ( isalnum ( ( int ) * str )  ||  * str  ==  '_' )
-			str ++ ;
-		
-		token 		=  TOKEN_NAME ;
-	    }
-	// Number, either an integer with an optional base or a float
-	// At that point we don't try to convert anything, just verify that the number is correct
-	else if  ( isdigit ( ( int ) * str ) )
-	   {
-		int 	found_base 	=  0,
-			found_dot 	=  0,
-			found_exp	=  0 ;
-		int 	base 		=  10 ;   
-		char 	ch, ich ;
-		
-
-		if  ( * str  ==  '0'  &&  isxdigit ( ( int ) str [1] ) )
-		   {
-			char * 	p 	=  str + 1 ;
-			int  	found 	=  0 ;
-
-			// If we find a number starting with zero, then this may be an integer represented in 
-			// octal, unless we find something specific to a float (a decimal point or the exponentiation
-			// character, E)
-			while  ( * p )
-			   {
-				switch ( * p ) 
-				   {
-					case 	'.' :
-					case 	'E' : 
-					case 	'e' :
-						found 	=  1 ;
-						break ;
-				    }
-				    
-				if  ( found )
-					break ;
-				
-				p ++ ;
-			    }
-			
-			if  ( ! found )
-			   {
-				base 	=  8 ;
-				   
-				str ++ ;
-			    }
-		    }
-		   
-		// Loop through input number
-		token 	=  TOKEN_NUMBER ;
-
-		while  ( * str )
-		   {
-			ch 	=  toupper ( ( int ) * str ) ;
-			   
-			switch  ( ch )
-			   {
-				// Base specifier
-				case 	'X' :		// Hex
-				case	'B' :		// Binary
-				case	'D' :		// Decimal
-				case	'O' :		// Octal
-					if  ( found_dot  ||  found_exp  ||  found_base )
-					   {
-						token 	=  TOKEN_ERROR ;
-						goto  NumberEnd ;
-					    }
-		
-					switch ( ch )
-					   {
-						case	'X'	:  base		=  16 ; break ;
-						case	'D'	:  base		=  10 ; break;
-						case	'O'	:  base		=   8 ; break ;
-						case	'B'	:  base		=   2 ; break ;
-					    }
-					
-					found_base 	=  1 ;
-					break ;
-					    
-				// Decimal point
-				case 	'.' :
-					if  ( found_dot  ||  found_exp  ||  found_base )
-					   {
-						token 	=  TOKEN_ERROR ;
-						goto  NumberEnd ;
-					    }
-		
-					found_dot 	=  1 ;
-					break ;
-					    
-				// Exponentiation character ; can be interpreted in two ways, depending on
-				// whether we saw a hex base specifier (0x) or we are handling a float
-				case 	'E' :
-					if  ( ! found_base )
-					   {
-						if  ( found_dot  ||  found_exp )
-						   {
-							token 	=  TOKEN_ERROR ;
-							goto  NumberEnd ;
-						    }
-		
-						found_exp 	=  1 ;
-						ch 		=  * ( str + 1 ) ;
-						    
-						if  ( ch  ==  '+'  ||  ch  ==  '-' )
-							str ++ ;
-						
-						break ;
-					    }
-					// Not a float ; this means that "E" may be a hex digit so intentionally fall
-					// through the next case below
-					    
-				// Other character : our token fetching task is complete
-				default :
-					if  ( ( ch  >=  '0'  &&  ch  <= '9' )  ||  ( ch  >=  'A'  &&  ch  <=  'F' ) )
-					   {
-						ich 	=  ( ch  >=  'A' ) ?  ( ch - 'A' + 10 ) : ch - '0' ;
-
-						if  ( ich  >=  base )
-						   {
-							token 	=  TOKEN_ERROR ;
-							goto  NumberEnd ;
-						    }
-					    }
-					else
-						goto NumberEnd ;
-			    }			
-			    
-			str ++ ;
-		    }
-		    
-NumberEnd : ;
-
-	    }
-	// Left parenthesis
-	else if  ( * str  ==  '(' )
-	   {
-		token	=  TOKEN_LEFT_PARENT ;
-		str ++ ;
-	    }
-	// Right parenthesis 
-	else if  ( * str  ==  ')' )
-	   {
-		token	=  TOKEN_RIGHT_PARENT ;
-		str ++ ;
-	    }
-	// $name notation : variable name whose value must be supplied by the caller
-	else if  ( * str  ==  '$' )
-	   {
-		// Check that some characters remain after the "$" sign
-		if  ( * ( str + 1 ) )
-		   {
-			str ++ ;
-			* startp	=  str ;
-
-			// A variable name must start with a letter or an underline
-			if  ( isalpha ( ( int ) * str )  ||  * str  ==  '_' )
-			   {
-				while  ( * str  &&  ( isalnum ( ( int ) * str )  ||  * str  ==  '_' ) )
-					str ++ ;
-
-				token	=  TOKEN_VARIABLE ;
-			    }
-			// Otherwise this is an error
-			else
-				token	=  TOKEN_ERROR ;
-		    }
-		// End of string after the "$" sign
-		else
-			token	=  TOKEN_ERROR ;
-	    }
-	// #x! or #x? notation : save to/restore from register
-	else if  ( * str  ==  '#' )
-	   {
-		int	found_digits	=  0 ;
-
-		register_id	=  0 ;
-		str ++ ;
-
-		str	=  eval_skip_spaces ( str, line, character ) ;
-
-		while  ( isdigit ( ( int ) * str )  )
-		   {
-			register_id	=  ( register_id * 10 ) + ( * str - '0' ) ;
-			found_digits	=  1 ;
-			str ++ ;
-		    }
-
-		str	=  eval_skip_spaces ( str, line, character ) ;
-
-		if  ( ! found_digits )
-			register_id	=  -1 ;
-
-		if  ( * str  ==  '!' )
-		   {
-			token			=  TOKEN_REGISTER_SAVE ;
-			* ( int ** ) op		=  & register_id ;
-			str ++ ;
-		    }
-		else if  ( * str  ==  '?' )
-		   {
-			token			=  TOKEN_REGISTER_RECALL ;
-			* ( int ** ) op		=  & register_id ;
-			str ++ ;
-		    }
-		else
-			token			=  TOKEN_ERROR ;
-	    }
-	// Function argument separator (comma)
-	else if  ( * str  ==  ',' )
-	   {
-		token	=  TOKEN_COMMA ;
-		str ++ ;
-	    }
-	// Other input : may be an operator
-	else if  ( * str ) 
-	   {
-		int 	found 	=  0 ;
-		   
-		// Loop through operator definitions
-		for  ( i = 0 ; operators [i]. token  !=  NULL ; i ++ )
-		   {
-			if  ( ! strncmp ( str, operators [i]. token, operators [i]. length ) )
-			   {
-				token 				 =  TOKEN_OPERATOR ;
-				* ( ( operator_token ** ) op )	 =  operators + i ;
-				found 				 =  1 ;
-				str 				+=  operators [i]. length ;
-				break ;
-			    }
-		    }
-		    
-		if  ( ! found )
-			token 	=  TOKEN_ERROR ;
-	    }
-	
-	// Set the end pointer to the character after the token found
-	* endp 		 =  str ;
-	* character	+=  str - * startp - 1 ;
-
-	// All done, return
-	return ( token ) ;
-    }
-
-
-/*==============================================================================================================
- *
- *  eval_compute -
- *	Performs the real computation of the expression evaluated by eval_parse.
- *
- *==============================================================================================================*/	
-static int	eval_compute ( eval_stack *  stack, eval_double *  output, eval_callback  callback )
-   {
-	eval_double *		value_stack ;				// Stack of intermediary floating point values
-	int			value_stack_top		=  -1 ;
-	eval_stack_entry *	se ;					// Current stack entry
-	operator_token *	ot ;					// Current token
-	int			i ;
-	eval_double		value1			=  0,		// Result + values for binary operators
-				value2			=  0, 
-				result			=  0 ;
-	int			status			=  1 ;		// Return code ; 1 = OK
-	eval_double *		function_args		=  NULL ;	// Placeholder used to store function arguments
-	int			function_args_max	=  0 ;
-
-
-	// Ignore empty parse trees
-	if  ( eval_stack_is_empty ( stack ) )
-		return ( 0 ) ;
-
-	// Allocate space for a new stack
-	value_stack	=  ( eval_double * ) eval_malloc ( ( stack -> last_item + 1 ) * sizeof ( eval_double ) ) ;
-
-	// Loop through expression tree items
-	for  ( i = 0 ; i  <=  stack -> last_item ; i ++ )
-	   {
-		se	=  stack -> data + i ;
-
-		switch  ( se -> type )
-		   {
-			// Push numeric entries onto the value stack
-			case	STACK_ENTRY_NUMERIC :
-				value_stack [ ++ value_stack_top ]	=  
-				result					= se -> value. double_value ;
-				break ;
-
-			// Apply operators ; One value is popped off the stack for unary operators, and two for binary ones
-			case	STACK_ENTRY_OPERATOR :
-				// Get current operator
-				ot	=  se -> value. operator_value ;
-
-				// Check that enough elements remain on the stack
-				if  ( ( ot -> unary  &&  value_stack_top  <  0 )  ||
-				      ( ! ot -> unary  &&  value_stack_top  <  1 ) )
-				   {
-					eval_error ( E_EVAL_STACK_EMPTY, -1, -1, "Stack does not contain enough elements to process the '%s' operator",
-							se -> value. operator_value -> token ) ;
-
-					return ( 0 ) ;
-				    }
-
-				// Pop one or two values from the stack, depending on whether the operator is unary or binary
-				if  ( ot -> unary )
-					value1	=  value_stack [ value_stack_top -- ] ;
-				else
-				   {
-					value1	=  value_stack [ value_stack_top -- ] ;
-					value2	=  value_stack [ value_stack_top -- ] ;
-				    }
-
-				// Process the operator
-				switch ( ot -> type )
-				   {
-					case	OP_PLUS :
-						result	=  value2 + value1 ;
-						break ;
-
-					case	OP_MINUS :
-						result	=  value2 - value1 ;
-						break ;
-
-					case	OP_MUL :
-						result	=  value1 * value2 ;
-						break ;
-
-					case	OP_DIV :
-						result	=  value2 / value1 ;
-						break ;
-
-					case	OP_IDIV :
-						result	=  floor ( value2 / value1 ) ;
-						break ;
-
-					case	OP_POWER :
-						result	=  pow ( value2, value1 ) ;
-						break ;
-
-					case	OP_MOD :
-						result	=  fmod ( value2, value1 ) ;
-						break ;
-
-					case	OP_AND :
-						result	=  ( eval_double ) ( ( ( eval_int ) value1 )  &  ( ( eval_int ) value2 ) );
-						break ;
-
-					case	OP_OR :
-						result	=  ( eval_double ) ( ( ( eval_int ) value1 )  |  ( ( eval_int ) value2 ) ) ;
-						break ;
-
-					case	OP_XOR :
-						result	=  ( eval_double ) ( ( ( eval_int ) value1 )  ^  ( ( eval_int ) value2 ) ) ;
-						break ;
-
-					case	OP_NOT :
-						result	=  ( eval_double ) ( ~( ( eval_int ) value1 ) ) ;
-						break ;
-
-					case	OP_UNARY_PLUS :
-						break ;
-
-					case	OP_UNARY_MINUS :
-						result	=  -value1 ;
-						break ;
-
-					case	OP_SHL :
-						result	=  ( eval_double ) ( ( ( eval_int ) value2 )  <<  ( ( eval_int ) value1 ) ) ;
-						break ;
-
-					case	OP_SHR :
-						result	=  ( eval_double ) ( ( ( eval_int ) value2 )  >>  ( ( eval_int ) value1 ) ) ;
-						break ;
-
-					case	OP_FACTORIAL :
-						result	=  eval_factorial ( value1 ) ;
-						break ;
-
-					// Paranoia : Changes have been made to the supported operator list, but not reflected here
-					default :
-						eval_error ( E_EVAL_UNDEFINED_OPERATOR,  -1, -1, "Undefined operator '%s' found", ot -> token ) ;
-						status	=  0 ;
-						goto  ComputeEnd ;
-				    }
-
-				value_stack [ ++ value_stack_top ]	=  result ;
-				break ;
-
-			// Constant name
-			case	STACK_ENTRY_NAME :
-			   {
-				evaluator_constant_definition *		def ;	
-				
-				
-				def	=  ( evaluator_constant_definition * ) eval_find_primitive ( 
-											& eval_constant_definitions, 
-											se -> value. string_value ) ;
-
-
-				if  ( def  !=  NULL )
-				   {
-					value_stack [ ++ value_stack_top ]	=  
-					result					=  def -> value ;
-				    }
-				else
-				   {
-					eval_error ( E_EVAL_UNDEFINED_CONSTANT, -1, -1, "Undefined constant '%s'", 
-							se -> value. string_value ) ;
-					status	=  0 ;
-
-					goto  ComputeEnd ;
-				    }
-
-				break ;
-			    }
-
-			// Variable reference
-			case	STACK_ENTRY_VARIABLE :
-			   {
-				eval_double 	callback_result ;
-				int		callback_status		=  callback ( se -> value. string_value, & callback_result ) ;
-
-				if  ( callback_status  ==  EVAL_CALLBACK_UNDEFINED )
-				   {
-					eval_error ( E_EVAL_UNDEFINED_VARIABLE, -1, -1, "Undefined variable '%s'",
-							se -> value. string_value ) ;
-					status	=  0 ;
-
-					goto  ComputeEnd ;
-				    }
-
-				value_stack [ ++ value_stack_top ]	=  
-				result					=  callback_result ;
-				break ;
-			    }
-
-			// Register recall
-			// The correctness of the register number has been checked in eval_parse() so we know here that
-			// the register number is ok
-			case	STACK_ENTRY_REGISTER_RECALL :
-			   {
-				int	regnum		=  se -> value. register_value ;
-
-				if  ( regnum  <  0 )
-				   {
-					if  ( eval_last_register  >=  0 )
-						regnum	=  eval_last_register ;
-				    }
-
-				if  ( regnum  >=  0  &&  eval_registers_set [ regnum ] )
-					value_stack [ ++ value_stack_top ]	=  
-					result					=  eval_registers [ regnum ] ;
-				else
-				   {
-					   eval_error ( E_EVAL_INVALID_REGISTER_INDEX, -1, -1,  "Register #%d has not been assigned any value", ( int ) regnum ) ;
-					   status	=  0 ;
-					   goto ComputeEnd ;
-				    }
-
-				break ;
-			    }
-
-			// Register save 
-			//	Save the last value of the value stack into the specified register
-			case	STACK_ENTRY_REGISTER_SAVE :
-			   {
-				int	regnum		=  se -> value. register_value ;
-
-				if  ( regnum  <  0 )
-				   {
-					if  ( eval_last_register  <  0 )
-						regnum	=  0 ;
-					else
-						regnum	=  eval_last_register + 1 ;
-				    }
-
-				eval_registers [ regnum ]	=  value_stack [ value_stack_top ] ;
-				eval_registers_set [ regnum ]	=  ( char ) 1 ;
-				eval_last_register		=  regnum ;
-				break ;
-			    }
-
-			// Function call
-			case	STACK_ENTRY_FUNCTION_CALL :
-			   {
-				evaluator_function_definition *		def ;	
-				int					argc	=  se -> value. function_value. argc ;
-				
-				
-				def	=  ( evaluator_function_definition * ) eval_find_primitive ( 
-											& eval_function_definitions, 
-											se -> value. function_value. name ) ;
-
-				// Function exists
-				if  ( def  !=  NULL )
-				   {
-					int	stack_arguments			=  value_stack_top + 1 ;
-
-					// Not enough or too much parameters specified : generate an error
-					if  ( stack_arguments  <  argc )
-					   {
-						eval_error ( E_EVAL_IMPLEMENTATION_ERROR, -1, -1, "Not enough parameters (%d) remain on stack for function %s()",
-								stack_arguments, def -> name ) ;
-						status	=  0 ;
-
-						goto  ComputeEnd ;
-					    }
-					// Argument count falls within the acceptable range of arguments
-					// Note that if arguments on the stack are less than the number of arguments specified
-					// during the function call, then there is an implementation error
-					else if  ( argc  >=  def -> min_args  &&  argc  <=  def -> max_args )
-					   {
-						int		j ;
-
-						// Ensure that the function_args array has enough entries to store function arguments
-						if  ( argc + 1  >  function_args_max )
-						   {
-							int	count		=  NEXT_INCREMENT ( argc, ARGUMENT_INCREMENT ) + 1 ;
-
-							if  ( function_args  ==  NULL )
-								function_args	=  ( eval_double * ) eval_malloc ( count * sizeof ( eval_double ) ) ;
-							else
-								function_args	=  ( eval_double * ) eval_realloc ( function_args, count * sizeof ( eval_double ) ) ;
-						     }
-
-						// Collect arguments in a separate array
-						for  ( j = argc - 1 ; j  >=  0 ; j -- )
-							function_args [j]	=  value_stack [ value_stack_top -- ] ;
-
-						// Call the function
-						value_stack [ ++ value_stack_top ]	=  
-						result					=  def -> func ( argc, function_args ) ;
-					    }
-					else
-					   {
-						eval_error ( E_EVAL_BAD_ARGUMENT_COUNT, -1, -1, "Bad number of arguments (%d) for function %s() ;"
-								" authorized range is %d..%d",
-								argc, def -> name, def -> min_args, def -> max_args ) ;
-						status	=  0 ;
-
-						goto  ComputeEnd ;
-					    }
-				    }
-				// Undefined function name
-				else
-				   {
-					eval_error ( E_EVAL_UNDEFINED_FUNCTION, -1, -1, "Undefined function '%s'", 
-							se -> value. function_value. name ) ;
-					status	=  0 ;
-
-					goto  ComputeEnd ;
-				    }
-
-				break ;
-			    }
-
-			// Paranoia : Changes have been made to the supported token list, but not reflected here
-			default :
-				eval_error ( E_EVAL_UNDEFINED_TOKEN_TYPE, -1, -1, "Undefined token type '#%d'", se -> type ) ;
-				status	=  0 ;
-				goto  ComputeEnd ;
-		    }
-	    }
-
-	// Final result
-	if  ( value_stack_top  >  0 )			// More than one value on the stack : there must be a programmation error here...
-	   {
-		eval_error ( E_EVAL_IMPLEMENTATION_ERROR, -1, -1, "Value stack should hold at most one value" ) ;
-		status		=  0 ;
-
-		goto  ComputeEnd ;
-	    }
-
-	// Free any memory used to hold function arguments
-	if  ( function_args  !=  NULL )
-		eval_free ( function_args ) ;
-
-	* output	=  result ;
-
-ComputeEnd :
-	return ( status ) ;
-    }
-
-
-/*==============================================================================================================
- *
- *  eval_parse -
- *	Grammatical analyzer for expressions.
- *
- *==============================================================================================================*/	
-# define	DEFAULT_TOKEN_BUFFER_SIZE	64
-
-static int  eval_parse ( const char *		str, 
-			 eval_double *		value, 
-			 eval_stack *		output_stack, 
-			 eval_stack *		operator_stack, 
-			 eval_callback		callback ) 
-   { 
-	char * 			startp			=  0,			// Start and end of next token in the input string
-	     *			endp			=  0 ;
-	void *			param			=  0 ;			// Data returned by the eval_lex() function
-	operator_token *	op ;						// Operator token (may be returned by eval_lex)
-	int 			token ;						// Token value
-	int 			last_token 		=  TOKEN_EOF ;		// Last seen token value
-	int 			status 			=  1 ;			// Return value (0 = bad...)
-	eval_stack_entry 	stack_entry ;					// Entry to be added onto the stack
-	char *			current_token		=  ( char * ) eval_malloc ( DEFAULT_TOKEN_BUFFER_SIZE ) ;
-	int			current_token_length	=  0,			// A copy of the current token in the input string, its length and max length seen so far
-				max_token_length	=  DEFAULT_TOKEN_BUFFER_SIZE ;
-	int			character		=  0,			// Current character and line position
-				line			=  1 ;
-	int			inert_token ;					// Set to 1 when "inert" constructs, such as #! have been found
-										// In this case, the last_token variable will keep its original value
-	eval_stack_entry *	se ;
-	int			parentheses_nesting	[ MAX_NESTED_FUNCTION_CALLS ] ;
-	int			function_args		[ MAX_NESTED_FUNCTION_CALLS ] ;
-	int			nesting_level		=  0 ;
-
-
-	parentheses_nesting [0]		=  0 ;
-
-	// The default value of an expression evaluation is not something which may look like 'undefined', but zero
-	* value		=  0 ;
-
-	// Retrieve tokens one by one from the input string
-	while  ( * str )
-	   {
-		token 			=  eval_lex ( ( char * ) str, & startp, & endp, & param, & line, & character ) ;
-		inert_token		=  0 ;
-
-		// Always hold the current token in a nul-terminated string
-		// The main purpose is to use it easily for error messages
-		current_token_length	=  endp - startp ;
-
-		if  ( current_token_length + 1  >=  max_token_length ) 
-		   {
-			max_token_length	*=  2 ;
-			eval_free ( current_token ) ;
-			current_token		 =  ( char * ) eval_malloc ( max_token_length ) ;
-		    }
-
-		strncpy ( current_token, startp, current_token_length ) ;
-		current_token [ current_token_length ]	=  '\0' ;
-
-		// Process current token
-		switch ( token )
-		   {
-			// End of string : stop parsing
-			case 	TOKEN_EOF :
-				goto ParseEnd ;
-			
-			// Unexpected character found
-			case 	TOKEN_ERROR :
-				eval_error ( E_EVAL_UNEXPECTED_CHARACTER, line, character, "Unexpected character '%c'", * endp ) ;
-				status 	=  0 ;
-				goto ParseEnd ;
-			
-			// Number found 
-			case 	TOKEN_NUMBER :
-			   {
-				eval_double		numeric_value ;
-				int 			converted ;
-				
-
-				// A number can occur only :
-				// - At the start of an expression
-				// - After an operator
-				// - In a function call, after an opening parenthesis or a comma
-				if  ( ! ( last_token & ( TOKEN_EOF | TOKEN_OPERATOR | TOKEN_COMMA | TOKEN_LEFT_PARENT ) ) )
-				   {
-					eval_error ( E_EVAL_UNEXPECTED_NUMBER, line, character, "Unexpected number '%s'", current_token ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-
-				// Convert current token to a double value
-				converted	=  eval_double_value ( current_token, current_token_length, & numeric_value ) ;
-
-				// Conversion successful
-				if  ( converted )
-				   {
-					stack_entry. type 			=  STACK_ENTRY_NUMERIC ;
-					stack_entry. value. double_value 	=  numeric_value ;
-					   
-					eval_stack_push ( output_stack, & stack_entry ) ;
-				    }
-				// Some extraneous characters did not get interpreted correctly...
-				else
-				   {
-					eval_error ( E_EVAL_INVALID_NUMBER, line, character, "Invalid numeric value '%s'", current_token ) ;
-					status 	=  0 ;
-					   
-					goto  ParseEnd ;
-				    }
-				
-				break ;
-			    }
-			    
-			// Operators
-			case  	TOKEN_OPERATOR :
-				op			=  ( operator_token * ) param ;
-				stack_entry. type 	=  STACK_ENTRY_OPERATOR ;
-
-				// A plus/minus sign is considered as unary if it follows one of the following construct :
-				// - The start of the string
-				// - An operator (eg : 2+-3)
-				// - An opening parenthesis (eg: func(-3))
-				// The unary plus is silently ignored, since it does not affect its right-part value
-				if  ( last_token  &  ( TOKEN_OPERATOR | TOKEN_EOF | TOKEN_LEFT_PARENT ) )
-				   {
-					if  ( op -> type  ==  OP_PLUS )
-						break ;
-					else if  ( op -> type  ==  OP_MINUS )
-						op	=  & unary_minus ;
-					else if  ( ! op -> unary )
-					   {
-						eval_error ( E_EVAL_UNEXPECTED_OPERATOR, line, character, "Unexpected operator '%s'", current_token ) ;
-						status	=  0 ;
-
-						goto  ParseEnd ;
-					    }
-				    }  
-				// Otherwise, operators can only follow :
-				// - A number
-				// - A constant name 
-				// - A closing parenthesis
-				else if  ( ! ( last_token & ( TOKEN_NUMBER | TOKEN_NAME | TOKEN_VARIABLE | TOKEN_RIGHT_PARENT ) ) )
-				   {
-					eval_error ( E_EVAL_UNEXPECTED_OPERATOR, line, character, "Unexpected operator '%s'", current_token ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-				// Consider unary left-associative operators as inert : since they apply to their left operand (a number, a constant or a right parent)
-				// they are pushed immediately onto the output stack
-				else if  ( op -> unary  &&  op -> associativity  ==  ASSOC_LEFT )
-				   {
-					stack_entry. value. operator_value	=  op ;
-					eval_stack_push ( output_stack, & stack_entry ) ;
-					inert_token	=  1 ;
-
-					break ;
-				    }
-
-				/***
-					We have found operator op1. While there is an operator op2 in the operator stack, and either :
-					- op1 is left-associative and its precedence is less than or equal to op2 precedence, OR
-					- op1 is right-associative and its precedence is greater than op2 precedence
-					then we will pop op2 off the operator stack onto the output queue
-				 ***/
-				while  ( ! eval_stack_is_empty ( operator_stack ) )
-				   {
-					operator_token *	previous_op	=  operator_stack -> data [ operator_stack -> last_item ]. value. operator_value ;
-
-
-					if  ( ( ( op -> associativity  ==  ASSOC_LEFT   &&  op -> precedence  <=  previous_op -> precedence )   ||
-					        ( op -> associativity  ==  ASSOC_RIGHT  &&  op -> precedence  >   previous_op -> precedence ) )	&&
-					      previous_op -> type  !=  OP_LEFT_PARENT )
-					   {
-						eval_stack_pop ( operator_stack ) ;
-						stack_entry. value. operator_value	=  previous_op ;
-						eval_stack_push ( output_stack, & stack_entry ) ;
-					    }
-					else 
-						break ;
-				    }
-
-				// Now that precedence rules have been applied, we can push op1 to the operator stack 
-				stack_entry. value. operator_value	=  op ;
-				eval_stack_push ( operator_stack, & stack_entry ) ;
-
-				break ;
-
-			// Left parenthesis : consider it as a non-associative operator with the highest precedence or to a function call
-			case	TOKEN_LEFT_PARENT :
-				// Last token was a name, so this is a function call 
-				// We consider function calls with n arguments as n-ary operators ; thus , f(1,2,3,4) will give on the stack :
-				// - STACK_ENTRY_NUMBER (1)
-				// - STACK_ENTRY_NUMBER (2)
-				// - STACK_ENTRY_NUMBER (3)
-				// - STACK_ENTRY_NUMBER (4)
-				// - STACK_ENTRY_FUNCTION_CALL, argc = 4
-				if  ( last_token  &  TOKEN_NAME ) 
-				   {
-					eval_stack_entry *		se ;
-
-					if  ( nesting_level + 1  >  MAX_NESTED_FUNCTION_CALLS )
-					   {
-						eval_error ( E_EVAL_TOO_MANY_NESTED_CALLS, line, character, "Too many nested function calls" ) ;
-						status	=  0 ;
-
-						goto  ParseEnd ;
-					    }
-
-					se		=  ( eval_stack_entry * ) eval_stack_pop ( output_stack ) ; 
-					se -> type	=  STACK_ENTRY_FUNCTION_CALL ;
-					eval_stack_push ( operator_stack, se ) ;
-
-					parentheses_nesting [ ++ nesting_level ]	=  1 ;
-					function_args [ nesting_level ]			=  0 ;
-				    }
-				// Otherwise, this is simply for expression grouping
-				else if  ( last_token  &  ( TOKEN_EOF | TOKEN_LEFT_PARENT | TOKEN_OPERATOR | TOKEN_COMMA ) )
-				   {
-					stack_entry. type			=  STACK_ENTRY_OPERATOR ;
-					stack_entry. value. operator_value	=  & left_parenthesis ;
-					eval_stack_push ( operator_stack, & stack_entry ) ;
-
-					parentheses_nesting [ nesting_level ] ++ ;
-				    }
-				else
-				   {
-					eval_error ( E_EVAL_UNEXPECTED_TOKEN, line, character, "Unexpected opening parenthesis" ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-
-				break ;
-
-			/***
-				Right parenthesis :
-				- Until the token at the top of the stack is a left parenthesis, pop operators off the stack onto the output queue.
-				- Pop the left parenthesis from the stack, but not onto the output queue.
-				- If the token at the top of the stack is a function token, pop it onto the output queue.
-				- If the stack runs out without finding a left parenthesis, then there are mismatched parentheses.
-			 ***/
-			case	TOKEN_RIGHT_PARENT :
-			   {
-				int		found_left	=  0 ;
-
-				// Closing parenthesis ends an expression grouping, not a function call
-				if  ( ( last_token  &  ( TOKEN_NUMBER | TOKEN_RIGHT_PARENT | TOKEN_NAME | TOKEN_VARIABLE | TOKEN_LEFT_PARENT ) ) )
-				   {
-					// Count one more argument if previous token was not a left parenthesis 
-					if  ( ! ( last_token  &  ( TOKEN_LEFT_PARENT ) ) )
-						function_args [ nesting_level ] ++ ;
-
-					// Push all operators until an opening parenthesis has been found
-					while  ( ! eval_stack_is_empty ( operator_stack ) )
-					   {
-						eval_stack_entry *	se		=  ( eval_stack_entry * ) eval_stack_pop ( operator_stack ) ;
-						operator_token *	previous_op	=  se -> value. operator_value ;
-
-						if  ( se -> type  ==  STACK_ENTRY_FUNCTION_CALL )
-						   {
-							se -> value. function_value. argc	=  function_args [ nesting_level ] ;
-							eval_stack_push ( output_stack, se ) ;
-							found_left	=  1 ;
-							break ;
-						    }
-						else if  ( previous_op -> type  ==  OP_LEFT_PARENT )
-						   {
-							found_left	=  1 ;
-							break ;
-						    }
-						else
-						   {
-							eval_stack_push ( output_stack, se ) ;
-						    }
-					    }
-				    }
-
-				// A nested level greater than zero means that we are in a nested function call ; 
-				// When the parentheses nesting within this call reaches 1, then this means that the 
-				// closing parenthesis we just encountered is finishing the call
-				if  ( ! ( last_token & TOKEN_COMMA )  &&  nesting_level > 0  &&  parentheses_nesting [ nesting_level ]  ==  1 )
-					found_left				=  1 ;
-
-				// Opening parenthesis not found
-				if  ( ! found_left ) 
-				   {
-					eval_error ( E_EVAL_UNEXPECTED_RIGHT_PARENT, line, character, "Unexpected closing parenthesis" ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-
-				parentheses_nesting [ nesting_level ] -- ;
-
-				if  ( ! parentheses_nesting [ nesting_level ] )
-				   {
-					if  ( nesting_level  >  0 )
-						nesting_level -- ;
-				    }
-
-				break ;
-			    }
-
-			// Name : either a constant or a function
-			case	TOKEN_NAME :
-				if  ( ! ( last_token & ( TOKEN_EOF | TOKEN_OPERATOR | TOKEN_COMMA | TOKEN_LEFT_PARENT ) ) )
-				   {
-					eval_error ( E_EVAL_UNEXPECTED_NAME, line, character, "Unexpected name '%s'", current_token ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-
-				stack_entry. type			=  STACK_ENTRY_NAME ;
-				stack_entry. value. string_value	=  eval_strdup ( current_token ) ;
-				eval_stack_push ( output_stack, & stack_entry ) ;
-				break ;
-
-			// Variable name
-			case	TOKEN_VARIABLE :
-				if  ( callback  ==  NULL )
-				   {
-					eval_error ( E_EVAL_VARIABLES_NOT_ALLOWED, line, character, 
-						"Variable references are not allowed when you use the evaluate() function.\n" 
-						"Use the evaluate_ex() function instead (referenced variable : %s)",
-						current_token ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-				else if  ( ! ( last_token & ( TOKEN_EOF | TOKEN_OPERATOR | TOKEN_COMMA | TOKEN_LEFT_PARENT ) ) )
-				   {
-					eval_error ( E_EVAL_UNEXPECTED_VARIABLE, line, character, "Unexpected variable reference '%s'", current_token ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-
-				stack_entry. type			=  STACK_ENTRY_VARIABLE ;
-				stack_entry. value. string_value	=  eval_strdup ( current_token ) ;
-				eval_stack_push ( output_stack, & stack_entry ) ;
-
-				break ;
-
-			// Save to register
-			case	TOKEN_REGISTER_SAVE :
-			   {
-				int		register_id		=  * ( int * ) param ;
-
-
-				if  ( register_id  >=  MAX_REGISTERS )
-				   {
-					eval_error ( E_EVAL_INVALID_REGISTER_INDEX, line, character, "Invalid register index %d (range is 0..%d)",
-							register_id, MAX_REGISTERS - 1 ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-
-				stack_entry. type			=  STACK_ENTRY_REGISTER_SAVE ;
-				stack_entry. value. register_value	=  register_id ;
-				eval_stack_push ( output_stack, & stack_entry ) ;
-
-				// This token is inert and won't be remembered during the parsing
-				inert_token	=  1 ;
-				break ;
-			    }
-
-			// Recall register value
-			case	TOKEN_REGISTER_RECALL :
-			   {
-				int		register_id		=  * ( int * ) param ;
-
-
-				if  ( ! ( last_token & ( TOKEN_EOF | TOKEN_OPERATOR | TOKEN_COMMA | TOKEN_LEFT_PARENT ) ) )
-				   {
-					eval_error ( E_EVAL_UNEXPECTED_TOKEN, line, character, "Unexpected register '%s' value recall", current_token ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-
-				if  ( register_id  >=  MAX_REGISTERS )
-				   {
-					eval_error ( E_EVAL_INVALID_REGISTER_INDEX, line, character, "Invalid register index %d (allowed range is 0..%d)",
-							register_id, MAX_REGISTERS - 1 ) ;
-					status	=  0 ;
-
-					goto  ParseEnd ;
-				    }
-
-				stack_entry. type			=  STACK_ENTRY_REGISTER_RECALL ;
-				stack_entry. value. register_value	=  register_id ;
-				eval_stack_push ( output_stack, & stack_entry ) ;
-				break ;
-			    }
-
-			// Function argument separator (comma)
-			case	TOKEN_COMMA :
-				if  ( last_token  &  ( TOKEN_NUMBER | TOKEN_NAME | TOKEN_RIGHT_PARENT ) )
-				   {
-					int		found_parent	=  0 ;
-
-					function_args [ nesting_level ] ++ ;
-
-					// Pop every operator off the operator stack and push it onto the output stack until a function call or a
-					// left parenthesis has been found. A call like : f ( 1, 2+3, 4 ) will finally look on the stack as :
-					//	1 2 3 + 4 f 
-					// Once all the operations will be applied, the stack will look like :
-					//	1 5 4 f
-					// And since "f" is a 3-ary operator (because "f" was called with three arguments), the resulting stack will be :
-					//	x
-					// where "x" is the result of f(1, 5, 4)
-					while  ( ! eval_stack_is_empty ( operator_stack ) )
-					   {
-						eval_stack_entry *	se		=  ( eval_stack_entry * ) eval_stack_pop ( operator_stack ) ;
-
-						// A function call is a stop condition for this loop, but we need to push it onto the output stack
-						if  ( se -> type  ==  STACK_ENTRY_FUNCTION_CALL )
-						   {
-							eval_stack_push ( operator_stack, se ) ;
-							found_parent	=  1 ;
-							break ;
-						    }
-						// Left parenthesis is also a stop condition, but we do not push it onto the output stack
-						else if  ( se -> value. operator_value -> type  ==  OP_LEFT_PARENT ) 
-						   {
-							found_parent	=  1 ;
-							break ;
-						    }
-						// Other operators : push the onto the output stack
-						else
-							eval_stack_push ( output_stack, se ) ;
-					    }
-
-					// Neither left parenthesis nor function call found on the operator stack
-					if  ( ! found_parent )
-					   {
-						eval_error ( E_EVAL_UNEXPECTED_ARG_SEPARATOR, line, character, "Unexpected argument delimiter ',' found" ) ;
-						status	=  0 ;
-
-						goto  ParseEnd ;
-					    }
-				    }
-				else
-				   {
-					eval_error ( E_EVAL_UNEXPECTED_ARG_SEPARATOR, line, character, "Unexpected argument separator" ) ;
-					status	=  0 ;
-
-					goto ParseEnd ;
-				    }
-
-				break ;
-
-			// Unexpected token
-			default :
-				eval_error ( E_EVAL_UNEXPECTED_TOKEN, line, character, "Unexpected token #%d", token ) ;
-				status 	=  0 ;
-				goto  ParseEnd ;
-		    }
-		
-		// Update pointer to current character 
-		str 		=  endp ;
-
-		// Remember last token type seen so far ; this helps providing some kind of syntax checking 
-		// before computing the expression result
-		if  ( ! inert_token )
-			last_token 	=  token ;
-
-		character	+=  endp - startp ;
-	    }
-	    
-ParseEnd:
-	// Possible error in expression
-	if  ( ! status )			// Some error occured
-		goto  ParseReturn ;
-	else if  ( nesting_level )
-	   {
-		eval_error ( E_EVAL_UNTERMINATED_FUNCTION_CALL, line, character, "Unterminated function call" ) ;
-		status	=  0 ;
-
-		goto	ParseReturn ;
-	    }
-	else if  ( parentheses_nesting [0] )	// Unbalanced parentheses
-	   {
-		eval_error ( E_EVAL_UNBALANCED_PARENTHESES, line, character, "Unbalanced parentheses" ) ;
-		status	=  0 ;
-
-		goto  ParseReturn ;
-	    }
-
-	// Pop all the remaining elements from the operator stack to the output stack
-	while  ( ( se = ( eval_stack_entry * ) eval_stack_pop ( operator_stack ) )  !=  NULL )
-		eval_stack_push ( output_stack, se ) ;
-
-# if	EVAL_DEBUG
-	//eval_dump_constants ( ) ;
-	//eval_dump_functions ( ) ;
-	eval_dump_stack ( output_stack, "output stack" ) ;
-# endif
-
-	// Compute the result
-	status	=  eval_compute ( output_stack, value, callback ) ;
-
-ParseReturn :
-	eval_free ( current_token ) ;
-	    
-	// All done, return
-	return ( status ) ;
-    }
- 
-
-/*==============================================================================================================
- *
- *  evaluate -
- *	Expression analyzer.
- *
- *==============================================================================================================*/	
-int	__evaluate__ ( const char *  str, double *  output, eval_callback  callback )
-   {
-	eval_stack * 		output_stack 	=  ( eval_stack * ) eval_stack_alloc ( OUTPUT_STACK_SIZE  , sizeof ( eval_stack_entry ) ) ;
-	eval_stack *		operator_stack 	=  ( eval_stack * ) eval_stack_alloc ( OPERATOR_STACK_SIZE, sizeof ( eval_stack_entry ) ) ;
-	int			status ;
-	eval_double		result ;
-
-
-	// Initialize package if needed
-	if  ( ! eval_initialized )
-		eval_initialize ( ) ;
-
-	eval_instance_initialize ( ) ;
-
-	// Parse expression
-	status	  		=  eval_parse ( str, & result, output_stack, operator_stack, callback ) ;
-	* output		=  ( double ) result ;
-
-	// Free stack data
-	eval_stack_free ( output_stack ) ;
-	eval_stack_free ( operator_stack ) ;
-
-	// All done, return
-	return ( status ) ;
-    }
-
-
-int	evaluate ( const char *  str, double *  output )
-   {
-	return ( __evaluate__ ( str, output, NULL ) ) ;
-    }
-
-
-int	evaluate_ex ( const char *  str, double *  output, eval_callback  callback )
-   {
-	return ( __evaluate__ ( str, output, callback ) ) ;
-    }
-
-
-/*==============================================================================================================
- *
- *  evaluator_perror -
- *	Prints the last expression evaluation error message.
- *
- *==============================================================================================================*/	
-static struct eval_error_code
-   {
-	char *		name ;
-	int		code ;
-    }  eval_error_codes []	=
-   {
-	{ "E_EVAL_OK"				, E_EVAL_OK				},
-	{ "E_EVAL_UNEXPECTED_CHARACTER"		, E_EVAL_UNEXPECTED_CHARACTER		},
-	{ "E_EVAL_INVALID_NUMBER"		, E_EVAL_INVALID_NUMBER			},
-	{ "E_EVAL_UNEXPECTED_TOKEN"		, E_EVAL_UNEXPECTED_TOKEN		},
-	{ "E_EVAL_UNEXPECTED_NUMBER"		, E_EVAL_UNEXPECTED_NUMBER		},
-	{ "E_EVAL_UNEXPECTED_OPERATOR"		, E_EVAL_UNEXPECTED_OPERATOR		},
-	{ "E_EVAL_STACK_EMPTY"			, E_EVAL_STACK_EMPTY			},
-	{ "E_EVAL_UNDEFINED_OPERATOR"		, E_EVAL_UNDEFINED_OPERATOR		},
-	{ "E_EVAL_UNDEFINED_TOKEN_TYPE"		, E_EVAL_UNDEFINED_TOKEN_TYPE		},
-	{ "E_EVAL_UNBALANCED_PARENTHESES"	, E_EVAL_UNBALANCED_PARENTHESES		},
-	{ "E_EVAL_UNEXPECTED_RIGHT_PARENT"	, E_EVAL_UNEXPECTED_RIGHT_PARENT	},
-	{ "E_EVAL_UNDEFINED_CONSTANT"		, E_EVAL_UNDEFINED_CONSTANT		},
-	{ "E_EVAL_UNEXPECTED_NAME"		, E_EVAL_UNEXPECTED_NAME		},
-	{ "E_EVAL_IMPLEMENTATION_ERROR"		, E_EVAL_IMPLEMENTATION_ERROR		},
-	{ "E_EVAL_INVALID_REGISTER_INDEX"	, E_EVAL_INVALID_REGISTER_INDEX		},
-	{ "E_EVAL_REGISTER_NOT_SET"		, E_EVAL_REGISTER_NOT_SET		},
-	{ "E_EVAL_UNDEFINED_FUNCTION"		, E_EVAL_UNDEFINED_FUNCTION		},
-	{ "E_EVAL_UNTERMINATED_FUNCTION_CALL"	, E_EVAL_UNTERMINATED_FUNCTION_CALL	},
-	{ "E_EVAL_TOO_MANY_NESTED_CALLS"	, E_EVAL_TOO_MANY_NESTED_CALLS		},
-	{ "E_EVAL_UNEXPECTED_ARG_SEPARATOR"	, E_EVAL_UNEXPECTED_ARG_SEPARATOR	},
-	{ "E_EVAL_INVALID_FUNCTION_ARGC"	, E_EVAL_INVALID_FUNCTION_ARGC		},
-	{ "E_EVAL_BAD_ARGUMENT_COUNT"		, E_EVAL_BAD_ARGUMENT_COUNT		},
-	{ "E_EVAL_UNDEFINED_VARIABLE"		, E_EVAL_UNDEFINED_VARIABLE		},
-	{ "E_EVAL_VARIABLES_NOT_ALLOWED"	, E_EVAL_VARIABLES_NOT_ALLOWED		},
-	{ "E_EVAL_UNEXPECTED_VARIABLE"		, E_EVAL_UNEXPECTED_VARIABLE		},
-
-	{ NULL, 0 }
-    } ;
-
-static char *	eval_errnostr ( int  err ) 
-   {
-	static char			buffer [ 64 ] ;
-	struct eval_error_code *	p	=  eval_error_codes ;
-
-
-	while  ( p -> name  !=  NULL )
-	   {
-		if  ( p -> code  ==  err )
-			return ( p -> name ) ;
-
-		p ++ ;
-	    }
-
-	sprintf ( buffer, "errno = %d", err ) ;
-	return ( buffer ) ;
-    }
-
-
-void  evaluator_perror ( )
-   {
-	if  ( evaluator_errno )
-		fprintf ( stderr, "%s (%s) \n", evaluator_error, eval_errnostr ( evaluator_errno ) ) ;
-    }
-
-
-/*==============================================================================================================
- *
- *  evaluator_register_constants, evaluator_register_functions -
- *	Register new constants and functions.
- *
- *==============================================================================================================*/
-void  evaluator_register_constants ( const evaluator_constant_definition *	newdefs )
-   {
-	eval_register ( & eval_constant_definitions, newdefs ) ;
-    }
-
-void  evaluator_register_functions ( const evaluator_function_definition *	newdefs )
-   {
-	eval_register ( & eval_function_definitions, newdefs ) ;
-    }
-
-
-const evaluator_constant_definition *	evaluator_get_registered_constants  ( )
-   {
-	return ( ( evaluator_constant_definition * ) eval_constant_definitions. data ) ;
-    }
-
-
-const evaluator_function_definition *	evaluator_get_registered_functions  ( )
-   {
-	return ( ( evaluator_function_definition * ) eval_function_definitions. data ) ;
+/**************************************************************************************************************
+
+    NAME
+        eval.c
+
+    DESCRIPTION
+        Implements an expression evaluator, evaluate().
+	Based on Wikipedia shunting-yard algorightm description :
+
+		https://en.wikipedia.org/wiki/Shunting-yard_algorithm
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+# define	_USE_MATH_DEFINES
+
+# include   	<stdio.h>
+# include 	<string.h>
+# include 	<ctype.h>
+# include 	<malloc.h>
+# include 	<math.h>
+# include	<float.h>
+# include 	<stdarg.h>
+# include	<stdlib.h>
+
+# ifdef		WIN32
+#	define	WIN32_LEAN_AND_MEAN
+#	include	<windows.h>
+# else
+#	include	<pthread.h>
+# endif
+
+# include	"eval.h"
+# include	"evalfuncs.h"
+
+
+/*==============================================================================================================
+ *
+ *  Define the EVAL_DEBUG macro for debugging information.
+ *
+ *==============================================================================================================*/
+# ifndef	EVAL_DEBUG
+#	define	EVAL_DEBUG		0
+# else
+#	undef	EVAL_DEBUG
+#	define	EVAL_DEBUG		1
+# endif
+
+
+
+/*==============================================================================================================
+ *
+ *  Redefine these macros if needed to integrate the eval package into your environment.
+ *
+ *==============================================================================================================*/
+
+# ifndef	eval_malloc
+#	define 	eval_malloc( size ) 		malloc ( size )
+# endif
+
+# ifndef	eval_realloc
+#	define 	eval_realloc( p, size )		realloc ( p, size )
+# endif
+
+# ifndef	eval_strdup
+#	define 	eval_strdup( p )		strdup ( p ) 
+# endif
+
+# ifndef	eval_strndup
+#	define 	eval_strndup( s, size )		__eval_strndup__ ( s, size )
+# endif
+
+# ifndef	eval_free
+#	define 	eval_free( p )			free ( p ) 
+# endif
+
+ 
+// Indicates whetyher empty strings are to be considered as an error or converted to zero
+# ifndef	EVAL_DENY_EMPTY_STRINGS
+#	define	EVAL_DENY_EMPTY_STRINGS			0
+# else
+#	undef	EVAL_DENY_EMPTY_STRINGS
+#	define	EVAL_DENY_EMPTY_STRINGS			1
+# endif
+
+// When non-zero, the time spent in each phase of the evaluation is measured (see evalstats.h)
+# ifndef	EVAL_INSTRUMENTATION
+#	define	EVAL_INSTRUMENTATION			0
+# endif
+
+// When non-zero, calls to each function and operator are counted and timed (see evalstats.h)
+# ifndef	EVAL_PROFILER
+#	define	EVAL_PROFILER				0
+# endif
+
+
+/*==============================================================================================================
+ *
+ *  Constants.
+ *
+ *==============================================================================================================*/
+
+// Token classification
+# define 	TOKEN_ERROR 			0x8000 			// Invalid character found
+# define 	TOKEN_EOF 			0x0001			// Everything has been processed from the supplied input string
+# define 	TOKEN_NUMBER			0x0002			// Number (integer or float)
+# define 	TOKEN_NAME 			0x0004 			// Function name
+# define 	TOKEN_OPERATOR			0x0008			// Operator
+# define 	TOKEN_COMMA			0x0010 			// Argument separator for a function call
+# define	TOKEN_LEFT_PARENT		0x0020			// Left and right parentheses
+# define	TOKEN_RIGHT_PARENT		0x0040
+# define	TOKEN_REGISTER_SAVE		0x0080			// Save last computed value ($x! construct)
+# define	TOKEN_REGISTER_RECALL		0x0100			// Recall the specified computed value ($x?)
+# define	TOKEN_VARIABLE			0x0200			// Variable reference
+
+// Character classes used by the lexer ; they do not depend on the current locale
+# define	CHAR_SPACE			0x01			// Space, tab, carriage return, line feed, vertical tab and form feed
+# define	CHAR_NAME_START			0x02			// Letter or underline, which can start a name
+# define	CHAR_NAME			0x04			// Letter, digit or underline
+# define	CHAR_DIGIT			0x08			// Decimal digit
+# define	CHAR_XDIGIT			0x10			// Hexadecimal digit
+# define	CHAR_NUMBER			0x20			// Character that can appear in a number : letter, digit or dot
+
+// Operators
+# define	OP_PLUS 			 1
+# define 	OP_MINUS 			 2
+# define 	OP_MUL				 3
+# define 	OP_DIV 				 4
+# define 	OP_IDIV 			 5
+# define 	OP_POWER 			 6
+# define 	OP_MOD 				 7
+# define 	OP_AND				 8
+# define	OP_OR				 9
+# define	OP_XOR		  		10
+# define 	OP_NOT				11
+# define	OP_UNARY_PLUS			12
+# define	OP_UNARY_MINUS			13
+# define	OP_SHL				14
+# define	OP_SHR				15
+# define	OP_FACTORIAL			16
+# define	OP_LEFT_PARENT			50
+# define	OP_RIGHT_PARENT			51
+# define	OP_COMMA			52
+
+// Operator associativity
+# define 	ASSOC_NONE 			0
+# define 	ASSOC_LEFT 			1
+# define 	ASSOC_RIGHT 			2
+
+// Stack initial sizes
+# define 	OUTPUT_STACK_SIZE 		64
+# define 	OPERATOR_STACK_SIZE 		32
+
+// Arena allocation : alignment of allocated blocks, default size of the blocks obtained from eval_malloc(), and 
+// size of the local buffers used for temporary data during compilation and computation
+# define	ARENA_ALIGNMENT			16
+# define	ARENA_BLOCK_SIZE		4096
+# define	ARENA_COMPILE_BUFFER_SIZE	8192
+# define	ARENA_COMPUTE_BUFFER_SIZE	2048
+# define	ARENA_ROUND(size)		( ( ( size ) + ARENA_ALIGNMENT - 1 )  &  ~ ( size_t ) ( ARENA_ALIGNMENT - 1 ) )
+
+// Registers, numbered from 0 to MAX_REGISTERS - 1 
+# define	MAX_REGISTERS			64
+
+// Max nested function calls
+# define	MAX_NESTED_FUNCTION_CALLS	64
+
+/*==============================================================================================================
+ *
+ *  Operator definitions.
+ *
+ *==============================================================================================================*/
+typedef struct operator_token
+   {
+	char *		token ;
+	int 		length ;
+	int 		type ;
+	int 		precedence:8 ;
+	int 		associativity:2 ;
+	int 		unary:1 ;
+    }  operator_token ;
+
+
+/*==============================================================================================================
+ *
+ *  Stack definitions.
+ *
+ *==============================================================================================================*/
+
+// A "compiled" expression stack is generated by the eval_parse() function, then interpreted by eval_compute().
+// All stack entries have one of these types
+// Constant names are replaced with their value by eval_parse(), so they appear as numeric values
+# define 	STACK_ENTRY_NUMERIC 		0		// Numeric value
+# define 	STACK_ENTRY_OPERATOR 		2		// Operator
+# define	STACK_ENTRY_REGISTER_SAVE	3		// Save value on top of stack to te specified register
+# define	STACK_ENTRY_REGISTER_RECALL	4		// Push the specified register value on top of stack
+# define	STACK_ENTRY_FUNCTION_CALL	5		// Start of a function call
+# define	STACK_ENTRY_VARIABLE		6		// Variable reference
+# define	STACK_ENTRY_OUTPUT		7		// Store the value on top of stack as the result of an expression of a set
+
+// Output stack entry definition
+typedef struct eval_stack_entry
+   {
+	int 	type ;						// Stack entry type	
+	double	fast_value ;					// Value of numeric entries as a double, set by eval_compile()
+	union
+	   {
+		eval_double 		double_value ;		// Value
+		operator_token *	operator_value ;	// Operator definition
+		int			register_value ;	// Register
+		int			output_value ;		// Index of the result, for output entries
+
+		struct						// Function call, resolved by eval_parse()
+		   {
+			eval_function	func ;			// Function primitive
+			int		argc ;			// Number of arguments, checked against the function definition
+			int		flags ;			// EVAL_FUNCTION_* flags of the function definition
+			int		cost ;			// Cost hint of the function definition
+			eval_vector_function  vfunc ;	// Vector form of the function, or NULL
+		    } function_value ;
+
+		struct						// Variable reference
+		   {
+			char *		name ;			// Variable name, owned by the program variable table
+			int		slot ;			// Index of the variable in this table
+		    } variable_value ;
+	    } value ;	
+    }  eval_stack_entry ;
+    
+
+// Arena : memory is taken from blocks allocated by eval_malloc(), which are all freed at once by eval_arena_release().
+// An arena can also start with a buffer supplied by the caller, which is used before any block is allocated
+typedef struct  eval_arena_block
+   {
+	struct eval_arena_block *	next ;			// Block allocated before this one
+    }  eval_arena_block ;
+
+typedef struct  eval_arena
+   {
+	eval_arena_block *	blocks ;			// Allocated blocks, most recent first
+	char *			current ;			// Next free byte in the current block or buffer
+	char *			end ;				// End of the current block or buffer
+	char *			last ;				// Last allocation, which can be resized in place
+    }  eval_arena ;
+
+
+// Generic stack for values and operators
+typedef struct  eval_stack
+   {
+	int 			size ;				// Current number of items in the stack
+	int 			item_size ;			// Size of a stack item
+	int 			last_item ;			// Last item of the stack
+	eval_stack_entry *	data ;				// Stack data
+	eval_arena *		arena ;				// Arena the stack data is allocated from
+    }  eval_stack ;
+
+
+// Bytecode instructions, generated from the output stack by eval_assemble() and executed by eval_compute().
+// Each operator has its own opcode, which is the OP_* constant of the operator.
+// Instructions do not contain any pointer : functions are referenced through the functions[] array of the
+// program, so that bytecode can be saved to a file and used in place once mapped (see evalimage.h)
+# define	OPCODE_END			0		// End of program : the result is on top of the value stack
+# define	OPCODE_NUMBER			20		// Push a numeric value
+# define	OPCODE_VARIABLE			21		// Push the value of the variable whose slot is argument
+# define	OPCODE_REGISTER_SAVE		22		// Save the value on top of stack to cell argument
+# define	OPCODE_REGISTER_RECALL		23		// Push the value of cell argument
+# define	OPCODE_FUNCTION_CALL		24		// Call function with argument arguments
+# define	OPCODE_OUTPUT			25		// Pop the value on top of the stack into result argument of an expression set
+# define	OPCODE_COUNT			26		// Number of opcodes
+
+// Unary operators replace the value on top of the stack instead of combining the two topmost ones
+# define	EVAL_OPCODE_IS_UNARY(op)	( ( op )  ==  OP_NOT  ||  ( op )  ==  OP_UNARY_PLUS  ||  ( op )  ==  OP_UNARY_MINUS  ||  ( op )  ==  OP_FACTORIAL )
+
+typedef struct  eval_instruction
+   {
+	int		opcode ;				// OPCODE_* or OP_* constant
+	int		argument ;				// Variable slot, register cell or argument count
+	double		fast_value ;				// Numeric value as a double
+	union
+	   {
+		eval_double			number ;	// Numeric value
+		int				function ;	// Index of the function primitive in the functions[] array
+	    } value ;
+    }  eval_instruction ;
+
+
+// A compiled program, as returned by evaluator_compile() : this is simply the output stack built by eval_parse(),
+// which is assembled into bytecode by eval_assemble() so that it can be interpreted by eval_compute() any
+// number of times.
+// Each distinct variable name is assigned a slot when the expression is parsed ; the variable_value.slot field
+// of STACK_ENTRY_VARIABLE entries is an index into the variables[] array.
+// Once parsed, the program is checked by eval_link(), which computes the maximum depth of the value stack and
+// replaces register numbers with cell indexes (see the eval_link() function)
+// The program structure, its stacks, bytecode and variable names are all allocated from its arena, and freed 
+// at once by evaluator_free_program().
+// The output stack is only used while compiling ; programs loaded from a file (see evalimage.h) have no output
+// stack, their bytecode, variable names and functions being taken from the file
+struct  evaluator_program
+   {
+	eval_arena		arena ;				// Arena holding this structure and everything it references
+	eval_stack *		stack ;				// Output stack, in reverse-polish order
+	eval_instruction *	code ;				// Bytecode generated from the output stack
+	int			code_size ;			// Number of instructions, not including the final OPCODE_END
+	eval_function *		functions ;			// Functions called by the bytecode
+	int *			function_flags ;		// EVAL_FUNCTION_* flags of each entry in functions[]
+	eval_vector_function *	vector_functions ;		// Vector forms of the entries in functions[], used by batch evaluation
+	int			function_count ;		// Number of entries in functions[]
+	int			cost ;				// Estimated cost of a run, an arithmetic operator costing 1
+	const void *		image ;				// Image the program has been loaded from, or NULL
+	char **			variables ;			// Distinct variable names, indexed by slot
+	int			variable_count ;		// Number of used entries in variables[]
+	int			variable_max ;			// Number of allocated entries in variables[]
+	int			max_depth ;			// Max number of values simultaneously present on the value stack
+	int			cell_count ;			// Number of cells used for holding register values
+	int			max_argc ;			// Max argument count of a function call
+	int			flags ;				// EVAL_COMPILE_* flags
+	void *			jit_code ;			// Native code generated by eval_jit_compile(), or NULL
+	int			jit_size ;			// Size of the native code
+	int			cache_references ;		// Users of a program compiled by evaluate(), including the cache
+    } ;
+
+
+// An expression set, as returned by evaluator_compile_set() : the output stacks of all the expressions are 
+// concatenated into a single program, each one being followed by an output entry that pops its result. Common
+// subexpressions are thus eliminated across expressions, and variable slots are shared by all of them.
+// The set structure is allocated from the arena of its program
+struct  evaluator_expression_set
+   {
+	evaluator_program *	program ;			// Program computing all the expressions
+	int			count ;				// Number of expressions, and of results
+    } ;
+
+
+
+/*==============================================================================================================
+
+        Error information.
+	evaluator_errno and evaluator_error are only set by functions that use the default context of the
+	calling thread (see eval_leave()) ; they are thread-local, so that each thread sees its own errors.
+
+  ==============================================================================================================*/    
+EVAL_THREAD_LOCAL int		evaluator_errno ;
+EVAL_THREAD_LOCAL char 		evaluator_error [ 1024 ] ;
+
+
+/*==============================================================================================================
+
+        Evaluator contexts.
+	eval_context points to the context used by the evaluation currently running on this thread ; it is set
+	by the public entry points through eval_enter() and eval_leave(), so that internal functions such as
+	eval_error() do not need to receive it as a parameter.
+
+  ==============================================================================================================*/    
+# if	EVAL_PROFILER
+typedef struct  eval_profile_slot
+   {
+	eval_function			function ;	// Profiled function, or NULL if the slot is free
+	evaluator_profile_entry		entry ;		// Calls to this function
+    }  eval_profile_slot ;
+# endif
+
+struct  evaluator_context
+   {
+	int		error_number ;			// Last error code
+	char		error_message [ 1024 ] ;	// Last error message
+	int		use_degrees ;			// When non-zero, trigonometric functions use degrees
+# if	EVAL_INSTRUMENTATION
+	evaluator_phase_statistics	statistics ;	// Time spent in each phase
+# endif
+# if	EVAL_PROFILER
+	evaluator_profile_entry		operator_profile [ OPCODE_COUNT ] ;	// Calls to each operator, indexed by opcode
+	eval_profile_slot *		function_profile ;			// Calls to each function, hashed on the function address
+	int				function_profile_size ;			// Number of slots of function_profile ; a power of 2
+	int				function_profile_count ;		// Number of slots in use
+# endif
+    } ;
+
+static EVAL_THREAD_LOCAL evaluator_context *	eval_context ;			// Context of the current evaluation
+static EVAL_THREAD_LOCAL evaluator_context	eval_default_context ;		// Context used when none is specified
+
+
+/*==============================================================================================================
+
+        Operator definitions.
+
+  ==============================================================================================================*/    
+static operator_token 		operators []	=
+   {
+	{ "+"	, 1, OP_PLUS		,  5, ASSOC_LEFT , 0	},
+	{ "-"	, 1, OP_MINUS		,  5, ASSOC_LEFT , 0 	},
+	{ "*"	, 1, OP_MUL		,  8, ASSOC_LEFT , 0 	},
+	{ "/"	, 1, OP_DIV		,  8, ASSOC_LEFT , 0 	},
+	{ "\\"	, 1, OP_IDIV		,  8, ASSOC_LEFT , 0 	},
+	{ "**"	, 2, OP_POWER		,  9, ASSOC_RIGHT, 0	},
+	{ "%"	, 1, OP_MOD		,  8, ASSOC_LEFT , 0 	},
+	{ "&"	, 1, OP_AND		,  5, ASSOC_LEFT , 0 	},
+	{ "|"	, 1, OP_OR		,  5, ASSOC_LEFT , 0 	},
+	{ "^"	, 1, OP_XOR		,  5, ASSOC_LEFT , 0 	},
+	{ "~"	, 1, OP_NOT		, 10, ASSOC_RIGHT, 1  	},
+	{ "<<"	, 2, OP_SHL		,  5, ASSOC_LEFT , 0	},
+	{ ">>"	, 2, OP_SHR		,  5, ASSOC_LEFT , 0	},
+	{ "!"   , 1, OP_FACTORIAL	, 10, ASSOC_LEFT , 1    },
+	
+	{ NULL  , 0		,  0,           0, 0    }
+    } ;
+
+// Unary plus/minus need a special processing, since they use the same characters as their binary counterpart
+static operator_token		unary_minus		=
+	{ "-"	, 1, OP_UNARY_MINUS	, 10, ASSOC_RIGHT, 1	} ; 
+
+// Same for parentheses
+static operator_token		left_parenthesis	=
+	{ "("	, 1, OP_LEFT_PARENT	, 50, ASSOC_NONE , 0	} ;
+
+// Lexer tables, indexed by character and built by eval_initialize() :
+// - eval_character_classes gives the CHAR_* flags of each character
+// - eval_single_operators gives the one-character operator starting with a character
+// - eval_double_operators gives the two-character operator starting with a character, if any ; the lexer
+//   then only has to check the second character
+static unsigned char		eval_character_classes	[ 256 ] ;
+static operator_token *		eval_single_operators	[ 256 ] ;
+static operator_token *		eval_double_operators	[ 256 ] ;
+
+# define	EVAL_CHARACTER_CLASS(ch)	( eval_character_classes [ ( unsigned char ) ( ch ) ] )
+# define	EVAL_TO_UPPER(ch)		( ( ( ch )  >=  'a'  &&  ( ch )  <=  'z' ) ?  ( ch ) - 'a' + 'A' : ( ch ) )
+
+/*==============================================================================================================
+ *
+ *  Structures for constant and function definitions.
+ *
+ *==============================================================================================================*/
+
+// Increments for constant and function stores
+# define	PRIMITIVE_INCREMENT		64
+# define	ARGUMENT_INCREMENT		64
+# define	VARIABLE_INCREMENT		16
+# define	NEXT_INCREMENT(x,incr)		( ( ( (x) + (incr) - 1 ) / (incr) ) * (incr) )
+
+
+// Some kind of "base" class for constant and function definitions
+typedef struct  primitive_definition
+   {
+	char *		name ;
+    }  primitive_definition ;
+
+
+// Implements either a list of constants or functions
+typedef struct  primitive_list 
+   {
+	int		length ;
+	int		item_count ;
+	int		item_size ;
+	void *		data ;
+    }  primitive_list ;
+
+// Constants and functions list
+static primitive_list		eval_constant_definitions	=  { 0, 0, sizeof ( evaluator_constant_definition ), NULL },
+				eval_function_definitions	=  { 0, 0, sizeof ( evaluator_function_definition ), NULL } ;
+
+
+/*==============================================================================================================
+
+    eval_skip_spaces -
+	Skips spaces from the current position.
+
+  ==============================================================================================================*/    
+static char *	eval_skip_spaces ( char *  str, int *  line, int *  character )
+   {
+	while  ( EVAL_CHARACTER_CLASS ( * str )  &  CHAR_SPACE )
+	   {
+		( * character ) ++ ;
+
+		if  ( * str  ==  '\n' )
+		   {
+			( * line ) ++ ;
+			* character	=  1 ;
+		    }
+		else if  ( * str  !=  '\r' )
+			( * character ) ++ ;
+
+		str ++ ;
+	    }
+
+	return ( str ) ;
+     }
+
+
+/*==============================================================================================================
+
+    eval_register -
+        Called for registering constants & functions.
+
+  ==============================================================================================================*/
+static int	__eval_primitive_sort__ ( const void *  a, const void *  b )
+   {
+	return
+	   (
+		strcmp 
+		   (
+			( ( primitive_definition * ) a ) -> name,
+			( ( primitive_definition * ) b ) -> name
+		    )
+	    ) ;
+    }
+
+
+static void	eval_register ( primitive_list *  list, const void *  definitions )
+   {
+	int		count		=  0 ;
+	int		total_count ;
+	int		copy_size ;
+	int		new_length ;
+	const void *	p		=  definitions ;
+	void *		q ;
+
+
+	// First, count the number of new definitions ; the last definition must be an empty one (ie, at least the
+	// 'name' member must be null)
+	while  ( ( ( primitive_definition * ) p ) -> name  !=  NULL )
+	   {
+		count ++ ;
+		p		=  ( void * ) ( ( ( char * ) p ) + list -> item_size ) ;
+	    }
+
+	// Compute the total number of primitives to be stored
+	total_count	=  list -> item_count + count ;
+
+	// Total number of bytes to copy
+	copy_size	=  count * list -> item_size ;
+
+	// If the total number of primitives is greater than the actual size of the primitive list,
+	// then we will have some allocation work to perform
+	if  ( total_count  >  list -> length )
+	   {
+		new_length	=  NEXT_INCREMENT ( total_count, PRIMITIVE_INCREMENT ) ;
+
+		if  ( list -> length )   
+		   {
+			list -> length	=  new_length ;
+			list -> data	=  eval_realloc ( list -> data, new_length * list -> item_size ) ;
+		    }
+		else
+		   {
+			list -> length	 =  new_length ;
+			list -> data	 =  eval_malloc ( new_length * list -> item_size ) ;
+		    }
+	    }
+
+	// Make 'q' point to the first slot after the very last primitive of the list
+	q	=  ( void * ) ( ( ( char * ) ( list -> data ) ) + ( list -> item_count * list -> item_size ) ) ;
+
+	// Now copy the definitions after the last primitive of the list 
+	memcpy ( q, definitions,  copy_size ) ;
+	list -> item_count	+=  count ;
+
+	// And finally, sort primitive list
+	qsort ( list -> data, list -> item_count, list -> item_size, __eval_primitive_sort__ ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_find_primitive -
+        Finds a primitive (constant or function).
+
+  ==============================================================================================================*/
+static primitive_definition *	eval_find_primitive ( primitive_list *  list, char *  value )
+   {
+	int			low		=  0,
+				high		=  list -> item_count - 1,
+				middle ;
+	int			cmpresult ;
+	primitive_definition *	p ;
+
+
+	while  ( low  <=  high )
+	   {
+		middle		=  low + ( high - low ) / 2 ;
+		p		=  ( primitive_definition * ) ( ( ( char * ) list -> data ) + ( list -> item_size * middle ) ) ;
+		cmpresult	=  strcasecompare ( p -> name, value ) ;
+
+
+		if  ( cmpresult  <  0 )
+			low	=  middle + 1 ;
+		else if  ( cmpresult  >  0 )
+			high	=  middle - 1 ;
+		else
+			return ( p ) ;
+	    }
+
+	return ( NULL ) ;
+    }
+
+
+# if	EVAL_DEBUG
+/*==============================================================================================================
+
+	Debug functions for dumping constant and function definitions.
+
+  ==============================================================================================================*/
+void	eval_dump_constants ( )
+   {
+	int					i ;
+	evaluator_constant_definition *		p	=  ( evaluator_constant_definition * ) eval_constant_definitions. data ;
+
+
+	printf ( "Defined constants :\n" ) ;
+
+	for  ( i = 0 ; i  <  eval_constant_definitions. item_count ; i ++, p ++ )
+	   {
+		printf ( "\t%-32s = %lg\n", p -> name, ( double ) p -> value ) ;
+	    }
+    }
+
+
+void	eval_dump_functions ( )
+   {
+	int					i ;
+	evaluator_function_definition *		p	=  ( evaluator_function_definition * ) eval_function_definitions. data ;
+
+
+	printf ( "Defined functions :\n" ) ;
+
+	for  ( i = 0 ; i  <  eval_function_definitions. item_count ; i ++, p ++ )
+	   {
+		printf ( "\t%-32s (%d..%d)\n", p -> name, p -> min_args, p -> max_args ) ;
+	    }
+    }
+
+
+static void	eval_dump_stack ( eval_stack *  stack, char *  title )
+   {
+	int		i ;
+
+
+	printf ( "Dumping %s :\n", title ) ;
+
+	for  ( i = 0 ; i  <=  stack -> last_item ; i ++ )
+	   {
+		printf ( "\t" ) ;
+
+		switch ( stack -> data [i]. type )
+		   {
+			case	STACK_ENTRY_NUMERIC :
+				printf ( "NUMBER   : %lg\n", ( double ) stack -> data [i]. value. double_value ) ;
+				break ;
+
+			case	STACK_ENTRY_OPERATOR :
+				printf ( "OPERATOR : %s\n", stack -> data [i]. value. operator_value -> token ) ;
+				break ;
+
+			case	STACK_ENTRY_REGISTER_SAVE :
+				printf ( "REGSAVE  : %d\n", stack -> data [i]. value. register_value ) ;
+				break ;
+
+			case	STACK_ENTRY_REGISTER_RECALL :
+				printf ( "REGCALL  : %d\n", stack -> data [i]. value. register_value ) ;
+				break ;
+
+			case	STACK_ENTRY_FUNCTION_CALL :
+			   {
+				evaluator_function_definition *		def	=  ( evaluator_function_definition * ) eval_function_definitions. data ;
+				int					j ;
+
+				// Only the function pointer is kept in the output stack
+				for  ( j = 0 ; j  <  eval_function_definitions. item_count ; j ++ )
+				   {
+					if  ( def [j]. func  ==  stack -> data [i]. value. function_value. func )
+						break ;
+				    }
+
+				printf ( "FUNCTION : %s\n", ( j  <  eval_function_definitions. item_count ) ?  def [j]. name : "?" ) ;
+				break ;
+			    }
+
+			case	STACK_ENTRY_VARIABLE :
+				printf ( "VARIABLE : %s (slot #%d)\n", stack -> data [i]. value. variable_value. name,
+						stack -> data [i]. value. variable_value. slot ) ;
+				break ;
+
+			default :
+				printf ( "UNKNOWN  : type = %d\n", stack -> data [i]. type ) ;
+		    }
+	    }
+    }
+# endif
+
+
+/*==============================================================================================================
+ *
+ *  SIMD kernels for batch evaluation.
+ *
+ *==============================================================================================================*/	
+# include	"evalsimd.h"
+
+
+/*==============================================================================================================
+ *
+ *  Phase statistics and profiler.
+ *
+ *==============================================================================================================*/	
+# include	"evalstats.h"
+
+
+/*==============================================================================================================
+ *
+ *  eval_initialize -
+ *	Initializes the eval package.
+ *
+ *==============================================================================================================*/	
+static void  eval_initialize_lexer ( )
+   {
+	operator_token *	op ;
+	int			ch ;
+
+
+	for  ( ch = 0 ; ch  <  256 ; ch ++ )
+	   {
+		unsigned char	flags	=  0 ;
+
+		if  ( ch  ==  ' '  ||  ( ch  >=  '\t'  &&  ch  <=  '\r' ) )
+			flags	|=  CHAR_SPACE ;
+
+		if  ( ( ch  >=  'a'  &&  ch  <=  'z' )  ||  ( ch  >=  'A'  &&  ch  <=  'Z' )  ||  ch  ==  '_' )
+			flags	|=  CHAR_NAME_START | CHAR_NAME ;
+
+		if  ( ch  >=  '0'  &&  ch  <=  '9' )
+			flags	|=  CHAR_DIGIT | CHAR_NAME ;
+
+		if  ( ( ch  >=  '0'  &&  ch  <=  '9' )  ||  ( ch  >=  'a'  &&  ch  <=  'f' )  ||  ( ch  >=  'A'  &&  ch  <=  'F' ) )
+			flags	|=  CHAR_XDIGIT ;
+
+		if  ( ( flags  &  CHAR_NAME )  ||  ch  ==  '.' )
+			flags	|=  CHAR_NUMBER ;
+
+		eval_character_classes [ ch ]	=  flags ;
+	    }
+
+	for  ( op = operators ; op -> token  !=  NULL ; op ++ )
+	   {
+		if  ( op -> length  ==  1 )
+			eval_single_operators [ ( unsigned char ) op -> token [0] ]	=  op ;
+		else
+			eval_double_operators [ ( unsigned char ) op -> token [0] ]	=  op ;
+	    }
+    }
+
+
+static void  eval_initialize ( )
+   {
+	// Register default constants and functions
+	eval_register ( & eval_constant_definitions, default_constant_definitions ) ;
+	eval_register ( & eval_function_definitions, default_function_definitions ) ;
+
+	// Build the character tables used by eval_lex()
+	eval_initialize_lexer ( ) ;
+
+	// Select the SIMD kernels supported by this processor
+	eval_simd_initialize ( ) ;
+
+# if	EVAL_PROFILER
+	// Measure the cost of reading the clock, which is deducted from profiled calls
+	eval_profile_initialize ( ) ;
+# endif
+    }
+
+
+// Initialization is performed only once, even if several threads call the evaluator at the same time
+# ifdef		WIN32
+static INIT_ONCE	eval_initialized	=  INIT_ONCE_STATIC_INIT ;
+
+static BOOL CALLBACK	__eval_initialize_once__ ( PINIT_ONCE  once, PVOID  parameter, PVOID *  context )
+   {
+	eval_initialize ( ) ;
+	return ( TRUE ) ;
+    }
+
+#	define	EVAL_INITIALIZE()	InitOnceExecuteOnce ( & eval_initialized, __eval_initialize_once__, NULL, NULL )
+# else
+static pthread_once_t	eval_initialized	=  PTHREAD_ONCE_INIT ;
+
+#	define	EVAL_INITIALIZE()	pthread_once ( & eval_initialized, eval_initialize )
+# endif
+
+
+/*==============================================================================================================
+ *
+ *  eval_enter, eval_leave -
+ *	eval_enter() must be called by every public entry point that parses or computes an expression. It 
+ *	initializes the package if needed, resets the error information of the specified context (or of the
+ *	thread default context if NULL) and makes it the current one. It returns the context that was current
+ *	before, which must be passed to eval_leave() together with the return value of the entry point.
+ *	eval_leave() copies the error information to the evaluator_errno and evaluator_error thread-local
+ *	variables if the default context was used, then restores the previous context. Saving the previous context 
+ *	allows callbacks to evaluate other expressions.
+ *
+ *==============================================================================================================*/	
+static evaluator_context *	eval_enter ( evaluator_context *  context )
+   {
+	evaluator_context *	previous	=  eval_context ;
+
+
+	EVAL_INITIALIZE ( ) ;
+
+	if  ( context  ==  NULL )
+	   {
+		context			=  & eval_default_context ;
+		context -> use_degrees	=  evaluator_use_degrees ;
+	    }
+
+	context -> error_number		=  E_EVAL_OK ;
+	* context -> error_message	=  '\0' ;
+
+	eval_context		=  context ;
+	eval_use_degrees	=  context -> use_degrees ;
+
+	return ( previous ) ;
+    }
+
+
+static int	eval_leave ( evaluator_context *  previous, int  status )
+   {
+	if  ( eval_context  ==  & eval_default_context )
+	   {
+		evaluator_errno		=  eval_default_context. error_number ;
+
+		// The message is only copied on error ; the success path must stay cheap
+		if  ( evaluator_errno  ==  E_EVAL_OK )
+			* evaluator_error	=  '\0' ;
+		else
+			strcpy ( evaluator_error, eval_default_context. error_message ) ;
+	    }
+
+	eval_context	=  previous ;
+
+	if  ( previous  !=  NULL )
+		eval_use_degrees	=  previous -> use_degrees ;
+
+	return ( status ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_error -
+ *	Sets the error code and message of the current context.
+ *
+ *==============================================================================================================*/	
+static void  eval_error ( int  err, int  line, int character, char *  fmt, ... )
+   {
+	va_list 	ap ;
+	int		length ;
+	char *		message		=  eval_context -> error_message ;
+	   
+	   
+	eval_context -> error_number	=  err ;
+
+	if  ( line  ==  -1 )
+		length		=  sprintf ( message, "Eval error : " ) ;
+	else
+		length		=  sprintf ( message, "Eval error [line#%d, col#%d] : ", line, character + 1 ) ;
+
+	va_start ( ap, fmt ) ;
+	vsnprintf ( message + length, sizeof ( eval_context -> error_message ) - length, fmt, ap ) ;
+	va_end ( ap ) ;
+    }
+    
+
+/*==============================================================================================================
+ *
+ *  __eval_strndup__ -
+ *	Duplicates a fixed-length string.
+ *
+ *==============================================================================================================*/	
+static char *  __eval_strndup__ ( char *  s, int size )
+   {
+	char *		p	=  eval_malloc ( size ) ;
+
+	strncpy ( p, s, size ) ;
+
+	return ( p ) ;
+    }
+    
+
+
+/*==============================================================================================================
+ *
+ *   	Arena functions.
+ *	eval_arena_initialize() prepares an arena, using the optional buffer for the first allocations.
+ *	eval_arena_alloc() returns a block of memory aligned on ARENA_ALIGNMENT bytes.
+ *	eval_arena_realloc() resizes a block ; the last allocated block is resized in place when there is
+ *	enough room after it, otherwise a new block is allocated and the old one is abandoned to the arena.
+ *	eval_arena_strdup() duplicates a string.
+ *	eval_arena_release() frees all the blocks allocated so far ; the arena structure itself may reside in
+ *	one of them.
+ *
+ *==============================================================================================================*/	
+static void	eval_arena_initialize ( eval_arena *  arena, void *  buffer, size_t  size )
+   {
+	arena -> blocks		=  NULL ;
+	arena -> last		=  NULL ;
+
+	if  ( buffer  !=  NULL )
+	   {
+		arena -> current	=  ( char * ) ARENA_ROUND ( ( size_t ) buffer ) ;
+		arena -> end		=  ( char * ) buffer + size ;
+
+		if  ( arena -> current  >  arena -> end )
+			arena -> current	=  arena -> end ;
+	    }
+	else
+		arena -> current	=  arena -> end		=  NULL ;
+    }
+
+
+static void *	eval_arena_alloc ( eval_arena *  arena, size_t  size )
+   {
+	char *		p ;
+
+
+	size	=  ARENA_ROUND ( size ) ;
+
+	// Allocate a new block if the current one is full ; a block is never smaller than ARENA_BLOCK_SIZE
+	if  ( ( size_t ) ( arena -> end - arena -> current )  <  size  ||  arena -> current  ==  NULL )
+	   {
+		size_t			block_size	=  ARENA_ROUND ( sizeof ( eval_arena_block ) ) + size ;
+		eval_arena_block *	block ;
+
+
+		if  ( block_size  <  ARENA_BLOCK_SIZE )
+			block_size	=  ARENA_BLOCK_SIZE ;
+
+		block			=  ( eval_arena_block * ) eval_malloc ( block_size ) ;
+		block -> next		=  arena -> blocks ;
+		arena -> blocks		=  block ;
+		arena -> current	=  ( char * ) block + ARENA_ROUND ( sizeof ( eval_arena_block ) ) ;
+		arena -> end		=  ( char * ) block + block_size ;
+	    }
+
+	p			 =  arena -> current ;
+	arena -> current	+=  size ;
+	arena -> last		 =  p ;
+
+	return ( p ) ;
+    }
+
+
+static void *	eval_arena_realloc ( eval_arena *  arena, void *  p, size_t  old_size, size_t  new_size )
+   {
+	void *		q ;
+
+
+	if  ( p  !=  NULL  &&  p  ==  arena -> last  &&  ( size_t ) ( arena -> end - ( char * ) p )  >=  ARENA_ROUND ( new_size ) )
+	   {
+		arena -> current	=  ( char * ) p + ARENA_ROUND ( new_size ) ;
+		return ( p ) ;
+	    }
+
+	q	=  eval_arena_alloc ( arena, new_size ) ;
+
+	if  ( p  !=  NULL )
+		memcpy ( q, p, ( old_size  <  new_size ) ?  old_size : new_size ) ;
+
+	return ( q ) ;
+    }
+
+
+static char *	eval_arena_strdup ( eval_arena *  arena, const char *  s )
+   {
+	size_t		length	=  strlen ( s ) + 1 ;
+	char *		p	=  ( char * ) eval_arena_alloc ( arena, length ) ;
+
+
+	memcpy ( p, s, length ) ;
+
+	return ( p ) ;
+    }
+
+
+static void	eval_arena_release ( eval_arena *  arena )
+   {
+	eval_arena_block *	block	=  arena -> blocks,
+			 *	next ;
+
+
+	while  ( block  !=  NULL )
+	   {
+		next	=  block -> next ;
+		eval_free ( block ) ;
+		block	=  next ;
+	    }
+    }
+
+
+/*==============================================================================================================
+ *
+ *   	Stack functions.
+ *	Stacks are allocated from an arena, and are freed when the arena is released.
+ *
+ *==============================================================================================================*/	
+
+static void * 	eval_stack_alloc ( eval_arena *  arena, int  size, int  item_size )
+   {
+	int 			byte_count 		=  size * item_size ;
+	eval_stack * 		stack 			=  ( eval_stack * ) eval_arena_alloc ( arena, sizeof ( eval_stack ) ) ;   
+	   
+	
+	stack -> size	 	=  size ;
+	stack -> item_size 	=  item_size ;
+	stack -> last_item	=  -1 ;
+	stack -> arena		=  arena ;
+	stack -> data 		=  eval_arena_alloc ( arena, byte_count ) ;
+	   
+	return ( stack ) ;
+   }
+   
+   
+static void 	eval_stack_realloc ( eval_stack *  stack, int  new_size )
+   {
+	int	byte_count 	=  new_size * stack -> item_size ;
+	   
+	   
+	stack -> data 	=  ( eval_stack_entry * ) eval_arena_realloc ( stack -> arena, stack -> data, stack -> size * stack -> item_size, byte_count ) ;
+	stack -> size 	=  new_size ;
+    }
+    
+    
+static void  	eval_stack_push ( eval_stack *  stack, void *  item )
+   {
+	if  ( stack -> last_item + 1  >=  stack -> size )
+		eval_stack_realloc ( stack, stack -> size * 2 ) ;
+	
+	memcpy ( stack -> data + ( ++ stack -> last_item ), ( eval_stack_entry * ) item, sizeof ( eval_stack_entry ) ) ;
+    }
+   
+    
+static void * 	eval_stack_pop ( eval_stack *  stack )
+   {
+	if  ( stack -> last_item  <  0 )
+		return ( NULL ) ;
+	else
+		return ( stack -> data + ( stack -> last_item -- ) ) ;
+    }
+    
+    
+static int	eval_stack_is_empty ( eval_stack *  stack )
+   {
+	return ( stack -> last_item  <  0 ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_double_value -
+ *	Converts a string to a double.
+ *	At that point, no sign is present and we are sure that incorrect mixing between integer and double
+ *	syntax are absent ; for example, we will never see a string such as "0xFF.01E10".
+ *	Returns 1 if parsing is OK, 0 otherwise.
+ *
+ *==============================================================================================================*/	
+static int	eval_double_value ( char *  str, int  length, eval_double *  result )
+   {
+	char *		tail ;
+	eval_double	numeric_value ;
+
+
+	* result	=  0 ;
+
+# if	EVAL_DENY_EMPTY_STRINGS
+	if  ( ! * str )
+		return ( 0 ) ;
+# else
+	if  ( ! * str )
+	   {
+		* result	=  0 ;
+
+		return ( 1 ) ;
+	    }
+# endif
+
+	// Process integer values that have a base specifier or that start with zero ; as in eval_lex(), a number
+	// starting with zero is an octal one only if it does not contain a decimal point nor an exponent
+	if  ( ( * str  ==  '0'  &&  length  >  1  &&  strpbrk ( str, ".eE" )  ==  NULL )  ||
+	      ( * str  ==  '0'  &&  length  >  2  &&  strchr ( "bBoOdDxX", str [1] )  !=  NULL ) )
+	   {
+		char *		p		=  str + 1 ;
+		int		base		=  10 ;
+		double		value		=  0 ;
+		char		ch, ich ;
+
+
+		switch ( EVAL_TO_UPPER ( * p ) )
+		   {
+			case	'B'	:  base	 =   2 ; p ++ ; break ;
+			case	'O'	:  base	 =   8 ; p ++ ; break ;
+			case	'D'	:  base  =  10 ; p ++ ; break ;
+			case	'X'	:  base  =  16 ; p ++ ; break ;
+
+			default :
+				if  ( * p  >=  '0'  &&  * p  <=  '7' )
+					base	=  8 ;
+				else
+					return ( 0 ) ;
+		    }
+
+		while  ( * p ) 
+		   {
+			ich	=  EVAL_TO_UPPER ( * p ) ;
+			ch	=  ( ich  >=  'A' ) ?  ich - 'A' + 10 : ich - '0' ;
+
+			value   =  ( value * base ) + ch ;
+			p ++ ;
+		    }
+
+		* result	=  value ;
+
+		return ( 1 ) ;
+	    }
+
+	// Floating-point value - convert it
+	numeric_value	=  strtod ( str, & tail ) ;
+
+	// Fail if supplied input string does not completely match a float
+	if  ( tail  !=  str + length )
+		return ( 0 ) ;
+
+	// Match found : return the numeric result
+	* result	=  numeric_value ;
+
+	return ( 1 ) ;
+    }
+
+    
+/*==============================================================================================================
+ *
+ *  eval_lex -
+ *	Parses the supplied input string to retrieve the next token.
+ *	Characters are classified using the tables built by eval_initialize_lexer(), so that recognizing a 
+ *	token never depends on the number of operators nor on the current locale.
+ *
+ *==============================================================================================================*/	
+static int eval_lex ( char *  str, char **  startp, char **  endp, void **  op, int *  line, int *  character, int *  register_id )
+   {
+	int 		token 		=  TOKEN_EOF ;
+	   
+	   
+	str	=  eval_skip_spaces ( str, line, character ) ;
+	
+	if  ( ! * str )
+		return ( token ) ;
+	
+	// *startp will point to the start of the token (and end,... guess what ?)
+	* startp 	=  str ;
+	
+	// If an operator has been found, *op will point to the operator description structure
+	* op 		=  NULL ;
+			
+	// Name found (maybe a function name)
+	if  ( EVAL_CHARACTER_CLASS ( * str )  &  CHAR_NAME_START )
+	   {
+		while  ( EVAL_CHARACTER_CLASS ( * str )  &  CHAR_NAME )
+			str ++ ;
+		
+		token 		=  TOKEN_NAME ;
+	    }
+	// Number, either an integer with an optional base or a float
+	// At that point we don't try to convert anything, just verify that the number is correct
+	else if  ( EVAL_CHARACTER_CLASS ( * str )  &  CHAR_DIGIT )
+	   {
+		int 	found_base 	=  0,
+			found_dot 	=  0,
+			found_exp	=  0 ;
+		int 	base 		=  10 ;   
+		char 	ch, ich ;
+		
+
+		if  ( * str  ==  '0'  &&  ( EVAL_CHARACTER_CLASS ( str [1] )  &  CHAR_XDIGIT ) )
+		   {
+			char * 	p 	=  str + 1 ;
+			int  	found 	=  0 ;
+
+			// If we find a number starting with zero, then this may be an integer represented in 
+			// octal, unless we find something specific to a float (a decimal point or the exponentiation
+			// character, E). Only the characters of the number are examined
+			while  ( EVAL_CHARACTER_CLASS ( * p )  &  CHAR_NUMBER )
+			   {
+				switch ( * p ) 
+				   {
+					case 	'.' :
+					case 	'E' : 
+					case 	'e' :
+						found 	=  1 ;
+						break ;
+				    }
+				    
+				if  ( found )
+					break ;
+				
+				p ++ ;
+			    }
+			
+			if  ( ! found )
+			   {
+				base 	=  8 ;
+				   
+				str ++ ;
+			    }
+		    }
+		   
+		// Loop through input number
+		token 	=  TOKEN_NUMBER ;
+
+		while  ( * str )
+		   {
+			ch 	=  EVAL_TO_UPPER ( * str ) ;
+
+			// Once a base has been specified, only digits can follow ; note that 'B', 'D' and 'E' are
+			// hexadecimal digits
+			if  ( found_base )
+			   {
+				if  ( ! ( EVAL_CHARACTER_CLASS ( ch )  &  CHAR_XDIGIT ) )
+					goto  NumberEnd ;
+
+				ich 	=  ( ch  >=  'A' ) ?  ( ch - 'A' + 10 ) : ch - '0' ;
+
+				if  ( ich  >=  base )
+				   {
+					token 	=  TOKEN_ERROR ;
+					goto  NumberEnd ;
+				    }
+
+				str ++ ;
+				continue ;
+			    }
+			   
+			switch  ( ch )
+			   {
+				// Base specifier
+				case 	'X' :		// Hex
+				case	'B' :		// Binary
+				case	'D' :		// Decimal
+				case	'O' :		// Octal
+					if  ( found_dot  ||  found_exp  ||  found_base )
+					   {
+						token 	=  TOKEN_ERROR ;
+						goto  NumberEnd ;
+					    }
+		
+					switch ( ch )
+					   {
+						case	'X'	:  base		=  16 ; break ;
+						case	'D'	:  base		=  10 ; break;
+						case	'O'	:  base		=   8 ; break ;
+						case	'B'	:  base		=   2 ; break ;
+					    }
+					
+					found_base 	=  1 ;
+					break ;
+					    
+				// Decimal point
+				case 	'.' :
+					if  ( found_dot  ||  found_exp  ||  found_base )
+					   {
+						token 	=  TOKEN_ERROR ;
+						goto  NumberEnd ;
+					    }
+		
+					found_dot 	=  1 ;
+					break ;
+					    
+				// Exponentiation character ; hexadecimal digits have been processed above
+				case 	'E' :
+					if  ( found_exp )
+					   {
+						token 	=  TOKEN_ERROR ;
+						goto  NumberEnd ;
+					    }
+		
+					found_exp 	=  1 ;
+					ch 		=  * ( str + 1 ) ;
+					    
+					if  ( ch  ==  '+'  ||  ch  ==  '-' )
+						str ++ ;
+					
+					break ;
+					    
+				// Other character : our token fetching task is complete
+				default :
+					if  ( ( ch  >=  '0'  &&  ch  <= '9' )  ||  ( ch  >=  'A'  &&  ch  <=  'F' ) )
+					   {
+						ich 	=  ( ch  >=  'A' ) ?  ( ch - 'A' + 10 ) : ch - '0' ;
+
+						if  ( ich  >=  base )
+						   {
+							token 	=  TOKEN_ERROR ;
+							goto  NumberEnd ;
+						    }
+					    }
+					else
+						goto NumberEnd ;
+			    }			
+			    
+			str ++ ;
+		    }
+		    
+NumberEnd : ;
+
+	    }
+	// Left parenthesis
+	else if  ( * str  ==  '(' )
+	   {
+		token	=  TOKEN_LEFT_PARENT ;
+		str ++ ;
+	    }
+	// Right parenthesis 
+	else if  ( * str  ==  ')' )
+	   {
+		token	=  TOKEN_RIGHT_PARENT ;
+		str ++ ;
+	    }
+	// $name notation : variable name whose value must be supplied by the caller
+	else if  ( * str  ==  '$' )
+	   {
+		// Check that some characters remain after the "$" sign
+		if  ( * ( str + 1 ) )
+		   {
+			str ++ ;
+			* startp	=  str ;
+
+			// A variable name must start with a letter or an underline
+			if  ( EVAL_CHARACTER_CLASS ( * str )  &  CHAR_NAME_START )
+			   {
+				while  ( EVAL_CHARACTER_CLASS ( * str )  &  CHAR_NAME )
+					str ++ ;
+
+				token	=  TOKEN_VARIABLE ;
+			    }
+			// Otherwise this is an error
+			else
+				token	=  TOKEN_ERROR ;
+		    }
+		// End of string after the "$" sign
+		else
+			token	=  TOKEN_ERROR ;
+	    }
+	// #x! or #x? notation : save to/restore from register
+	else if  ( * str  ==  '#' )
+	   {
+		int	found_digits	=  0 ;
+
+		* register_id	=  0 ;
+		str ++ ;
+
+		str	=  eval_skip_spaces ( str, line, character ) ;
+
+		while  ( EVAL_CHARACTER_CLASS ( * str )  &  CHAR_DIGIT )
+		   {
+			* register_id	=  ( * register_id * 10 ) + ( * str - '0' ) ;
+			found_digits	=  1 ;
+			str ++ ;
+		    }
+
+		str	=  eval_skip_spaces ( str, line, character ) ;
+
+		if  ( ! found_digits )
+			* register_id	=  -1 ;
+
+		if  ( * str  ==  '!' )
+		   {
+			token			=  TOKEN_REGISTER_SAVE ;
+			* ( int ** ) op		=  register_id ;
+			str ++ ;
+		    }
+		else if  ( * str  ==  '?' )
+		   {
+			token			=  TOKEN_REGISTER_RECALL ;
+			* ( int ** ) op		=  register_id ;
+			str ++ ;
+		    }
+		else
+			token			=  TOKEN_ERROR ;
+	    }
+	// Function argument separator (comma)
+	else if  ( * str  ==  ',' )
+	   {
+		token	=  TOKEN_COMMA ;
+		str ++ ;
+	    }
+	// Other input : may be an operator ; two-character operators take precedence over one-character ones
+	else if  ( * str ) 
+	   {
+		operator_token *	found 	=  eval_double_operators [ ( unsigned char ) * str ] ;
+		   
+		if  ( found  ==  NULL  ||  str [1]  !=  found -> token [1] )
+			found	=  eval_single_operators [ ( unsigned char ) * str ] ;
+		    
+		if  ( found  !=  NULL )
+		   {
+			token 				 =  TOKEN_OPERATOR ;
+			* ( ( operator_token ** ) op )	 =  found ;
+			str 				+=  found -> length ;
+		    }
+		else
+			token 	=  TOKEN_ERROR ;
+	    }
+	
+	// Set the end pointer to the character after the token found
+	* endp 		 =  str ;
+	* character	+=  str - * startp - 1 ;
+
+	// All done, return
+	return ( token ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  Scalar computation engine.
+ *	evalcompute.h is instantiated once for the double type, and once for the long double type when it is
+ *	the type of eval_double ; eval_apply_operator() designates the eval_double instance.
+ *	Bytecode is dispatched using computed gotos when the compiler supports them, unless the
+ *	EVAL_NO_COMPUTED_GOTO macro is defined.
+ *
+ *==============================================================================================================*/	
+# if	defined ( __GNUC__ )  &&  ! defined ( EVAL_NO_COMPUTED_GOTO )
+#	define	EVAL_COMPUTED_GOTO		1
+# else
+#	define	EVAL_COMPUTED_GOTO		0
+# endif
+
+# if	EVAL_LONG_DOUBLE
+#	define	EVAL_VALUE			long double
+#	define	EVAL_TEMPLATE(name)		name##_ldouble
+#	define	EVAL_NUMERIC_VALUE(ip)		( ip -> value. number )
+#	include	"evalcompute.h"
+
+#	define	eval_apply_operator		eval_apply_operator_ldouble
+# else
+#	define	eval_apply_operator		eval_apply_operator_double
+# endif
+
+# define	EVAL_VALUE			double
+# define	EVAL_TEMPLATE(name)		name##_double
+# define	EVAL_NUMERIC_VALUE(ip)		( ip -> fast_value )
+# include	"evalcompute.h"
+
+
+/*==============================================================================================================
+ *
+ *  Native code generation.
+ *
+ *==============================================================================================================*/	
+# include	"evaljit.h"
+
+
+/*==============================================================================================================
+ *
+ *  eval_compute_scratch_size -
+ *	Returns the size of the scratch memory needed by eval_compute() to run the specified program.
+ *
+ *==============================================================================================================*/	
+static size_t	eval_compute_scratch_size ( const evaluator_program *  program )
+   {
+# if	EVAL_LONG_DOUBLE
+	if  ( ! ( program -> flags & EVAL_COMPILE_DOUBLE ) )
+		return ( eval_compute_scratch_size_ldouble ( program ) ) ;
+# endif
+
+	return ( eval_compute_scratch_size_double ( program ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_compute -
+ *	Computes a program using the value type selected when it was compiled, or runs its native code if
+ *	there is one. Native code can only be used when variable values are supplied in an array.
+ *	scratch is either NULL or points to eval_compute_scratch_size() bytes of memory that are used for the
+ *	value stack instead of allocating it.
+ *
+ *==============================================================================================================*/	
+static int	eval_compute ( const evaluator_program *  program, eval_double *  output, const eval_double *  variables, eval_callback  callback,
+			       void *  scratch )
+   {
+	int		status ;
+	EVAL_STATS_DECLARE ( start )
+
+
+	EVAL_STATS_START ( start ) ;
+
+# if	EVAL_JIT
+	if  ( program -> jit_code  !=  NULL  &&  ( variables  !=  NULL  ||  ! program -> variable_count ) )
+		status	=  eval_jit_run ( program, output, variables ) ;
+	else
+# endif
+# if	EVAL_LONG_DOUBLE
+	if  ( ! ( program -> flags & EVAL_COMPILE_DOUBLE ) )
+		status	=  eval_compute_ldouble ( program, output, variables, callback, scratch ) ;
+	else
+# endif
+		status	=  eval_compute_double ( program, output, variables, callback, scratch ) ;
+
+	EVAL_STATS_STOP ( EVAL_PHASE_COMPUTE, start, 1 ) ;
+
+	return ( status ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_variable_slot -
+ *	Returns the slot assigned to the specified variable name, allocating a new one if the variable has not
+ *	yet been referenced in the program being parsed.
+ *
+ *==============================================================================================================*/	
+static int	eval_variable_slot ( evaluator_program *  program, char *  name )
+   {
+	int		i ;
+
+
+	for  ( i = 0 ; i  <  program -> variable_count ; i ++ )
+	   {
+		if  ( ! strcmp ( program -> variables [i], name ) )
+			return ( i ) ;
+	    }
+
+	if  ( program -> variable_count  >=  program -> variable_max )
+	   {
+		int	old_max	=  program -> variable_max ;
+
+		program -> variable_max		=  NEXT_INCREMENT ( program -> variable_count + 1, VARIABLE_INCREMENT ) ;
+		program -> variables		=  ( char ** ) eval_arena_realloc ( & program -> arena, program -> variables, 
+										old_max * sizeof ( char * ), 
+										program -> variable_max * sizeof ( char * ) ) ;
+	    }
+
+	program -> variables [ program -> variable_count ]	=  eval_arena_strdup ( & program -> arena, name ) ;
+
+	return ( program -> variable_count ++ ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_parse_constant -
+ *	Pushes the value of the specified constant onto the output stack. Constants are resolved once, when the
+ *	expression is parsed.
+ *
+ *==============================================================================================================*/	
+static int  eval_parse_constant ( eval_stack *  output_stack, char *  name, int  line, int  character )
+   {
+	evaluator_constant_definition *		def ;
+	eval_stack_entry 			stack_entry ;
+
+
+	def	=  ( evaluator_constant_definition * ) eval_find_primitive ( & eval_constant_definitions, name ) ;
+
+	if  ( def  ==  NULL )
+	   {
+		eval_error ( E_EVAL_UNDEFINED_CONSTANT, line, character, "Undefined constant '%s'", name ) ;
+		return ( 0 ) ;
+	    }
+
+	stack_entry. type			=  STACK_ENTRY_NUMERIC ;
+	stack_entry. value. double_value	=  def -> value ;
+	eval_stack_push ( output_stack, & stack_entry ) ;
+
+	return ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_parse -
+ *	Grammatical analyzer for expressions.
+ *
+ *==============================================================================================================*/	
+# define	DEFAULT_TOKEN_BUFFER_SIZE	64
+
+static int  eval_parse ( const char *		str, 
+			 evaluator_program *	program, 
+			 eval_stack *		operator_stack, 
+			 eval_arena *		scratch,
+			 int			allow_variables ) 
+   { 
+	eval_stack *		output_stack		=  program -> stack ;
+	char * 			startp			=  0,			// Start and end of next token in the input string
+	     *			endp			=  0 ;
+	void *			param			=  0 ;			// Data returned by the eval_lex() function
+	int			register_index		=  0 ;			// Register number returned by eval_lex() for #x! and #x? tokens
+	operator_token *	op ;						// Operator token (may be returned by eval_lex)
+	int 			token ;						// Token value
+	int 			last_token 		=  TOKEN_EOF ;		// Last seen token value
+	int 			status 			=  1 ;			// Return value (0 = bad...)
+	eval_stack_entry 	stack_entry ;					// Entry to be added onto the stack
+	char *			current_token		=  ( char * ) eval_arena_alloc ( scratch, DEFAULT_TOKEN_BUFFER_SIZE ) ;
+	int			current_token_length	=  0,			// A copy of the current token in the input string, its length and max length seen so far
+				max_token_length	=  DEFAULT_TOKEN_BUFFER_SIZE ;
+	int			character		=  0,			// Current character and line position
+				line			=  1 ;
+	int			inert_token ;					// Set to 1 when "inert" constructs, such as #! have been found
+										// In this case, the last_token variable will keep its original value
+	eval_stack_entry *	se ;
+	int			parentheses_nesting	[ MAX_NESTED_FUNCTION_CALLS ] ;
+	int			function_args		[ MAX_NESTED_FUNCTION_CALLS ] ;
+	evaluator_function_definition *
+				function_defs		[ MAX_NESTED_FUNCTION_CALLS ] ;
+	int			nesting_level		=  0 ;
+	char *			name_token		=  ( char * ) eval_arena_alloc ( scratch, DEFAULT_TOKEN_BUFFER_SIZE ) ;
+	int			max_name_length		=  DEFAULT_TOKEN_BUFFER_SIZE ;
+	int			name_line		=  0,			// Position of the last name seen
+				name_character		=  0 ;
+	int			pending_name		=  0 ;			// Set to 1 when a name has been seen but not yet resolved
+	EVAL_STATS_DECLARE ( lex_start )
+
+
+	parentheses_nesting [0]		=  0 ;
+
+	// Retrieve tokens one by one from the input string
+	while  ( * str )
+	   {
+		EVAL_STATS_START ( lex_start ) ;
+		token 			=  eval_lex ( ( char * ) str, & startp, & endp, & param, & line, & character, & register_index ) ;
+		EVAL_STATS_STOP ( EVAL_PHASE_LEX, lex_start, 1 ) ;
+		inert_token		=  0 ;
+
+		// Always hold the current token in a nul-terminated string
+		// The main purpose is to use it easily for error messages
+		current_token_length	=  endp - startp ;
+
+		if  ( current_token_length + 1  >=  max_token_length ) 
+		   {
+			while  ( current_token_length + 1  >=  max_token_length )
+				max_token_length	*=  2 ;
+
+			current_token		 =  ( char * ) eval_arena_alloc ( scratch, max_token_length ) ;
+		    }
+
+		strncpy ( current_token, startp, current_token_length ) ;
+		current_token [ current_token_length ]	=  '\0' ;
+
+		// A name is a function name if it is followed by an opening parenthesis, and a constant name otherwise ;
+		// constants are replaced with their value as soon as we know that they are not a function call
+		if  ( pending_name  &&  token  !=  TOKEN_LEFT_PARENT  &&  token  !=  TOKEN_ERROR )
+		   {
+			pending_name	=  0 ;
+
+			if  ( ! eval_parse_constant ( output_stack, name_token, name_line, name_character ) )
+			   {
+				status	=  0 ;
+				goto  ParseEnd ;
+			    }
+		    }
+
+		// Process current token
+		switch ( token )
+		   {
+			// End of string : stop parsing
+			case 	TOKEN_EOF :
+				goto ParseEnd ;
+			
+			// Unexpected character found
+			case 	TOKEN_ERROR :
+				eval_error ( E_EVAL_UNEXPECTED_CHARACTER, line, character, "Unexpected character '%c'", * endp ) ;
+				status 	=  0 ;
+				goto ParseEnd ;
+			
+			// Number found 
+			case 	TOKEN_NUMBER :
+			   {
+				eval_double		numeric_value ;
+				int 			converted ;
+				
+
+				// A number can occur only :
+				// - At the start of an expression
+				// - After an operator
+				// - In a function call, after an opening parenthesis or a comma
+				if  ( ! ( last_token & ( TOKEN_EOF | TOKEN_OPERATOR | TOKEN_COMMA | TOKEN_LEFT_PARENT ) ) )
+				   {
+					eval_error ( E_EVAL_UNEXPECTED_NUMBER, line, character, "Unexpected number '%s'", current_token ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+
+				// Convert current token to a double value
+				converted	=  eval_double_value ( current_token, current_token_length, & numeric_value ) ;
+
+				// Conversion successful
+				if  ( converted )
+				   {
+					stack_entry. type 			=  STACK_ENTRY_NUMERIC ;
+					stack_entry. value. double_value 	=  numeric_value ;
+					   
+					eval_stack_push ( output_stack, & stack_entry ) ;
+				    }
+				// Some extraneous characters did not get interpreted correctly...
+				else
+				   {
+					eval_error ( E_EVAL_INVALID_NUMBER, line, character, "Invalid numeric value '%s'", current_token ) ;
+					status 	=  0 ;
+					   
+					goto  ParseEnd ;
+				    }
+				
+				break ;
+			    }
+			    
+			// Operators
+			case  	TOKEN_OPERATOR :
+				op			=  ( operator_token * ) param ;
+				stack_entry. type 	=  STACK_ENTRY_OPERATOR ;
+
+				// A plus/minus sign is considered as unary if it follows one of the following construct :
+				// - The start of the string
+				// - An operator (eg : 2+-3)
+				// - An opening parenthesis (eg: func(-3))
+				// - An argument separator (eg: func(1,-3))
+				// The unary plus is silently ignored, since it does not affect its right-part value
+				if  ( last_token  &  ( TOKEN_OPERATOR | TOKEN_EOF | TOKEN_LEFT_PARENT | TOKEN_COMMA ) )
+				   {
+					if  ( op -> type  ==  OP_PLUS )
+						break ;
+					else if  ( op -> type  ==  OP_MINUS )
+						op	=  & unary_minus ;
+					else if  ( ! op -> unary )
+					   {
+						eval_error ( E_EVAL_UNEXPECTED_OPERATOR, line, character, "Unexpected operator '%s'", current_token ) ;
+						status	=  0 ;
+
+						goto  ParseEnd ;
+					    }
+				    }  
+				// Otherwise, operators can only follow :
+				// - A number
+				// - A constant name 
+				// - A closing parenthesis
+				else if  ( ! ( last_token & ( TOKEN_NUMBER | TOKEN_NAME | TOKEN_VARIABLE | TOKEN_REGISTER_RECALL | TOKEN_RIGHT_PARENT ) ) )
+				   {
+					eval_error ( E_EVAL_UNEXPECTED_OPERATOR, line, character, "Unexpected operator '%s'", current_token ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+				// Consider unary left-associative operators as inert : since they apply to their left operand (a number, a constant or a right parent)
+				// they are pushed immediately onto the output stack
+				else if  ( op -> unary  &&  op -> associativity  ==  ASSOC_LEFT )
+				   {
+					stack_entry. value. operator_value	=  op ;
+					eval_stack_push ( output_stack, & stack_entry ) ;
+					inert_token	=  1 ;
+
+					break ;
+				    }
+
+				/***
+					We have found operator op1. While there is an operator op2 in the operator stack, and either :
+					- op1 is left-associative and its precedence is less than or equal to op2 precedence, OR
+					- op1 is right-associative and its precedence is greater than op2 precedence
+					then we will pop op2 off the operator stack onto the output queue
+				 ***/
+				while  ( ! eval_stack_is_empty ( operator_stack ) )
+				   {
+					operator_token *	previous_op ;
+
+					// A pending function call acts as a left parenthesis
+					if  ( operator_stack -> data [ operator_stack -> last_item ]. type  ==  STACK_ENTRY_FUNCTION_CALL )
+						break ;
+
+					previous_op	=  operator_stack -> data [ operator_stack -> last_item ]. value. operator_value ;
+
+					if  ( ( ( op -> associativity  ==  ASSOC_LEFT   &&  op -> precedence  <=  previous_op -> precedence )   ||
+					        ( op -> associativity  ==  ASSOC_RIGHT  &&  op -> precedence  >   previous_op -> precedence ) )	&&
+					      previous_op -> type  !=  OP_LEFT_PARENT )
+					   {
+						eval_stack_pop ( operator_stack ) ;
+						stack_entry. value. operator_value	=  previous_op ;
+						eval_stack_push ( output_stack, & stack_entry ) ;
+					    }
+					else 
+						break ;
+				    }
+
+				// Now that precedence rules have been applied, we can push op1 to the operator stack 
+				stack_entry. value. operator_value	=  op ;
+				eval_stack_push ( operator_stack, & stack_entry ) ;
+
+				break ;
+
+			// Left parenthesis : consider it as a non-associative operator with the highest precedence or to a function call
+			case	TOKEN_LEFT_PARENT :
+				// Last token was a name, so this is a function call 
+				// We consider function calls with n arguments as n-ary operators ; thus , f(1,2,3,4) will give on the stack :
+				// - STACK_ENTRY_NUMBER (1)
+				// - STACK_ENTRY_NUMBER (2)
+				// - STACK_ENTRY_NUMBER (3)
+				// - STACK_ENTRY_NUMBER (4)
+				// - STACK_ENTRY_FUNCTION_CALL, argc = 4
+				// The function is looked up here, so that evaluation never has to search for it
+				if  ( pending_name ) 
+				   {
+					evaluator_function_definition *		def ;
+
+					pending_name	=  0 ;
+
+					if  ( nesting_level + 1  >=  MAX_NESTED_FUNCTION_CALLS )
+					   {
+						eval_error ( E_EVAL_TOO_MANY_NESTED_CALLS, line, character, "Too many nested function calls" ) ;
+						status	=  0 ;
+
+						goto  ParseEnd ;
+					    }
+
+					def	=  ( evaluator_function_definition * ) eval_find_primitive ( & eval_function_definitions, name_token ) ;
+
+					if  ( def  ==  NULL )
+					   {
+						eval_error ( E_EVAL_UNDEFINED_FUNCTION, name_line, name_character, "Undefined function '%s'", name_token ) ;
+						status	=  0 ;
+
+						goto  ParseEnd ;
+					    }
+
+					stack_entry. type				=  STACK_ENTRY_FUNCTION_CALL ;
+					stack_entry. value. function_value. func	=  def -> func ;
+					stack_entry. value. function_value. argc	=  0 ;
+					stack_entry. value. function_value. flags	=  def -> flags ;
+					stack_entry. value. function_value. cost	=  def -> cost ;
+					stack_entry. value. function_value. vfunc	=  def -> vfunc ;
+					eval_stack_push ( operator_stack, & stack_entry ) ;
+
+					parentheses_nesting [ ++ nesting_level ]	=  1 ;
+					function_args [ nesting_level ]			=  0 ;
+					function_defs [ nesting_level ]			=  def ;
+				    }
+				// Otherwise, this is simply for expression grouping
+				else if  ( last_token  &  ( TOKEN_EOF | TOKEN_LEFT_PARENT | TOKEN_OPERATOR | TOKEN_COMMA ) )
+				   {
+					stack_entry. type			=  STACK_ENTRY_OPERATOR ;
+					stack_entry. value. operator_value	=  & left_parenthesis ;
+					eval_stack_push ( operator_stack, & stack_entry ) ;
+
+					parentheses_nesting [ nesting_level ] ++ ;
+				    }
+				else
+				   {
+					eval_error ( E_EVAL_UNEXPECTED_TOKEN, line, character, "Unexpected opening parenthesis" ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+
+				break ;
+
+			/***
+				Right parenthesis :
+				- Until the token at the top of the stack is a left parenthesis, pop operators off the stack onto the output queue.
+				- Pop the left parenthesis from the stack, but not onto the output queue.
+				- If the token at the top of the stack is a function token, pop it onto the output queue.
+				- If the stack runs out without finding a left parenthesis, then there are mismatched parentheses.
+			 ***/
+			case	TOKEN_RIGHT_PARENT :
+			   {
+				int		found_left	=  0 ;
+
+				// Closing parenthesis ends an expression grouping, not a function call
+				if  ( ( last_token  &  ( TOKEN_NUMBER | TOKEN_RIGHT_PARENT | TOKEN_NAME | TOKEN_VARIABLE | TOKEN_REGISTER_RECALL | TOKEN_LEFT_PARENT ) ) )
+				   {
+					// Push all operators until an opening parenthesis has been found
+					while  ( ! eval_stack_is_empty ( operator_stack ) )
+					   {
+						eval_stack_entry *	se		=  ( eval_stack_entry * ) eval_stack_pop ( operator_stack ) ;
+						operator_token *	previous_op	=  se -> value. operator_value ;
+
+						if  ( se -> type  ==  STACK_ENTRY_FUNCTION_CALL )
+						   {
+							evaluator_function_definition *		def	=  function_defs [ nesting_level ] ;
+
+							// Count the last argument, unless the argument list was empty ; parentheses used for grouping
+							// within the argument list must not be counted
+							if  ( ! ( last_token  &  TOKEN_LEFT_PARENT ) )
+								function_args [ nesting_level ] ++ ;
+
+							// Since the function is known, its argument count can be checked once and for all
+							if  ( function_args [ nesting_level ]  <  def -> min_args  ||  function_args [ nesting_level ]  >  def -> max_args )
+							   {
+								eval_error ( E_EVAL_BAD_ARGUMENT_COUNT, line, character, "Bad number of arguments (%d) for function %s() ;"
+										" authorized range is %d..%d",
+										function_args [ nesting_level ], def -> name, def -> min_args, def -> max_args ) ;
+								status	=  0 ;
+
+								goto  ParseEnd ;
+							    }
+
+							se -> value. function_value. argc	=  function_args [ nesting_level ] ;
+							eval_stack_push ( output_stack, se ) ;
+							found_left	=  1 ;
+							break ;
+						    }
+						else if  ( previous_op -> type  ==  OP_LEFT_PARENT )
+						   {
+							found_left	=  1 ;
+							break ;
+						    }
+						else
+						   {
+							eval_stack_push ( output_stack, se ) ;
+						    }
+					    }
+				    }
+
+				// A nested level greater than zero means that we are in a nested function call ; 
+				// When the parentheses nesting within this call reaches 1, then this means that the 
+				// closing parenthesis we just encountered is finishing the call
+				if  ( ! ( last_token & TOKEN_COMMA )  &&  nesting_level > 0  &&  parentheses_nesting [ nesting_level ]  ==  1 )
+					found_left				=  1 ;
+
+				// Opening parenthesis not found
+				if  ( ! found_left ) 
+				   {
+					eval_error ( E_EVAL_UNEXPECTED_RIGHT_PARENT, line, character, "Unexpected closing parenthesis" ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+
+				parentheses_nesting [ nesting_level ] -- ;
+
+				if  ( ! parentheses_nesting [ nesting_level ] )
+				   {
+					if  ( nesting_level  >  0 )
+						nesting_level -- ;
+				    }
+
+				break ;
+			    }
+
+			// Name : either a constant or a function
+			case	TOKEN_NAME :
+				if  ( ! ( last_token & ( TOKEN_EOF | TOKEN_OPERATOR | TOKEN_COMMA | TOKEN_LEFT_PARENT ) ) )
+				   {
+					eval_error ( E_EVAL_UNEXPECTED_NAME, line, character, "Unexpected name '%s'", current_token ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+
+				// Whether this is a constant or a function call will be known when the next token is seen
+				if  ( current_token_length + 1  >=  max_name_length )
+				   {
+					max_name_length		=  max_token_length ;
+					name_token		=  ( char * ) eval_arena_alloc ( scratch, max_name_length ) ;
+				    }
+
+				strcpy ( name_token, current_token ) ;
+				name_line	=  line ;
+				name_character	=  character ;
+				pending_name	=  1 ;
+				break ;
+
+			// Variable name
+			case	TOKEN_VARIABLE :
+				if  ( ! allow_variables )
+				   {
+					eval_error ( E_EVAL_VARIABLES_NOT_ALLOWED, line, character, 
+						"Variable references are not allowed when you use the evaluate() function.\n" 
+						"Use the evaluate_ex() function instead (referenced variable : %s)",
+						current_token ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+				else if  ( ! ( last_token & ( TOKEN_EOF | TOKEN_OPERATOR | TOKEN_COMMA | TOKEN_LEFT_PARENT ) ) )
+				   {
+					eval_error ( E_EVAL_UNEXPECTED_VARIABLE, line, character, "Unexpected variable reference '%s'", current_token ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+
+				stack_entry. type				=  STACK_ENTRY_VARIABLE ;
+				stack_entry. value. variable_value. slot	=  eval_variable_slot ( program, current_token ) ;
+				stack_entry. value. variable_value. name	=  program -> variables [ stack_entry. value. variable_value. slot ] ;
+				eval_stack_push ( output_stack, & stack_entry ) ;
+
+				break ;
+
+			// Save to register
+			case	TOKEN_REGISTER_SAVE :
+			   {
+				int		register_id		=  * ( int * ) param ;
+
+
+				if  ( register_id  >=  MAX_REGISTERS )
+				   {
+					eval_error ( E_EVAL_INVALID_REGISTER_INDEX, line, character, "Invalid register index %d (range is 0..%d)",
+							register_id, MAX_REGISTERS - 1 ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+
+				stack_entry. type			=  STACK_ENTRY_REGISTER_SAVE ;
+				stack_entry. value. register_value	=  register_id ;
+				eval_stack_push ( output_stack, & stack_entry ) ;
+
+				// This token is inert and won't be remembered during the parsing
+				inert_token	=  1 ;
+				break ;
+			    }
+
+			// Recall register value
+			case	TOKEN_REGISTER_RECALL :
+			   {
+				int		register_id		=  * ( int * ) param ;
+
+
+				if  ( ! ( last_token & ( TOKEN_EOF | TOKEN_OPERATOR | TOKEN_COMMA | TOKEN_LEFT_PARENT ) ) )
+				   {
+					eval_error ( E_EVAL_UNEXPECTED_TOKEN, line, character, "Unexpected register '%s' value recall", current_token ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+
+				if  ( register_id  >=  MAX_REGISTERS )
+				   {
+					eval_error ( E_EVAL_INVALID_REGISTER_INDEX, line, character, "Invalid register index %d (allowed range is 0..%d)",
+							register_id, MAX_REGISTERS - 1 ) ;
+					status	=  0 ;
+
+					goto  ParseEnd ;
+				    }
+
+				stack_entry. type			=  STACK_ENTRY_REGISTER_RECALL ;
+				stack_entry. value. register_value	=  register_id ;
+				eval_stack_push ( output_stack, & stack_entry ) ;
+				break ;
+			    }
+
+			// Function argument separator (comma)
+			case	TOKEN_COMMA :
+				if  ( last_token  &  ( TOKEN_NUMBER | TOKEN_NAME | TOKEN_VARIABLE | TOKEN_REGISTER_RECALL | TOKEN_RIGHT_PARENT ) )
+				   {
+					int		found_parent	=  0 ;
+
+					function_args [ nesting_level ] ++ ;
+
+					// Pop every operator off the operator stack and push it onto the output stack until a function call or a
+					// left parenthesis has been found. A call like : f ( 1, 2+3, 4 ) will finally look on the stack as :
+					//	1 2 3 + 4 f 
+					// Once all the operations will be applied, the stack will look like :
+					//	1 5 4 f
+					// And since "f" is a 3-ary operator (because "f" was called with three arguments), the resulting stack will be :
+					//	x
+					// where "x" is the result of f(1, 5, 4)
+					while  ( ! eval_stack_is_empty ( operator_stack ) )
+					   {
+						eval_stack_entry *	se		=  ( eval_stack_entry * ) eval_stack_pop ( operator_stack ) ;
+
+						// A function call is a stop condition for this loop, but we need to push it onto the output stack
+						if  ( se -> type  ==  STACK_ENTRY_FUNCTION_CALL )
+						   {
+							eval_stack_push ( operator_stack, se ) ;
+							found_parent	=  1 ;
+							break ;
+						    }
+						// Left parenthesis is also a stop condition, but we do not push it onto the output stack
+						else if  ( se -> value. operator_value -> type  ==  OP_LEFT_PARENT ) 
+						   {
+							found_parent	=  1 ;
+							break ;
+						    }
+						// Other operators : push the onto the output stack
+						else
+							eval_stack_push ( output_stack, se ) ;
+					    }
+
+					// Neither left parenthesis nor function call found on the operator stack
+					if  ( ! found_parent )
+					   {
+						eval_error ( E_EVAL_UNEXPECTED_ARG_SEPARATOR, line, character, "Unexpected argument delimiter ',' found" ) ;
+						status	=  0 ;
+
+						goto  ParseEnd ;
+					    }
+				    }
+				else
+				   {
+					eval_error ( E_EVAL_UNEXPECTED_ARG_SEPARATOR, line, character, "Unexpected argument separator" ) ;
+					status	=  0 ;
+
+					goto ParseEnd ;
+				    }
+
+				break ;
+
+			// Unexpected token
+			default :
+				eval_error ( E_EVAL_UNEXPECTED_TOKEN, line, character, "Unexpected token #%d", token ) ;
+				status 	=  0 ;
+				goto  ParseEnd ;
+		    }
+		
+		// Update pointer to current character 
+		str 		=  endp ;
+
+		// Remember last token type seen so far ; this helps providing some kind of syntax checking 
+		// before computing the expression result
+		if  ( ! inert_token )
+			last_token 	=  token ;
+
+		character	+=  endp - startp ;
+	    }
+	    
+ParseEnd:
+	// A name ending the expression is a constant
+	if  ( status  &&  pending_name )
+		status	=  eval_parse_constant ( output_stack, name_token, name_line, name_character ) ;
+
+	// Possible error in expression
+	if  ( ! status )			// Some error occured
+		goto  ParseReturn ;
+	else if  ( nesting_level )
+	   {
+		eval_error ( E_EVAL_UNTERMINATED_FUNCTION_CALL, line, character, "Unterminated function call" ) ;
+		status	=  0 ;
+
+		goto	ParseReturn ;
+	    }
+	else if  ( parentheses_nesting [0] )	// Unbalanced parentheses
+	   {
+		eval_error ( E_EVAL_UNBALANCED_PARENTHESES, line, character, "Unbalanced parentheses" ) ;
+		status	=  0 ;
+
+		goto  ParseReturn ;
+	    }
+
+	// Pop all the remaining elements from the operator stack to the output stack
+	while  ( ( se = ( eval_stack_entry * ) eval_stack_pop ( operator_stack ) )  !=  NULL )
+		eval_stack_push ( output_stack, se ) ;
+
+# if	EVAL_DEBUG
+	//eval_dump_constants ( ) ;
+	//eval_dump_functions ( ) ;
+	eval_dump_stack ( output_stack, "output stack" ) ;
+# endif
+
+ParseReturn :
+	// All done, return
+	return ( status ) ;
+    }
+ 
+
+/*==============================================================================================================
+ *
+ *  eval_link -
+ *	Checks the output stack built by eval_parse() and computes the information needed by eval_compute() and 
+ *	eval_batch_compute() :
+ *	- Verifies that the value stack will always contain enough values to apply operators and function calls,
+ *	  and computes its maximum depth.
+ *	- Replaces register numbers with cell indexes. Since an output stack is always interpreted from its 
+ *	  first to its last entry, the register targeted by #! or #? constructs without a register number can be 
+ *	  determined here, as well as recalls of registers that will never be assigned a value. Each register used
+ *	  in the expression is given its own cell, numbered from zero.
+ *	- In expression sets, checks that each expression leaves a single value for its output entry. Registers
+ *	  are local to each expression : the same register number used by two expressions gets two cells.
+ *
+ *==============================================================================================================*/	
+static int	eval_link ( evaluator_program *  program )
+   {
+	eval_stack *		stack			=  program -> stack ;
+	eval_stack_entry *	se ;
+	int			register_cells	[ MAX_REGISTERS ] ;
+	int			last_register		=  -1 ;
+	int			depth			=  0 ;
+	int			i, j ;
+
+
+	for  ( i = 0 ; i  <  MAX_REGISTERS ; i ++ )
+		register_cells [i]	=  -1 ;
+
+	for  ( i = 0 ; i  <=  stack -> last_item ; i ++ )
+	   {
+		se	=  stack -> data + i ;
+
+		switch ( se -> type )
+		   {
+			case	STACK_ENTRY_NUMERIC :
+			case	STACK_ENTRY_VARIABLE :
+				depth ++ ;
+				break ;
+
+			case	STACK_ENTRY_OPERATOR :
+			   {
+				int	argc	=  ( se -> value. operator_value -> unary ) ?  1 : 2 ;
+
+				if  ( depth  <  argc )
+				   {
+					eval_error ( E_EVAL_STACK_EMPTY, -1, -1, "Stack does not contain enough elements to process the '%s' operator",
+							se -> value. operator_value -> token ) ;
+					return ( 0 ) ;
+				    }
+
+				depth	-=  argc - 1 ;
+				break ;
+			    }
+
+			case	STACK_ENTRY_FUNCTION_CALL :
+			   {
+				int	argc	=  se -> value. function_value. argc ;
+
+				if  ( depth  <  argc )
+				   {
+					eval_error ( E_EVAL_IMPLEMENTATION_ERROR, -1, -1, "Not enough parameters (%d) remain on stack for a call with %d arguments",
+							depth, argc ) ;
+					return ( 0 ) ;
+				    }
+
+				if  ( argc  >  program -> max_argc )
+					program -> max_argc	=  argc ;
+
+				depth	-=  argc - 1 ;
+				break ;
+			    }
+
+			case	STACK_ENTRY_REGISTER_SAVE :
+			   {
+				int	regnum		=  se -> value. register_value ;
+
+				if  ( regnum  <  0 )
+					regnum	=  ( last_register  <  0 ) ?  0 : last_register + 1 ;
+
+				if  ( regnum  >=  MAX_REGISTERS )
+				   {
+					eval_error ( E_EVAL_INVALID_REGISTER_INDEX, -1, -1, "Invalid register index %d (range is 0..%d)",
+							regnum, MAX_REGISTERS - 1 ) ;
+					return ( 0 ) ;
+				    }
+
+				if  ( ! depth )
+				   {
+					eval_error ( E_EVAL_STACK_EMPTY, -1, -1, "No value to save into register #%d", regnum ) ;
+					return ( 0 ) ;
+				    }
+
+				if  ( register_cells [ regnum ]  <  0 )
+					register_cells [ regnum ]	=  program -> cell_count ++ ;
+
+				se -> value. register_value	=  register_cells [ regnum ] ;
+				last_register			=  regnum ;
+				break ;
+			    }
+
+			case	STACK_ENTRY_REGISTER_RECALL :
+			   {
+				int	regnum		=  se -> value. register_value ;
+
+				if  ( regnum  <  0 )
+					regnum	=  last_register ;
+
+				if  ( regnum  <  0  ||  register_cells [ regnum ]  <  0 )
+				   {
+					eval_error ( E_EVAL_INVALID_REGISTER_INDEX, -1, -1,  "Register #%d has not been assigned any value", regnum ) ;
+					return ( 0 ) ;
+				    }
+
+				se -> value. register_value	=  register_cells [ regnum ] ;
+				depth ++ ;
+				break ;
+			    }
+
+			// End of an expression of a set : registers are local to each expression
+			case	STACK_ENTRY_OUTPUT :
+				if  ( depth  !=  1 )
+				   {
+					eval_error ( E_EVAL_IMPLEMENTATION_ERROR, -1, -1, "Expression #%d should leave exactly one value on the stack",
+							se -> value. output_value ) ;
+					return ( 0 ) ;
+				    }
+
+				for  ( j = 0 ; j  <  MAX_REGISTERS ; j ++ )
+					register_cells [j]	=  -1 ;
+
+				last_register	=  -1 ;
+				depth		=  0 ;
+				break ;
+
+			// Paranoia : Changes have been made to the supported token list, but not reflected here
+			default :
+				eval_error ( E_EVAL_UNDEFINED_TOKEN_TYPE, -1, -1, "Undefined token type '#%d'", se -> type ) ;
+				return ( 0 ) ;
+		    }
+
+		if  ( depth  >  program -> max_depth )
+			program -> max_depth	=  depth ;
+	    }
+
+	// More than one value on the stack : there must be a programmation error here...
+	if  ( depth  >  1 )
+	   {
+		eval_error ( E_EVAL_IMPLEMENTATION_ERROR, -1, -1, "Value stack should hold at most one value" ) ;
+		return ( 0 ) ;
+	    }
+
+	return ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  Function properties, given by the EVAL_FUNCTION_* flags of their definition.
+ *	EVAL_FUNCTION_IS_CONSTANT() is true when calls can be computed at compile time, ie when the function
+ *	is pure and does not depend on trigonometric units. EVAL_FUNCTION_IS_STABLE() is true when identical
+ *	calls give the same result during a run, so that they can be computed only once. Functions defined
+ *	without flags are assumed to be thread-safe, as they were before flags existed ; so are stable
+ *	functions, which have no side effects.
+ *	EVAL_FUNCTION_COST() gives the cost of a call, functions without a cost hint costing 
+ *	EVAL_DEFAULT_FUNCTION_COST.
+ *
+ *==============================================================================================================*/	
+# define	EVAL_DEFAULT_FUNCTION_COST		16
+
+# define	EVAL_FUNCTION_IS_CONSTANT(flags)	\
+		( ( ( flags )  &  ( EVAL_FUNCTION_PURE | EVAL_FUNCTION_VOLATILE | EVAL_FUNCTION_ANGLE ) )  ==  EVAL_FUNCTION_PURE )
+# define	EVAL_FUNCTION_IS_STABLE(flags)		\
+		( ( ( flags )  &  ( EVAL_FUNCTION_PURE | EVAL_FUNCTION_VOLATILE ) )  ==  EVAL_FUNCTION_PURE )
+# define	EVAL_FUNCTION_IS_THREAD_SAFE(flags)	\
+		( ! ( flags )  ||  ( ( flags )  &  EVAL_FUNCTION_THREAD_SAFE )  ||  EVAL_FUNCTION_IS_STABLE ( flags ) )
+# define	EVAL_FUNCTION_COST(cost)		\
+		( ( ( cost )  >  0 ) ?  ( cost ) : EVAL_DEFAULT_FUNCTION_COST )
+
+
+/*==============================================================================================================
+ *
+ *  eval_fold -
+ *	Constant folding pass, called after eval_link() : operators or calls to pure functions whose operands 
+ *	are all constant are replaced with their result, so that they are not computed again each time the program is run.
+ *	The value stack is simulated to know which values are constant ; for each value, the index of the first
+ *	output stack entry that computes it is remembered, so that the entries of a folded subexpression can be 
+ *	replaced with a single numeric entry. A value saved into a register is no longer considered as constant,
+ *	since the save entry must be kept.
+ *	Programs compiled with EVAL_COMPILE_DOUBLE are folded using doubles, rounding constants, operands and
+ *	results the same way the double interpreter does, so that a folded value is the one that would have 
+ *	been computed at run time.
+ *
+ *==============================================================================================================*/	
+typedef struct  eval_fold_value
+   {
+	int		constant ;			// Non-zero if the value is known at compile time
+	int		start ;				// Index of the first output stack entry computing this value
+	eval_double	value ;				// Value, if constant
+    }  eval_fold_value ;
+
+
+static int	eval_fold_operator ( int  type, eval_double  value1, eval_double  value2, int  use_double, eval_double *  result )
+   {
+# if	EVAL_LONG_DOUBLE
+	double		double_result	=  0 ;
+
+
+	if  ( use_double )
+	   {
+		if  ( ! eval_apply_operator_double ( type, ( double ) value1, ( double ) value2, & double_result ) )
+			return ( 0 ) ;
+
+		* result	=  double_result ;
+
+		return ( 1 ) ;
+	    }
+# else
+	( void ) use_double ;
+# endif
+
+	return ( eval_apply_operator ( type, value1, value2, result ) ) ;
+    }
+
+
+static void	eval_fold ( evaluator_program *  program, eval_arena *  scratch )
+   {
+	eval_stack *		stack		=  program -> stack ;
+	eval_fold_value *	values ;
+	eval_double *		function_args ;
+	eval_stack_entry	entry ;
+	int			use_double	=  ( program -> flags & EVAL_COMPILE_DOUBLE ) ?  1 : 0 ;
+	int			top		=  -1 ;
+	int			count		=  0 ;			// Number of output stack entries kept so far
+	int			argc, i, j ;
+
+
+	if  ( eval_stack_is_empty ( stack ) )
+		return ;
+
+	values		=  ( eval_fold_value * ) eval_arena_alloc ( scratch, program -> max_depth * sizeof ( eval_fold_value ) ) ;
+	function_args	=  ( eval_double * ) eval_arena_alloc ( scratch, ( program -> max_argc + 1 ) * sizeof ( eval_double ) ) ;
+
+	for  ( i = 0 ; i  <=  stack -> last_item ; i ++ )
+	   {
+		entry	=  stack -> data [i] ;
+
+		switch  ( entry. type )
+		   {
+			case	STACK_ENTRY_NUMERIC :
+				top ++ ;
+				values [ top ]. start		=  count ;
+				values [ top ]. constant	=  1 ;
+				values [ top ]. value		=  ( use_double ) ?  ( double ) entry. value. double_value : entry. value. double_value ;
+				break ;
+
+			case	STACK_ENTRY_VARIABLE :
+			case	STACK_ENTRY_REGISTER_RECALL :
+				top ++ ;
+				values [ top ]. start		=  count ;
+				values [ top ]. constant	=  0 ;
+				break ;
+
+			case	STACK_ENTRY_REGISTER_SAVE :
+				values [ top ]. constant	=  0 ;
+				break ;
+
+			case	STACK_ENTRY_OUTPUT :
+				top -- ;
+				break ;
+
+			// Operators : the first operand is values [top], the second one (if any) values [top+1]
+			case	STACK_ENTRY_OPERATOR :
+			   {
+				operator_token *	ot	=  entry. value. operator_value ;
+				eval_double		result ;
+
+
+				argc	=  ( ot -> unary ) ?  1 : 2 ;
+				top    -=  argc - 1 ;
+
+				if  ( values [ top ]. constant  &&  ( argc  ==  1  ||  values [ top + 1 ]. constant )  &&
+				      eval_fold_operator ( ot -> type, values [ top + argc - 1 ]. value, values [ top ]. value, use_double, & result ) )
+				   {
+					count				=  values [ top ]. start ;
+					entry. type			=  STACK_ENTRY_NUMERIC ;
+					entry. value. double_value	=  result ;
+					values [ top ]. value		=  result ;
+				    }
+				else
+					values [ top ]. constant	=  0 ;
+
+				break ;
+			    }
+
+			case	STACK_ENTRY_FUNCTION_CALL :
+			   {
+				int		constant ;
+
+
+				argc		=  entry. value. function_value. argc ;
+				top	       -=  argc - 1 ;
+				constant	=  EVAL_FUNCTION_IS_CONSTANT ( entry. value. function_value. flags ) ;
+
+				for  ( j = 0 ; j  <  argc  &&  constant ; j ++ )
+				   {
+					constant		=  values [ top + j ]. constant ;
+					function_args [j]	=  values [ top + j ]. value ;
+				    }
+
+				// Calls without arguments push a new value
+				if  ( ! argc )
+					values [ top ]. start	=  count ;
+
+				if  ( constant )
+				   {
+					count				=  values [ top ]. start ;
+					entry. type			=  STACK_ENTRY_NUMERIC ;
+					entry. value. double_value	=  entry. value. function_value. func ( argc, function_args ) ;
+
+					if  ( use_double )
+						entry. value. double_value	=  ( double ) entry. value. double_value ;
+
+					values [ top ]. value		=  entry. value. double_value ;
+				    }
+
+				values [ top ]. constant	=  constant ;
+				break ;
+			    }
+		    }
+
+		stack -> data [ count ++ ]	=  entry ;
+	    }
+
+	stack -> last_item	=  count - 1 ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_cse -
+ *	Common subexpression elimination pass, called after eval_fold() : when the same subexpression appears
+ *	several times in the output stack, its first occurrence is followed by a register save entry, and the
+ *	other occurrences are replaced with a register recall entry. The cells used for that purpose are 
+ *	allocated after the ones used by the registers of the expression, so that no user-visible register
+ *	is consumed.
+ *	Each output stack entry is the root of the subexpression made of the entries between start [i] and i ;
+ *	since the output stack is in reverse-polish order, two subexpressions are identical when their entries 
+ *	are. Subexpressions are processed by decreasing size, so that a subexpression appearing inside a larger
+ *	one that has been eliminated is not counted. 
+ *	Subexpressions that use registers, or call functions for which EVAL_FUNCTION_IS_STABLE() is false, are
+ *	not eliminated, since their value may change from one occurrence to the other. Only the function flags
+ *	matter, not whether the function is builtin : user functions flagged as pure are eliminated like the
+ *	builtin ones, and functions flagged as volatile never are.
+ *	In expression sets, the output stack holds all the expressions, so that subexpressions shared by
+ *	several expressions are computed only once.
+ *
+ *==============================================================================================================*/	
+static unsigned int	eval_cse_hash_entry ( const eval_stack_entry *  se )
+   {
+	unsigned int	hash	=  ( unsigned int ) se -> type * 16777619u ;
+	double		value ;
+	unsigned char	bytes [ sizeof ( double ) ] ;
+	int		i ;
+
+
+	switch  ( se -> type )
+	   {
+		case	STACK_ENTRY_NUMERIC :
+			value	=  ( double ) se -> value. double_value ;
+			memcpy ( bytes, & value, sizeof ( double ) ) ;
+
+			for  ( i = 0 ; i  <  ( int ) sizeof ( double ) ; i ++ )
+				hash	=  ( hash ^ bytes [i] ) * 16777619u ;
+			break ;
+
+		case	STACK_ENTRY_VARIABLE :
+			hash	=  ( hash ^ ( unsigned int ) se -> value. variable_value. slot ) * 16777619u ;
+			break ;
+
+		case	STACK_ENTRY_OPERATOR :
+			hash	=  ( hash ^ ( unsigned int ) se -> value. operator_value -> type ) * 16777619u ;
+			break ;
+
+		case	STACK_ENTRY_FUNCTION_CALL :
+			hash	=  ( hash ^ ( unsigned int ) ( ( size_t ) se -> value. function_value. func >> 4 ) ) * 16777619u ;
+			hash	=  ( hash ^ ( unsigned int ) se -> value. function_value. argc ) * 16777619u ;
+			break ;
+	    }
+
+	return ( hash ) ;
+    }
+
+
+static int	eval_cse_same_entry ( const eval_stack_entry *  a, const eval_stack_entry *  b )
+   {
+	if  ( a -> type  !=  b -> type )
+		return ( 0 ) ;
+
+	switch  ( a -> type )
+	   {
+		case	STACK_ENTRY_NUMERIC :
+			return ( a -> value. double_value  ==  b -> value. double_value  &&
+				 signbit ( a -> value. double_value )  ==  signbit ( b -> value. double_value ) ) ;
+
+		case	STACK_ENTRY_VARIABLE :
+			return ( a -> value. variable_value. slot  ==  b -> value. variable_value. slot ) ;
+
+		case	STACK_ENTRY_OPERATOR :
+			return ( a -> value. operator_value -> type  ==  b -> value. operator_value -> type ) ;
+
+		case	STACK_ENTRY_FUNCTION_CALL :
+			return ( a -> value. function_value. argc  ==  b -> value. function_value. argc  &&
+				 a -> value. function_value. func  ==  b -> value. function_value. func ) ;
+
+		default :
+			return ( 0 ) ;
+	    }
+    }
+
+
+// Information about the subexpression whose root is a given output stack entry
+typedef struct  eval_cse_node
+   {
+	int		start ;				// Index of the first entry of the subexpression
+	unsigned int	hash ;				// Hash value of the subexpression entries
+	int		eligible ;			// Non-zero if the subexpression can be eliminated
+	int		save_cell ;			// Cell where to save the subexpression value, or -1
+	int		recall_cell ;			// Cell replacing the subexpression, or -1
+	int		removed ;			// Non-zero if the entry is part of a replaced subexpression
+    }  eval_cse_node ;
+
+
+// A subexpression that may be eliminated
+typedef struct  eval_cse_candidate
+   {
+	int		root ;				// Index of the root entry of the subexpression
+	int		size ;				// Number of entries
+	unsigned int	hash ;				// Hash value
+    }  eval_cse_candidate ;
+
+
+static int	__eval_cse_sort__ ( const void *  a, const void *  b )
+   {
+	const eval_cse_candidate *	ca	=  ( const eval_cse_candidate * ) a,
+	      *				cb	=  ( const eval_cse_candidate * ) b ;
+
+
+	if  ( ca -> size  !=  cb -> size )
+		return ( cb -> size - ca -> size ) ;
+
+	if  ( ca -> hash  !=  cb -> hash )
+		return ( ( ca -> hash  <  cb -> hash ) ?  -1 : 1 ) ;
+
+	return ( ca -> root - cb -> root ) ;
+    }
+
+
+static void	eval_cse ( evaluator_program *  program, eval_arena *  scratch )
+   {
+	eval_stack *		stack		=  program -> stack ;
+	int			count		=  stack -> last_item + 1 ;
+	eval_stack_entry *	entries ;
+	eval_cse_node *		nodes ;
+	int *			roots ;				// Simulated value stack, holding root entry indexes
+	eval_cse_candidate *	candidates ;
+	int			candidate_count	=  0 ;
+	int			cells_used	=  0 ;
+	int			top		=  -1 ;
+	int			argc, i, j, k ;
+
+
+	if  ( count  <  2 )
+		return ;
+
+	entries		=  stack -> data ;
+	nodes		=  ( eval_cse_node * ) eval_arena_alloc ( scratch, count * sizeof ( eval_cse_node ) ) ;
+	roots		=  ( int * ) eval_arena_alloc ( scratch, count * sizeof ( int ) ) ;
+	candidates	=  ( eval_cse_candidate * ) eval_arena_alloc ( scratch, count * sizeof ( eval_cse_candidate ) ) ;
+
+	// Compute the start, hash value and eligibility of each subexpression
+	for  ( i = 0 ; i  <  count ; i ++ )
+	   {
+		eval_cse_node *		node	=  nodes + i ;
+		eval_stack_entry *	se	=  entries + i ;
+
+
+		node -> start		=  i ;
+		node -> hash		=  eval_cse_hash_entry ( se ) ;
+		node -> eligible	=  1 ;
+		node -> save_cell	=  -1 ;
+		node -> recall_cell	=  -1 ;
+		node -> removed		=  0 ;
+
+		switch  ( se -> type )
+		   {
+			case	STACK_ENTRY_OPERATOR :
+				argc	=  ( se -> value. operator_value -> unary ) ?  1 : 2 ;
+				break ;
+
+			case	STACK_ENTRY_FUNCTION_CALL :
+				argc			=  se -> value. function_value. argc ;
+				node -> eligible	=  EVAL_FUNCTION_IS_STABLE ( se -> value. function_value. flags ) ;
+				break ;
+
+			// A register save applies to the value on top of the stack
+			case	STACK_ENTRY_REGISTER_SAVE :
+				argc			=  1 ;
+				node -> eligible	=  0 ;
+				break ;
+
+			case	STACK_ENTRY_REGISTER_RECALL :
+				argc			=  0 ;
+				node -> eligible	=  0 ;
+				break ;
+
+			// The result of an expression of a set is popped, and nothing is pushed
+			case	STACK_ENTRY_OUTPUT :
+				node -> eligible	=  0 ;
+				top -- ;
+				continue ;
+
+			default :
+				argc	=  0 ;
+		    }
+
+		for  ( j = top - argc + 1 ; j  <=  top ; j ++ )
+		   {
+			eval_cse_node *		child	=  nodes + roots [j] ;
+
+			node -> hash		 =  ( node -> hash ^ child -> hash ) * 16777619u ;
+			node -> eligible	&=  child -> eligible ;
+		    }
+
+		if  ( argc )
+		   {
+			top		-=  argc ;
+			node -> start	 =  nodes [ roots [ top + 1 ] ]. start ;
+		    }
+
+		roots [ ++ top ]	=  i ;
+
+		// Single entries are not worth being eliminated
+		if  ( node -> eligible  &&  node -> start  <  i )
+		   {
+			candidates [ candidate_count ]. root	=  i ;
+			candidates [ candidate_count ]. size	=  i - node -> start + 1 ;
+			candidates [ candidate_count ]. hash	=  node -> hash ;
+			candidate_count ++ ;
+		    }
+	    }
+
+	// Sort candidates by decreasing size, then by hash value, then by position
+	qsort ( candidates, candidate_count, sizeof ( eval_cse_candidate ), __eval_cse_sort__ ) ;
+
+	for  ( i = 0 ; i  <  candidate_count ; i ++ )
+	   {
+		int		first	=  candidates [i]. root ;
+		int		size	=  candidates [i]. size ;
+		int		cell	=  -1 ;
+
+
+		// Skip subexpressions that have already been replaced or belong to a replaced subexpression
+		if  ( nodes [ first ]. removed  ||  nodes [ first ]. recall_cell  >=  0  ||  nodes [ first ]. save_cell  >=  0 )
+			continue ;
+
+		// Look for identical subexpressions, which follow in the candidate list
+		for  ( j = i + 1 ; j  <  candidate_count ; j ++ )
+		   {
+			int		other	=  candidates [j]. root ;
+
+
+			if  ( candidates [j]. size  !=  size  ||  candidates [j]. hash  !=  candidates [i]. hash )
+				break ;
+
+			if  ( nodes [ other ]. removed  ||  nodes [ other ]. recall_cell  >=  0 )
+				continue ;
+
+			for  ( k = 0 ; k  <  size ; k ++ )
+			   {
+				if  ( ! eval_cse_same_entry ( entries + nodes [ first ]. start + k, entries + nodes [ other ]. start + k ) )
+					break ;
+			    }
+
+			if  ( k  <  size )
+				continue ;
+
+			// Identical subexpression found : the first occurrence will save its value into a new cell
+			if  ( cell  <  0 )
+			   {
+				cell				=  program -> cell_count + cells_used ++ ;
+				nodes [ first ]. save_cell	=  cell ;
+			    }
+
+			nodes [ other ]. recall_cell	=  cell ;
+
+			for  ( k = nodes [ other ]. start ; k  <  other ; k ++ )
+				nodes [k]. removed	=  1 ;
+		    }
+	    }
+
+	// Rebuild the output stack if common subexpressions have been found
+	if  ( cells_used )
+	   {
+		eval_stack_entry	entry ;
+
+
+		stack -> data		=  ( eval_stack_entry * ) eval_arena_alloc ( stack -> arena, stack -> size * sizeof ( eval_stack_entry ) ) ;
+		stack -> last_item	=  -1 ;
+
+		for  ( i = 0 ; i  <  count ; i ++ )
+		   {
+			if  ( nodes [i]. removed )
+				continue ;
+
+			if  ( nodes [i]. recall_cell  >=  0 )
+			   {
+				entry. type			=  STACK_ENTRY_REGISTER_RECALL ;
+				entry. value. register_value	=  nodes [i]. recall_cell ;
+				eval_stack_push ( stack, & entry ) ;
+				continue ;
+			    }
+
+			eval_stack_push ( stack, entries + i ) ;
+
+			if  ( nodes [i]. save_cell  >=  0 )
+			   {
+				entry. type			=  STACK_ENTRY_REGISTER_SAVE ;
+				entry. value. register_value	=  nodes [i]. save_cell ;
+				eval_stack_push ( stack, & entry ) ;
+			    }
+		    }
+
+		program -> cell_count	+=  cells_used ;
+	    }
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_assemble -
+ *	Generates the bytecode executed by eval_compute() from the output stack of a program. The batch engine
+ *	and the native code generator also work from the bytecode, so that they can process programs loaded
+ *	from a file, which have no output stack.
+ *
+ *==============================================================================================================*/	
+static void	eval_assemble ( evaluator_program *  program )
+   {
+	eval_stack *		stack		=  program -> stack ;
+	eval_instruction *	ip ;
+	eval_stack_entry *	se ;
+	int			i, j ;
+
+
+	if  ( eval_stack_is_empty ( stack ) )
+		return ;
+
+	program -> code		=  ( eval_instruction * ) eval_arena_alloc ( & program -> arena, ( stack -> last_item + 2 ) * sizeof ( eval_instruction ) ) ;
+	program -> code_size	=  stack -> last_item + 1 ;
+	program -> functions	=  ( eval_function * ) eval_arena_alloc ( & program -> arena, ( stack -> last_item + 1 ) * sizeof ( eval_function ) ) ;
+	program -> function_flags	=  ( int * ) eval_arena_alloc ( & program -> arena, ( stack -> last_item + 1 ) * sizeof ( int ) ) ;
+	program -> vector_functions	=  ( eval_vector_function * ) eval_arena_alloc ( & program -> arena, ( stack -> last_item + 1 ) * sizeof ( eval_vector_function ) ) ;
+	program -> cost		=  0 ;
+
+	for  ( i = 0, ip = program -> code ; i  <=  stack -> last_item ; i ++, ip ++ )
+	   {
+		se			=  stack -> data + i ;
+		ip -> argument		=  0 ;
+		ip -> fast_value	=  0 ;
+
+		switch  ( se -> type )
+		   {
+			case	STACK_ENTRY_NUMERIC :
+				ip -> opcode		=  OPCODE_NUMBER ;
+				ip -> fast_value	=  se -> fast_value ;
+				ip -> value. number	=  se -> value. double_value ;
+				break ;
+
+			case	STACK_ENTRY_VARIABLE :
+				ip -> opcode		=  OPCODE_VARIABLE ;
+				ip -> argument		=  se -> value. variable_value. slot ;
+				break ;
+
+			case	STACK_ENTRY_REGISTER_SAVE :
+				ip -> opcode		=  OPCODE_REGISTER_SAVE ;
+				ip -> argument		=  se -> value. register_value ;
+				break ;
+
+			case	STACK_ENTRY_REGISTER_RECALL :
+				ip -> opcode		=  OPCODE_REGISTER_RECALL ;
+				ip -> argument		=  se -> value. register_value ;
+				break ;
+
+			case	STACK_ENTRY_FUNCTION_CALL :
+				ip -> opcode		=  OPCODE_FUNCTION_CALL ;
+				ip -> argument		=  se -> value. function_value. argc ;
+
+				// Each distinct function is stored once in the function table
+				for  ( j = 0 ; j  <  program -> function_count ; j ++ )
+				   {
+					if  ( program -> functions [j]  ==  se -> value. function_value. func )
+						break ;
+				    }
+
+				if  ( j  ==  program -> function_count )
+				   {
+					program -> functions [ j ]		=  se -> value. function_value. func ;
+					program -> function_flags [ j ]		=  se -> value. function_value. flags ;
+					program -> vector_functions [ j ]	=  se -> value. function_value. vfunc ;
+					program -> function_count ++ ;
+				    }
+
+				ip -> value. function	=  j ;
+				program -> cost	       +=  EVAL_FUNCTION_COST ( se -> value. function_value. cost ) - 1 ;
+				break ;
+
+			case	STACK_ENTRY_OPERATOR :
+				ip -> opcode		=  se -> value. operator_value -> type ;
+				break ;
+
+			case	STACK_ENTRY_OUTPUT :
+				ip -> opcode		=  OPCODE_OUTPUT ;
+				ip -> argument		=  se -> value. output_value ;
+				break ;
+		    }
+	    }
+
+	ip -> opcode	=  OPCODE_END ;
+
+	// Each instruction costs 1, plus the cost of function calls
+	program -> cost   +=  program -> code_size ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  eval_compile -
+ *	Parses the specified expressions and returns the corresponding program, or NULL if a syntax error
+ *	occurred. flags is a combination of EVAL_COMPILE_* constants ; EVAL_COMPILE_JIT implies
+ *	EVAL_COMPILE_DOUBLE, so that the interpreter gives the same results when native code cannot be
+ *	generated.
+ *	When set is zero, count must be 1 and the program computes a single result. Otherwise, the program
+ *	computes the results of all the expressions, each one being stored by an output entry.
+ *
+ *==============================================================================================================*/	
+static evaluator_program *	eval_compile ( const char **  expressions, int  count, int  set, int  allow_variables, int  flags )
+   {
+	evaluator_program *	program ;
+	eval_arena		arena ;
+	eval_arena		scratch ;
+	eval_stack *		operator_stack ;
+	eval_stack_entry	entry ;
+	char			scratch_buffer [ ARENA_COMPILE_BUFFER_SIZE ] ;
+	int			status		=  1 ;
+	int			last_item ;
+	int			i ;
+	EVAL_STATS_DECLARE ( start )
+
+
+	// The program structure is the first allocation of its own arena ; temporary data comes from a local buffer,
+	// so that most compilations only need one call to eval_malloc()
+	eval_arena_initialize ( & arena, NULL, 0 ) ;
+	program			=  ( evaluator_program * ) eval_arena_alloc ( & arena, sizeof ( evaluator_program ) ) ;
+	program -> arena	=  arena ;
+
+	eval_arena_initialize ( & scratch, scratch_buffer, sizeof ( scratch_buffer ) ) ;
+	operator_stack		=  ( eval_stack * ) eval_stack_alloc ( & scratch, OPERATOR_STACK_SIZE, sizeof ( eval_stack_entry ) ) ;
+
+	program -> stack		=  ( eval_stack * ) eval_stack_alloc ( & program -> arena, OUTPUT_STACK_SIZE, sizeof ( eval_stack_entry ) ) ;
+	program -> code			=  NULL ;
+	program -> code_size		=  0 ;
+	program -> functions		=  NULL ;
+	program -> function_flags	=  NULL ;
+	program -> vector_functions	=  NULL ;
+	program -> function_count	=  0 ;
+	program -> cost			=  0 ;
+	program -> image		=  NULL ;
+	program -> variables		=  NULL ;
+	program -> variable_count	=  0 ;
+	program -> variable_max		=  0 ;
+	program -> max_depth		=  0 ;
+	program -> cell_count		=  0 ;
+	program -> max_argc		=  0 ;
+	program -> flags		=  ( flags & EVAL_COMPILE_JIT ) ?  flags | EVAL_COMPILE_DOUBLE : flags ;
+	program -> jit_code		=  NULL ;
+	program -> jit_size		=  0 ;
+
+	EVAL_STATS_START ( start ) ;
+
+	for  ( i = 0 ; i  <  count  &&  status ; i ++ )
+	   {
+		last_item	=  program -> stack -> last_item ;
+		status		=  eval_parse ( expressions [i], program, operator_stack, & scratch, allow_variables ) ;
+
+		if  ( ! status  ||  ! set )
+			continue ;
+
+		if  ( program -> stack -> last_item  ==  last_item )
+		   {
+			eval_error ( E_EVAL_EMPTY_EXPRESSION, -1, -1, "Expression #%d of the set is empty", i ) ;
+			status	=  0 ;
+			break ;
+		    }
+
+		entry. type			=  STACK_ENTRY_OUTPUT ;
+		entry. value. output_value	=  i ;
+		eval_stack_push ( program -> stack, & entry ) ;
+	    }
+
+	EVAL_STATS_STOP ( EVAL_PHASE_PARSE, start, 1 ) ;
+
+	if  ( status )
+	   {
+		EVAL_STATS_START ( start ) ;
+		status	=  eval_link ( program ) ;
+
+		if  ( status )
+		   {
+			eval_fold ( program, & scratch ) ;
+			eval_cse  ( program, & scratch ) ;
+
+			// Numeric values are converted once for all for the engines that compute with doubles
+			for  ( i = 0 ; i  <=  program -> stack -> last_item ; i ++ )
+			   {
+				eval_stack_entry *	se	=  program -> stack -> data + i ;
+
+				if  ( se -> type  ==  STACK_ENTRY_NUMERIC )
+					se -> fast_value	=  ( double ) se -> value. double_value ;
+			    }
+
+			eval_assemble ( program ) ;
+
+			if  ( program -> flags & EVAL_COMPILE_JIT )
+				eval_jit_compile ( program ) ;
+		    }
+
+		EVAL_STATS_STOP ( EVAL_PHASE_OPTIMIZE, start, 1 ) ;
+	    }
+
+	eval_arena_release ( & scratch ) ;
+
+	if  ( ! status )
+	   {
+		evaluator_free_program ( program ) ;
+		program		=  NULL ;
+	    }
+
+	return ( program ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  Batch evaluation engine.
+ *	evalbatch.h is instantiated for double columns, which can use the SIMD kernels, and for float columns.
+ *
+ *==============================================================================================================*/	
+# define	EVAL_VALUE			double
+# define	EVAL_TEMPLATE(name)		name
+# define	EVAL_MATH(func)			func
+# define	EVAL_BATCH_KERNELS		1
+# define	EVAL_BATCH_DOUBLE		1
+# include	"evalbatch.h"
+
+# define	EVAL_VALUE			float
+# define	EVAL_TEMPLATE(name)		name##_float
+# define	EVAL_MATH(func)			func##f
+# define	EVAL_BATCH_KERNELS		0
+# define	EVAL_BATCH_DOUBLE		0
+# include	"evalbatch.h"
+
+
+/*==============================================================================================================
+ *
+ *  eval_check_columns -
+ *	Checks that an input column has been supplied for each variable of a batch computation.
+ *
+ *==============================================================================================================*/	
+static int	eval_check_columns ( const evaluator_program *  program, const void **  columns )
+   {
+	int	i ;
+
+
+	for  ( i = 0 ; i  <  program -> variable_count ; i ++ )
+	   {
+		if  ( columns  ==  NULL  ||  columns [i]  ==  NULL )
+		   {
+			eval_error ( E_EVAL_UNDEFINED_VARIABLE, -1, -1, "No input column supplied for variable '%s'",
+					program -> variables [i] ) ;
+			return ( 0 ) ;
+		    }
+	    }
+
+	return ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  Thread pool for parallel batch evaluation.
+ *
+ *==============================================================================================================*/	
+# include	"evalthreads.h"
+
+
+/*==============================================================================================================
+ *
+ *  Cache of the programs compiled by evaluate().
+ *
+ *==============================================================================================================*/	
+# include	"evalcache.h"
+
+
+/*==============================================================================================================
+ *
+ *  Program images.
+ *
+ *==============================================================================================================*/	
+# include	"evalimage.h"
+
+
+/*==============================================================================================================
+ *
+ *  Incremental evaluation of expression sets.
+ *
+ *==============================================================================================================*/	
+# include	"evalincremental.h"
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_create_context, evaluator_free_context -
+ *	Allocates/frees an evaluator context. A new context uses trigonometric units as specified by the
+ *	evaluator_use_degrees variable of the calling thread at the time it is created.
+ *
+ *==============================================================================================================*/	
+evaluator_context *	evaluator_create_context ( )
+   {
+	evaluator_context *	context		=  ( evaluator_context * ) eval_malloc ( sizeof ( evaluator_context ) ) ;
+
+
+	EVAL_INITIALIZE ( ) ;
+
+	context -> error_number		=  E_EVAL_OK ;
+	* context -> error_message	=  '\0' ;
+	context -> use_degrees		=  evaluator_use_degrees ;
+
+# if	EVAL_INSTRUMENTATION
+	memset ( & context -> statistics, 0, sizeof ( context -> statistics ) ) ;
+# endif
+
+# if	EVAL_PROFILER
+	context -> function_profile	=  NULL ;
+	eval_profile_reset ( context ) ;
+# endif
+
+	return ( context ) ;
+    }
+
+
+void	evaluator_free_context ( evaluator_context *  context )
+   {
+	if  ( context  !=  NULL )
+	   {
+# if	EVAL_PROFILER
+		eval_profile_reset ( context ) ;
+# endif
+		eval_free ( context ) ;
+	    }
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_get_context_errno, evaluator_get_context_error -
+ *	Return the error code and message of the last operation performed with the specified context, or
+ *	with the default context of the calling thread if NULL.
+ *
+ *==============================================================================================================*/	
+int	evaluator_get_context_errno ( const evaluator_context *  context )
+   {
+	if  ( context  ==  NULL )
+		context		=  & eval_default_context ;
+
+	return ( context -> error_number ) ;
+    }
+
+
+const char *	evaluator_get_context_error ( const evaluator_context *  context )
+   {
+	if  ( context  ==  NULL )
+		context		=  & eval_default_context ;
+
+	return ( context -> error_message ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_get_context_statistics, evaluator_reset_context_statistics -
+ *	Get/reset the time spent in each phase by the evaluations performed with the specified context, or
+ *	with the default context of the calling thread if NULL. evaluator_get_context_statistics() returns 0
+ *	and clears the statistics structure when the package has been compiled without EVAL_INSTRUMENTATION.
+ *
+ *==============================================================================================================*/	
+int	evaluator_get_context_statistics ( const evaluator_context *  context, evaluator_phase_statistics *  statistics )
+   {
+# if	EVAL_INSTRUMENTATION
+	if  ( context  ==  NULL )
+		context		=  & eval_default_context ;
+
+	memcpy ( statistics, & context -> statistics, sizeof ( evaluator_phase_statistics ) ) ;
+
+	return ( 1 ) ;
+# else
+	( void ) context ;
+	memset ( statistics, 0, sizeof ( evaluator_phase_statistics ) ) ;
+
+	return ( 0 ) ;
+# endif
+    }
+
+
+void	evaluator_reset_context_statistics ( evaluator_context *  context )
+   {
+# if	EVAL_INSTRUMENTATION
+	if  ( context  ==  NULL )
+		context		=  & eval_default_context ;
+
+	memset ( & context -> statistics, 0, sizeof ( evaluator_phase_statistics ) ) ;
+# else
+	( void ) context ;
+# endif
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_get_context_function_profile, evaluator_get_context_operator_profile,
+ *  evaluator_reset_context_profile -
+ *	Get/reset the number of calls, time and argument counts of each function and operator called by the
+ *	evaluations performed with the specified context, or with the default context of the calling thread
+ *	if NULL.
+ *	evaluator_get_context_function_profile() stores at most max_entries entries, in the same order as the
+ *	definitions returned by evaluator_get_registered_functions(), and returns the number of registered
+ *	functions. evaluator_get_context_operator_profile() stores one entry per operator, in opcode order, and
+ *	returns the number of operators ; the unary and binary forms of "+" and "-" have separate entries.
+ *	Both return 0 when the package has been compiled without EVAL_PROFILER.
+ *
+ *==============================================================================================================*/	
+int	evaluator_get_context_function_profile ( const evaluator_context *  context, evaluator_profile_entry *  entries, int  max_entries )
+   {
+# if	EVAL_PROFILER
+	const evaluator_function_definition *	definitions ;
+	evaluator_profile_entry *		entry ;
+	size_t					mask ;
+	size_t					slot ;
+	int					count ;
+	int					i ;
+
+
+	EVAL_INITIALIZE ( ) ;
+
+	if  ( context  ==  NULL )
+		context		=  & eval_default_context ;
+
+	definitions	=  ( const evaluator_function_definition * ) eval_function_definitions. data ;
+	count		=  eval_function_definitions. item_count ;
+	mask		=  ( size_t ) context -> function_profile_size - 1 ;
+
+	for  ( i = 0 ; i  <  count  &&  i  <  max_entries ; i ++ )
+	   {
+		entry	=  entries + i ;
+		memset ( entry, 0, sizeof ( evaluator_profile_entry ) ) ;
+		entry -> name	=  definitions [i]. name ;
+
+		if  ( ! context -> function_profile_count )
+			continue ;
+
+		// Same probing as eval_profile_lookup(), without creating missing entries
+		slot	=  ( ( size_t ) definitions [i]. func  >>  4 ) * 2654435761u  &  mask ;
+
+		while  ( context -> function_profile [ slot ]. function  !=  NULL )
+		   {
+			if  ( context -> function_profile [ slot ]. function  ==  definitions [i]. func )
+			   {
+				* entry		=  context -> function_profile [ slot ]. entry ;
+				entry -> name	=  definitions [i]. name ;
+				break ;
+			    }
+
+			slot	=  ( slot + 1 )  &  mask ;
+		    }
+	    }
+
+	return ( count ) ;
+# else
+	( void ) context ;
+	( void ) entries ;
+	( void ) max_entries ;
+
+	return ( 0 ) ;
+# endif
+    }
+
+
+int	evaluator_get_context_operator_profile ( const evaluator_context *  context, evaluator_profile_entry *  entries, int  max_entries )
+   {
+# if	EVAL_PROFILER
+	int		i ;
+
+
+	if  ( context  ==  NULL )
+		context		=  & eval_default_context ;
+
+	for  ( i = 0 ; i  <  OP_FACTORIAL  &&  i  <  max_entries ; i ++ )
+	   {
+		entries [i]		=  context -> operator_profile [ OP_PLUS + i ] ;
+		entries [i]. name	=  eval_profile_operator_names [ OP_PLUS + i ] ;
+	    }
+
+	return ( OP_FACTORIAL ) ;
+# else
+	( void ) context ;
+	( void ) entries ;
+	( void ) max_entries ;
+
+	return ( 0 ) ;
+# endif
+    }
+
+
+void	evaluator_reset_context_profile ( evaluator_context *  context )
+   {
+# if	EVAL_PROFILER
+	if  ( context  ==  NULL )
+		context		=  & eval_default_context ;
+
+	eval_profile_reset ( context ) ;
+# else
+	( void ) context ;
+# endif
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_get_context_degrees, evaluator_set_context_degrees -
+ *	Gets/sets the trigonometric units used by a context (non-zero for degrees, zero for radians).
+ *	The default context always uses the value of the evaluator_use_degrees variable of the calling thread.
+ *
+ *==============================================================================================================*/	
+int	evaluator_get_context_degrees ( const evaluator_context *  context )
+   {
+	if  ( context  ==  NULL )
+		return ( evaluator_use_degrees ) ;
+
+	return ( context -> use_degrees ) ;
+    }
+
+
+void	evaluator_set_context_degrees ( evaluator_context *  context, int  use_degrees )
+   {
+	if  ( context  ==  NULL )
+		evaluator_use_degrees	=  use_degrees ;
+	else
+		context -> use_degrees	=  use_degrees ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluate -
+ *	Expression analyzer.
+ *
+ *==============================================================================================================*/	
+int	evaluate_ctx ( evaluator_context *  context, const char *  str, double *  output, eval_callback  callback )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	evaluator_program *	program ;
+	eval_cache_key		key ;
+	int			status		=  0 ;
+	eval_double		result		=  0 ;
+
+
+	// Look for an already compiled program ; a cached program that references variables cannot be used 
+	// without a callback, so compile the expression again to get the appropriate error
+	eval_cache_normalize ( str, & key ) ;
+	program		=  eval_cache_lookup ( & key ) ;
+
+	if  ( program  !=  NULL  &&  program -> variable_count  &&  callback  ==  NULL )
+	   {
+		eval_cache_release ( program ) ;
+		program		=  NULL ;
+	    }
+
+	// Otherwise, parse expression and cache the result
+	if  ( program  ==  NULL )
+	   {
+		program		=  eval_compile ( & str, 1, 0, callback  !=  NULL, EVAL_COMPILE_DEFAULT ) ;
+
+		if  ( program  !=  NULL )
+			eval_cache_insert ( & key, program ) ;
+	    }
+
+	// Then compute its result
+	if  ( program  !=  NULL )
+	   {
+		status	=  eval_compute ( program, & result, NULL, callback, NULL ) ;
+		eval_cache_release ( program ) ;
+	    }
+
+	* output	=  ( double ) result ;
+
+	// All done, return
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluate ( const char *  str, double *  output )
+   {
+	return ( evaluate_ctx ( NULL, str, output, NULL ) ) ;
+    }
+
+
+int	evaluate_ex ( const char *  str, double *  output, eval_callback  callback )
+   {
+	return ( evaluate_ctx ( NULL, str, output, callback ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_set_cache_size, evaluator_flush_cache, evaluator_get_cache_statistics -
+ *	Control the cache of the programs compiled by evaluate() and evaluate_ex(). evaluator_set_cache_size()
+ *	flushes the cache and changes the maximum number of programs it holds ; a size of zero disables it.
+ *	evaluator_get_cache_statistics() returns the number of hits, misses and evictions since the package
+ *	was loaded, together with the current number of cached programs.
+ *
+ *==============================================================================================================*/	
+void	evaluator_set_cache_size ( int  size )
+   {
+	eval_cache_flush ( ( size  <  0 ) ?  0 : size ) ;
+    }
+
+
+void	evaluator_flush_cache ( )
+   {
+	eval_cache_flush ( -1 ) ;
+    }
+
+
+void	evaluator_get_cache_statistics ( evaluator_cache_statistics *  statistics )
+   {
+	eval_cache *		cache		=  & eval_program_cache ;
+
+
+	eval_mutex_lock ( & cache -> lock ) ;
+
+	statistics -> hits		=  cache -> hits ;
+	statistics -> misses		=  cache -> misses ;
+	statistics -> evictions		=  cache -> evictions ;
+	statistics -> count		=  cache -> count ;
+	statistics -> size		=  cache -> size ;
+
+	eval_mutex_unlock ( & cache -> lock ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_compile, evaluator_run, evaluator_free_program -
+ *	Compile-once/run-many interface : evaluator_compile() parses an expression (variable references are
+ *	always allowed) and returns a program that evaluator_run() can compute any number of times, without
+ *	having to parse the expression again.
+ *	A program is never modified once compiled, so that it can be run by several threads at the same time.
+ *	evaluator_compile_ex() accepts EVAL_COMPILE_* flags ; with EVAL_COMPILE_DOUBLE, evaluator_run() and
+ *	evaluator_run_bound() compute the program using doubles instead of eval_double values ; with
+ *	EVAL_COMPILE_JIT, they run native code generated for the program when possible.
+ *
+ *==============================================================================================================*/	
+evaluator_program *	evaluator_compile_ex_ctx ( evaluator_context *  context, const char *  str, int  flags )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	evaluator_program *	program ;
+
+
+	program		=  eval_compile ( & str, 1, 0, 1, flags ) ;
+	eval_leave ( previous, 0 ) ;
+
+	return ( program ) ;
+    }
+
+
+evaluator_program *	evaluator_compile_ex ( const char *  str, int  flags )
+   {
+	return ( evaluator_compile_ex_ctx ( NULL, str, flags ) ) ;
+    }
+
+
+evaluator_program *	evaluator_compile_ctx ( evaluator_context *  context, const char *  str )
+   {
+	return ( evaluator_compile_ex_ctx ( context, str, EVAL_COMPILE_DEFAULT ) ) ;
+    }
+
+
+evaluator_program *	evaluator_compile ( const char *  str )
+   {
+	return ( evaluator_compile_ex_ctx ( NULL, str, EVAL_COMPILE_DEFAULT ) ) ;
+    }
+
+
+int	evaluator_run_ctx ( evaluator_context *  context, const evaluator_program *  program, double *  output, eval_callback  callback )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	int			status ;
+	eval_double		result		=  0 ;
+
+
+	if  ( program -> variable_count  &&  callback  ==  NULL )
+	   {
+		eval_error ( E_EVAL_VARIABLES_NOT_ALLOWED, -1, -1, 
+			"Variable references are not allowed when no callback is supplied to evaluator_run()" ) ;
+		status	=  0 ;
+	    }
+	else
+		status	=  eval_compute ( program, & result, NULL, callback, NULL ) ;
+
+	* output	=  ( double ) result ;
+
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluator_run ( const evaluator_program *  program, double *  output, eval_callback  callback )
+   {
+	return ( evaluator_run_ctx ( NULL, program, output, callback ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_run_bound -
+ *	Same as evaluator_run(), but variable values are taken from the supplied array, which is indexed by
+ *	variable slot (see evaluator_get_variable_slot()) ; no callback is involved.
+ *
+ *==============================================================================================================*/	
+int	evaluator_run_bound_ctx ( evaluator_context *  context, const evaluator_program *  program, double *  output, const eval_double *  values )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	int			status ;
+	eval_double		result		=  0 ;
+
+
+	if  ( program -> variable_count  &&  values  ==  NULL )
+	   {
+		eval_error ( E_EVAL_VARIABLES_NOT_ALLOWED, -1, -1, 
+			"Variable references are not allowed when no values are supplied to evaluator_run_bound()" ) ;
+		status	=  0 ;
+	    }
+	else
+		status	=  eval_compute ( program, & result, values, NULL, NULL ) ;
+
+	* output	=  ( double ) result ;
+
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluator_run_bound ( const evaluator_program *  program, double *  output, const eval_double *  values )
+   {
+	return ( evaluator_run_bound_ctx ( NULL, program, output, values ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_get_scratch_size -
+ *	Returns the size in bytes of the scratch buffer that evaluator_run_scratch() needs to run the specified
+ *	program. The size does not change once the program is compiled.
+ *
+ *==============================================================================================================*/	
+size_t	evaluator_get_scratch_size ( const evaluator_program *  program )
+   {
+	return ( eval_compute_scratch_size ( program ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_run_scratch -
+ *	Same as evaluator_run_bound(), but the value stack is placed in the supplied scratch buffer, which must
+ *	be at least evaluator_get_scratch_size() bytes long and aligned on ARENA_ALIGNMENT bytes, as memory
+ *	returned by malloc() is. No memory is allocated, so that a program can be run any number of times 
+ *	without touching the heap. 
+ *
+ *==============================================================================================================*/	
+int	evaluator_run_scratch_ctx ( evaluator_context *  context, const evaluator_program *  program, double *  output, 
+				    const eval_double *  values, void *  scratch, size_t  scratch_size )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	int			status ;
+	eval_double		result		=  0 ;
+
+
+	if  ( program -> variable_count  &&  values  ==  NULL )
+	   {
+		eval_error ( E_EVAL_VARIABLES_NOT_ALLOWED, -1, -1, 
+			"Variable references are not allowed when no values are supplied to evaluator_run_scratch()" ) ;
+		status	=  0 ;
+	    }
+	else if  ( scratch  ==  NULL  ||  ( ( size_t ) scratch & ( ARENA_ALIGNMENT - 1 ) )  ||  
+		   scratch_size  <  eval_compute_scratch_size ( program ) )
+	   {
+		eval_error ( E_EVAL_SCRATCH_TOO_SMALL, -1, -1, 
+			"The scratch buffer supplied to evaluator_run_scratch() must be aligned on %d bytes and be at least %d bytes long",
+				ARENA_ALIGNMENT, ( int ) eval_compute_scratch_size ( program ) ) ;
+		status	=  0 ;
+	    }
+	else
+		status	=  eval_compute ( program, & result, values, NULL, scratch ) ;
+
+	* output	=  ( double ) result ;
+
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluator_run_scratch ( const evaluator_program *  program, double *  output, const eval_double *  values, 
+				void *  scratch, size_t  scratch_size )
+   {
+	return ( evaluator_run_scratch_ctx ( NULL, program, output, values, scratch, scratch_size ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_run_batch -
+ *	Computes a program over the specified number of rows. columns [slot] must point to an array of rows
+ *	values for the variable having the specified slot ; results are stored in the output array, which
+ *	must also have rows entries.
+ *
+ *==============================================================================================================*/	
+int	evaluator_run_batch_ctx ( evaluator_context *  context, const evaluator_program *  program, int  rows, 
+				  const double **  columns, double *  output )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	void *			scratch ;
+	int			status ;
+	EVAL_STATS_DECLARE ( start )
+
+
+	if  ( rows  <=  0 )
+		return ( eval_leave ( previous, 1 ) ) ;
+
+	if  ( ! eval_check_columns ( program, ( const void ** ) columns ) )
+		return ( eval_leave ( previous, 0 ) ) ;
+
+	scratch		=  eval_malloc ( eval_batch_scratch_size ( program ) ) ;
+
+	if  ( scratch  ==  NULL )
+	   {
+		eval_error ( E_EVAL_OUT_OF_MEMORY, -1, -1, "Cannot allocate the scratch memory needed to compute a batch" ) ;
+		return ( eval_leave ( previous, 0 ) ) ;
+	    }
+
+	EVAL_STATS_START ( start ) ;
+	status		=  eval_batch_compute ( program, 0, rows, columns, output, scratch ) ;
+	EVAL_STATS_STOP ( EVAL_PHASE_COMPUTE, start, 1 ) ;
+	eval_free ( scratch ) ;
+
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluator_run_batch ( const evaluator_program *  program, int  rows, const double **  columns, double *  output )
+   {
+	return ( evaluator_run_batch_ctx ( NULL, program, rows, columns, output ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_run_batch_float -
+ *	Same as evaluator_run_batch(), for float columns. Computations are performed using floats.
+ *
+ *==============================================================================================================*/	
+int	evaluator_run_batch_float_ctx ( evaluator_context *  context, const evaluator_program *  program, int  rows, 
+					const float **  columns, float *  output )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	void *			scratch ;
+	int			status ;
+	EVAL_STATS_DECLARE ( start )
+
+
+	if  ( rows  <=  0 )
+		return ( eval_leave ( previous, 1 ) ) ;
+
+	if  ( ! eval_check_columns ( program, ( const void ** ) columns ) )
+		return ( eval_leave ( previous, 0 ) ) ;
+
+	scratch		=  eval_malloc ( eval_batch_scratch_size_float ( program ) ) ;
+
+	if  ( scratch  ==  NULL )
+	   {
+		eval_error ( E_EVAL_OUT_OF_MEMORY, -1, -1, "Cannot allocate the scratch memory needed to compute a batch" ) ;
+		return ( eval_leave ( previous, 0 ) ) ;
+	    }
+
+	EVAL_STATS_START ( start ) ;
+	status		=  eval_batch_compute_float ( program, 0, rows, columns, output, scratch ) ;
+	EVAL_STATS_STOP ( EVAL_PHASE_COMPUTE, start, 1 ) ;
+	eval_free ( scratch ) ;
+
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluator_run_batch_float ( const evaluator_program *  program, int  rows, const float **  columns, float *  output )
+   {
+	return ( evaluator_run_batch_float_ctx ( NULL, program, rows, columns, output ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_run_parallel -
+ *	Same as evaluator_run_batch(), but rows are computed by several threads. Functions called by the
+ *	expression must be thread-safe.
+ *
+ *==============================================================================================================*/	
+int	evaluator_run_parallel_ctx ( evaluator_context *  context, const evaluator_program *  program, int  rows, 
+				     const double **  columns, double *  output )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	int			status ;
+	EVAL_STATS_DECLARE ( start )
+
+
+	if  ( rows  <=  0 )
+		return ( eval_leave ( previous, 1 ) ) ;
+
+	if  ( ! eval_check_columns ( program, ( const void ** ) columns ) )
+		return ( eval_leave ( previous, 0 ) ) ;
+
+	EVAL_STATS_START ( start ) ;
+	status		=  eval_parallel_compute ( program, rows, columns, output ) ;
+	EVAL_STATS_STOP ( EVAL_PHASE_COMPUTE, start, 1 ) ;
+
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluator_run_parallel ( const evaluator_program *  program, int  rows, const double **  columns, double *  output )
+   {
+	return ( evaluator_run_parallel_ctx ( NULL, program, rows, columns, output ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_set_thread_count, evaluator_get_thread_count -
+ *	Sets/gets the number of threads used by evaluator_run_parallel(), including the calling thread.
+ *	A count of zero (the default) means one thread per processor. The pool is resized by the next call to
+ *	evaluator_run_parallel().
+ *
+ *==============================================================================================================*/	
+void	evaluator_set_thread_count ( int  count )
+   {
+	eval_mutex_lock ( & eval_pool. lock ) ;
+	eval_pool. requested_threads	=  ( count  <  0 ) ?  0 : count ;
+	eval_mutex_unlock ( & eval_pool. lock ) ;
+    }
+
+
+int	evaluator_get_thread_count ( )
+   {
+	int		count ;
+
+
+	eval_mutex_lock ( & eval_pool. lock ) ;
+	count	=  eval_pool. requested_threads ;
+	eval_mutex_unlock ( & eval_pool. lock ) ;
+
+	return ( ( count  >  0 ) ?  count : eval_processor_count ( ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_get_variable_count, evaluator_get_variable_name, evaluator_get_variable_slot -
+ *	Give access to the variable slots of a compiled program. Slots are numbered from 0 to 
+ *	evaluator_get_variable_count() - 1, in the order of first appearance in the expression.
+ *	Variable names are case-sensitive, as with callbacks.
+ *
+ *==============================================================================================================*/	
+int	evaluator_get_variable_count ( const evaluator_program *  program )
+   {
+	return ( program -> variable_count ) ;
+    }
+
+
+const char *	evaluator_get_variable_name ( const evaluator_program *  program, int  slot )
+   {
+	if  ( slot  <  0  ||  slot  >=  program -> variable_count )
+		return ( NULL ) ;
+
+	return ( program -> variables [ slot ] ) ;
+    }
+
+
+int	evaluator_get_variable_slot ( const evaluator_program *  program, const char *  name )
+   {
+	int		i ;
+
+
+	for  ( i = 0 ; i  <  program -> variable_count ; i ++ )
+	   {
+		if  ( ! strcmp ( program -> variables [i], name ) )
+			return ( i ) ;
+	    }
+
+	return ( -1 ) ;
+    }
+
+
+void	evaluator_free_program ( evaluator_program *  program )
+   {
+	eval_arena	arena ;
+
+
+	// Programs loaded from an image are freed together with the image
+	if  ( program  ==  NULL  ||  program -> image  !=  NULL )
+		return ;
+
+	eval_jit_free ( program ) ;
+
+	// The program structure is freed together with its arena
+	arena	=  program -> arena ;
+	eval_arena_release ( & arena ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_compile_set, evaluator_run_set, evaluator_run_set_bound, evaluator_free_set -
+ *	Expression sets : evaluator_compile_set() compiles count expressions into a single program, whose
+ *	common subexpressions are computed once even when they appear in different expressions. 
+ *	evaluator_run_set() stores the result of each expression into results [i], i being the index of the
+ *	expression in the array given to evaluator_compile_set(). Variables are shared by all the expressions
+ *	of a set ; evaluator_run_set() calls the callback once for each of them, whatever the number of 
+ *	expressions that reference it, and evaluator_run_set_bound() takes their values from an array indexed
+ *	by variable slot (see evaluator_get_set_variable_slot()).
+ *	Expression sets are always computed by the interpreter ; EVAL_COMPILE_JIT only implies
+ *	EVAL_COMPILE_DOUBLE.
+ *
+ *==============================================================================================================*/	
+static int	eval_compute_set ( const evaluator_expression_set *  set, double *  results, const eval_double *  values )
+   {
+	int			status ;
+# if	EVAL_LONG_DOUBLE
+	eval_arena		scratch ;
+	char			scratch_buffer [ ARENA_COMPUTE_BUFFER_SIZE ] ;
+	eval_double *		outputs ;
+	int			i ;
+
+
+	// Results are computed as eval_double values, then converted
+	eval_arena_initialize ( & scratch, scratch_buffer, sizeof ( scratch_buffer ) ) ;
+	outputs		=  ( eval_double * ) eval_arena_alloc ( & scratch, set -> count * sizeof ( eval_double ) ) ;
+	status		=  eval_compute ( set -> program, outputs, values, NULL, NULL ) ;
+
+	for  ( i = 0 ; i  <  set -> count  &&  status ; i ++ )
+		results [i]	=  ( double ) outputs [i] ;
+
+	eval_arena_release ( & scratch ) ;
+# else
+	status		=  eval_compute ( set -> program, results, values, NULL, NULL ) ;
+# endif
+
+	return ( status ) ;
+    }
+
+
+evaluator_expression_set *	evaluator_compile_set_ctx ( evaluator_context *  context, const char **  expressions, int  count, int  flags )
+   {
+	evaluator_context *		previous	=  eval_enter ( context ) ;
+	evaluator_program *		program ;
+	evaluator_expression_set *	set		=  NULL ;
+
+
+	if  ( count  <  1 )
+		eval_error ( E_EVAL_EMPTY_EXPRESSION, -1, -1, "An expression set must contain at least one expression" ) ;
+	else
+	   {
+		program		=  eval_compile ( expressions, count, 1, 1, flags ) ;
+
+		if  ( program  !=  NULL )
+		   {
+			set		=  ( evaluator_expression_set * ) eval_arena_alloc ( & program -> arena, sizeof ( evaluator_expression_set ) ) ;
+			set -> program	=  program ;
+			set -> count	=  count ;
+		    }
+	    }
+
+	eval_leave ( previous, 0 ) ;
+
+	return ( set ) ;
+    }
+
+
+evaluator_expression_set *	evaluator_compile_set ( const char **  expressions, int  count, int  flags )
+   {
+	return ( evaluator_compile_set_ctx ( NULL, expressions, count, flags ) ) ;
+    }
+
+
+int	evaluator_run_set_ctx ( evaluator_context *  context, const evaluator_expression_set *  set, double *  results, eval_callback  callback )
+   {
+	evaluator_context *		previous	=  eval_enter ( context ) ;
+	const evaluator_program *	program		=  set -> program ;
+	eval_arena			scratch ;
+	char				scratch_buffer [ ARENA_COMPUTE_BUFFER_SIZE ] ;
+	eval_double *			values ;
+	int				status		=  1 ;
+	int				i ;
+	EVAL_STATS_DECLARE ( start )
+
+
+	if  ( program -> variable_count  &&  callback  ==  NULL )
+	   {
+		eval_error ( E_EVAL_VARIABLES_NOT_ALLOWED, -1, -1, 
+			"Variable references are not allowed when no callback is supplied to evaluator_run_set()" ) ;
+
+		return ( eval_leave ( previous, 0 ) ) ;
+	    }
+
+	eval_arena_initialize ( & scratch, scratch_buffer, sizeof ( scratch_buffer ) ) ;
+	values	=  ( eval_double * ) eval_arena_alloc ( & scratch, ( program -> variable_count + 1 ) * sizeof ( eval_double ) ) ;
+
+	// Each variable is retrieved once, whatever the number of expressions referencing it
+	EVAL_STATS_START ( start ) ;
+
+	for  ( i = 0 ; i  <  program -> variable_count  &&  status ; i ++ )
+	   {
+		if  ( callback ( program -> variables [i], values + i )  ==  EVAL_CALLBACK_UNDEFINED )
+		   {
+			eval_error ( E_EVAL_UNDEFINED_VARIABLE, -1, -1, "Undefined variable '%s'", program -> variables [i] ) ;
+			status	=  0 ;
+		    }
+	    }
+
+	EVAL_STATS_STOP ( EVAL_PHASE_CALLBACK, start, i ) ;
+
+	if  ( status )
+		status	=  eval_compute_set ( set, results, values ) ;
+
+	eval_arena_release ( & scratch ) ;
+
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluator_run_set ( const evaluator_expression_set *  set, double *  results, eval_callback  callback )
+   {
+	return ( evaluator_run_set_ctx ( NULL, set, results, callback ) ) ;
+    }
+
+
+int	evaluator_run_set_bound_ctx ( evaluator_context *  context, const evaluator_expression_set *  set, double *  results, const eval_double *  values )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	int			status ;
+
+
+	if  ( set -> program -> variable_count  &&  values  ==  NULL )
+	   {
+		eval_error ( E_EVAL_VARIABLES_NOT_ALLOWED, -1, -1, 
+			"Variable references are not allowed when no values are supplied to evaluator_run_set_bound()" ) ;
+		status	=  0 ;
+	    }
+	else
+		status	=  eval_compute_set ( set, results, values ) ;
+
+	return ( eval_leave ( previous, status ) ) ;
+    }
+
+
+int	evaluator_run_set_bound ( const evaluator_expression_set *  set, double *  results, const eval_double *  values )
+   {
+	return ( evaluator_run_set_bound_ctx ( NULL, set, results, values ) ) ;
+    }
+
+
+void	evaluator_free_set ( evaluator_expression_set *  set )
+   {
+	// The set structure belongs to the arena of its program
+	if  ( set  !=  NULL )
+		evaluator_free_program ( set -> program ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_get_set_size, evaluator_get_set_variable_count, evaluator_get_set_variable_name,
+ *  evaluator_get_set_variable_slot -
+ *	Return the number of expressions of a set, and give access to the variable slots shared by its
+ *	expressions, as evaluator_get_variable_*() do for programs.
+ *
+ *==============================================================================================================*/	
+int	evaluator_get_set_size ( const evaluator_expression_set *  set )
+   {
+	return ( set -> count ) ;
+    }
+
+
+int	evaluator_get_set_variable_count ( const evaluator_expression_set *  set )
+   {
+	return ( evaluator_get_variable_count ( set -> program ) ) ;
+    }
+
+
+const char *	evaluator_get_set_variable_name ( const evaluator_expression_set *  set, int  slot )
+   {
+	return ( evaluator_get_variable_name ( set -> program, slot ) ) ;
+    }
+
+
+int	evaluator_get_set_variable_slot ( const evaluator_expression_set *  set, const char *  name )
+   {
+	return ( evaluator_get_variable_slot ( set -> program, name ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_create_incremental, evaluator_set_incremental_variable, evaluator_update_incremental,
+ *  evaluator_free_incremental -
+ *	Incremental evaluation of an expression set : evaluator_create_incremental() computes all the
+ *	expressions of the set using the variable values supplied as an array indexed by slot, and keeps the
+ *	value of every subexpression. evaluator_set_incremental_variable() then changes the value of a 
+ *	variable, and evaluator_update_incremental() only recomputes the subexpressions and expressions that
+ *	depend on the variables that changed, before storing the result of all the expressions into results.
+ *	When recomputed is not NULL, it receives the indexes of the expressions that have been recomputed,
+ *	and must have room for evaluator_get_set_size() entries ; evaluator_update_incremental() returns their
+ *	count.
+ *	An incremental evaluator references its expression set, which must not be freed before it.
+ *
+ *==============================================================================================================*/	
+evaluator_incremental *		evaluator_create_incremental_ctx ( evaluator_context *  context, const evaluator_expression_set *  set, const eval_double *  values )
+   {
+	evaluator_context *		previous	=  eval_enter ( context ) ;
+	evaluator_incremental *		incremental	=  NULL ;
+	EVAL_STATS_DECLARE ( start )
+
+
+	if  ( set -> program -> variable_count  &&  values  ==  NULL )
+		eval_error ( E_EVAL_VARIABLES_NOT_ALLOWED, -1, -1, 
+			"Variable references are not allowed when no values are supplied to evaluator_create_incremental()" ) ;
+	else
+	   {
+		EVAL_STATS_START ( start ) ;
+		incremental	=  eval_incremental_create ( set, values ) ;
+		EVAL_STATS_STOP ( EVAL_PHASE_COMPUTE, start, 1 ) ;
+	    }
+
+	eval_leave ( previous, 0 ) ;
+
+	return ( incremental ) ;
+    }
+
+
+evaluator_incremental *		evaluator_create_incremental ( const evaluator_expression_set *  set, const eval_double *  values )
+   {
+	return ( evaluator_create_incremental_ctx ( NULL, set, values ) ) ;
+    }
+
+
+int	evaluator_set_incremental_variable ( evaluator_incremental *  incremental, int  slot, eval_double  value )
+   {
+	if  ( slot  <  0  ||  slot  >=  incremental -> set -> program -> variable_count )
+		return ( 0 ) ;
+
+	eval_incremental_set_variable ( incremental, slot, value ) ;
+
+	return ( 1 ) ;
+    }
+
+
+int	evaluator_update_incremental_ctx ( evaluator_context *  context, evaluator_incremental *  incremental, double *  results, int *  recomputed )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	int			count ;
+	EVAL_STATS_DECLARE ( start )
+
+
+	EVAL_STATS_START ( start ) ;
+	count	=  eval_incremental_update ( incremental, results, recomputed ) ;
+	EVAL_STATS_STOP ( EVAL_PHASE_COMPUTE, start, 1 ) ;
+
+	eval_leave ( previous, 0 ) ;
+
+	return ( count ) ;
+    }
+
+
+int	evaluator_update_incremental ( evaluator_incremental *  incremental, double *  results, int *  recomputed )
+   {
+	return ( evaluator_update_incremental_ctx ( NULL, incremental, results, recomputed ) ) ;
+    }
+
+
+void	evaluator_free_incremental ( evaluator_incremental *  incremental )
+   {
+	eval_arena	arena ;
+
+
+	// The structure is freed together with its arena
+	if  ( incremental  !=  NULL )
+	   {
+		arena	=  incremental -> arena ;
+		eval_arena_release ( & arena ) ;
+	    }
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_save_programs, evaluator_load_programs -
+ *	evaluator_save_programs() writes compiled programs to an image file, which evaluator_load_programs()
+ *	maps in memory ; the programs of an image are run in place, without being parsed again. Programs are
+ *	retrieved by the index they had in the array given to evaluator_save_programs(), and are freed by
+ *	evaluator_free_image().
+ *
+ *==============================================================================================================*/	
+int	evaluator_save_programs_ctx ( evaluator_context *  context, const char *  filename, evaluator_program **  programs, int  count )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+
+
+	return ( eval_leave ( previous, eval_image_save ( filename, programs, count ) ) ) ;
+    }
+
+
+int	evaluator_save_programs ( const char *  filename, evaluator_program **  programs, int  count )
+   {
+	return ( evaluator_save_programs_ctx ( NULL, filename, programs, count ) ) ;
+    }
+
+
+evaluator_image *	evaluator_load_programs_ctx ( evaluator_context *  context, const char *  filename )
+   {
+	evaluator_context *	previous	=  eval_enter ( context ) ;
+	evaluator_image *	image ;
+
+
+	image	=  eval_image_load ( filename ) ;
+	eval_leave ( previous, 0 ) ;
+
+	return ( image ) ;
+    }
+
+
+evaluator_image *	evaluator_load_programs ( const char *  filename )
+   {
+	return ( evaluator_load_programs_ctx ( NULL, filename ) ) ;
+    }
+
+
+int	evaluator_get_image_program_count ( const evaluator_image *  image )
+   {
+	return ( image -> program_count ) ;
+    }
+
+
+const evaluator_program *	evaluator_get_image_program ( const evaluator_image *  image, int  index )
+   {
+	if  ( index  <  0  ||  index  >=  image -> program_count )
+		return ( NULL ) ;
+
+	return ( image -> programs + index ) ;
+    }
+
+
+void	evaluator_free_image ( evaluator_image *  image )
+   {
+	if  ( image  !=  NULL )
+		eval_image_free ( image ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_perror, evaluator_perror_ctx -
+ *	Prints the last expression evaluation error message.
+ *
+ *==============================================================================================================*/	
+static struct eval_error_code
+   {
+	char *		name ;
+	int		code ;
+    }  eval_error_codes []	=
+   {
+	{ "E_EVAL_OK"				, E_EVAL_OK				},
+	{ "E_EVAL_UNEXPECTED_CHARACTER"		, E_EVAL_UNEXPECTED_CHARACTER		},
+	{ "E_EVAL_INVALID_NUMBER"		, E_EVAL_INVALID_NUMBER			},
+	{ "E_EVAL_UNEXPECTED_TOKEN"		, E_EVAL_UNEXPECTED_TOKEN		},
+	{ "E_EVAL_UNEXPECTED_NUMBER"		, E_EVAL_UNEXPECTED_NUMBER		},
+	{ "E_EVAL_UNEXPECTED_OPERATOR"		, E_EVAL_UNEXPECTED_OPERATOR		},
+	{ "E_EVAL_STACK_EMPTY"			, E_EVAL_STACK_EMPTY			},
+	{ "E_EVAL_UNDEFINED_OPERATOR"		, E_EVAL_UNDEFINED_OPERATOR		},
+	{ "E_EVAL_UNDEFINED_TOKEN_TYPE"		, E_EVAL_UNDEFINED_TOKEN_TYPE		},
+	{ "E_EVAL_UNBALANCED_PARENTHESES"	, E_EVAL_UNBALANCED_PARENTHESES		},
+	{ "E_EVAL_UNEXPECTED_RIGHT_PARENT"	, E_EVAL_UNEXPECTED_RIGHT_PARENT	},
+	{ "E_EVAL_UNDEFINED_CONSTANT"		, E_EVAL_UNDEFINED_CONSTANT		},
+	{ "E_EVAL_UNEXPECTED_NAME"		, E_EVAL_UNEXPECTED_NAME		},
+	{ "E_EVAL_IMPLEMENTATION_ERROR"		, E_EVAL_IMPLEMENTATION_ERROR		},
+	{ "E_EVAL_INVALID_REGISTER_INDEX"	, E_EVAL_INVALID_REGISTER_INDEX		},
+	{ "E_EVAL_REGISTER_NOT_SET"		, E_EVAL_REGISTER_NOT_SET		},
+	{ "E_EVAL_UNDEFINED_FUNCTION"		, E_EVAL_UNDEFINED_FUNCTION		},
+	{ "E_EVAL_UNTERMINATED_FUNCTION_CALL"	, E_EVAL_UNTERMINATED_FUNCTION_CALL	},
+	{ "E_EVAL_TOO_MANY_NESTED_CALLS"	, E_EVAL_TOO_MANY_NESTED_CALLS		},
+	{ "E_EVAL_UNEXPECTED_ARG_SEPARATOR"	, E_EVAL_UNEXPECTED_ARG_SEPARATOR	},
+	{ "E_EVAL_INVALID_FUNCTION_ARGC"	, E_EVAL_INVALID_FUNCTION_ARGC		},
+	{ "E_EVAL_BAD_ARGUMENT_COUNT"		, E_EVAL_BAD_ARGUMENT_COUNT		},
+	{ "E_EVAL_UNDEFINED_VARIABLE"		, E_EVAL_UNDEFINED_VARIABLE		},
+	{ "E_EVAL_VARIABLES_NOT_ALLOWED"	, E_EVAL_VARIABLES_NOT_ALLOWED		},
+	{ "E_EVAL_UNEXPECTED_VARIABLE"		, E_EVAL_UNEXPECTED_VARIABLE		},
+	{ "E_EVAL_SCRATCH_TOO_SMALL"		, E_EVAL_SCRATCH_TOO_SMALL		},
+	{ "E_EVAL_INVALID_IMAGE"		, E_EVAL_INVALID_IMAGE			},
+	{ "E_EVAL_IO_ERROR"			, E_EVAL_IO_ERROR			},
+	{ "E_EVAL_EMPTY_EXPRESSION"		, E_EVAL_EMPTY_EXPRESSION		},
+	{ "E_EVAL_OUT_OF_MEMORY"		, E_EVAL_OUT_OF_MEMORY			},
+
+	{ NULL, 0 }
+    } ;
+
+static char *	eval_errnostr ( int  err ) 
+   {
+	static char			buffer [ 64 ] ;
+	struct eval_error_code *	p	=  eval_error_codes ;
+
+
+	while  ( p -> name  !=  NULL )
+	   {
+		if  ( p -> code  ==  err )
+			return ( p -> name ) ;
+
+		p ++ ;
+	    }
+
+	sprintf ( buffer, "errno = %d", err ) ;
+	return ( buffer ) ;
+    }
+
+
+void  evaluator_perror ( )
+   {
+	if  ( evaluator_errno )
+		fprintf ( stderr, "%s (%s) \n", evaluator_error, eval_errnostr ( evaluator_errno ) ) ;
+    }
+
+
+void  evaluator_perror_ctx ( const evaluator_context *  context )
+   {
+	if  ( context  ==  NULL )
+		context		=  & eval_default_context ;
+
+	if  ( context -> error_number )
+		fprintf ( stderr, "%s (%s) \n", context -> error_message, eval_errnostr ( context -> error_number ) ) ;
+    }
+
+
+/*==============================================================================================================
+ *
+ *  evaluator_register_constants, evaluator_register_functions -
+ *	Register new constants and functions. Cached programs are discarded, since they hold the values and
+ *	addresses of the constants and functions that were defined when they were compiled.
+ *
+ *==============================================================================================================*/
+void  evaluator_register_constants ( const evaluator_constant_definition *	newdefs )
+   {
+	eval_register ( & eval_constant_definitions, newdefs ) ;
+	eval_cache_flush ( -1 ) ;
+    }
+
+void  evaluator_register_functions ( const evaluator_function_definition *	newdefs )
+   {
+	eval_register ( & eval_function_definitions, newdefs ) ;
+	eval_cache_flush ( -1 ) ;
+    }
+
+
+const evaluator_constant_definition *	evaluator_get_registered_constants  ( )
+   {
+	return ( ( evaluator_constant_definition * ) eval_constant_definitions. data ) ;
+    }
+
+
+const evaluator_function_definition *	evaluator_get_registered_functions  ( )
+   {
+	return ( ( evaluator_function_definition * ) eval_function_definitions. data ) ;
     }
\ No newline at end of file
@@ -1,210 +1,555 @@
-/**************************************************************************************************************
-
-    NAME
-        eval.h
-
-    DESCRIPTION
-        Header file for the evaluate() function.
-
-    AUTHOR
-        Christian Vigh, 09/2015.
-
-    HISTORY
-    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
-        Initial version.
-
- **************************************************************************************************************/
-
-# ifndef	__EVAL_H__
-#	define	__EVAL_H__
-
-// Inclusion of <limits.h> is EXTREMELY important because it redefines structure alignment !
-// Without it, the evaluator_constant_definition structure is 16 bytes long, while it takes 32 bytes after 
-// <limits.h> has been included.
-// If you use the evaluator package in, say, file main.c, which do not include <limits.h>, then main.c will
-// see the evaluator_constant_definition structure as 16-bytes long, while eval.c will see it as 32-bytes long...
-// This behavior has been found with GNU C.
-# include	<limits.h>
-
-
-/*==============================================================================================================
- *
- *  Limits.
- *
- *==============================================================================================================*/
-# ifdef		LLONG_MIN
-
-typedef		long long int		eval_int ;
-typedef		long double		eval_double ;
-
-#	define	EVAL_INTMIN		( ( eval_double ) LLONG_MIN )
-#	define	EVAL_INTMAX		( ( eval_double ) LLONG_MAX )
-#	define	EVAL_UINTMAX		( ( eval_double ) ULLONG_MAX )
-#	define  EVAL_FLOATMIN		( ( eval_double ) LDBL_MIN )
-#	define  EVAL_FLOATMAX		( ( eval_double ) LDBL_MAX )
-
-# else
-
-typedef		long int		eval_int ;
-typedef		double			eval_double ;
-
-#	define	EVAL_INTMIN		( ( eval_double ) INT_MIN )
-#	define	EVAL_INTMAX		( ( eval_double ) INT_MAX )
-#	define	EVAL_UINTMAX		( ( eval_double ) UINT_MAX )
-#	define  EVAL_FLOATMIN		( ( eval_double ) DBL_MIN )
-#	define  EVAL_FLOATMAX		( ( eval_double ) DBL_MAX )
-
-# endif
-
-
-/*==============================================================================================================
- *
- *  Platform-specific defines.
- *
- *==============================================================================================================*/
-# ifdef		WIN32
-#	define	strcasecompare(a,b)		_stricmp ( a, b )
-# else
-#	include <strings.h>
-#	define	strcasecompare(a,b)		strcasecmp ( a, b )
-# endif
-
-
-
-/*==============================================================================================================
-
-	Constant definition structures.
-
-  ==============================================================================================================*/
-# define	EVAL_NULL_CONSTANT		{ NULL, 0 }
-# define	EVAL_CONSTANT_DEF( var )	evaluator_constant_definition  var [] = {
-# define	EVAL_CONSTANT( name, value )	{ name, value },
-# define	EVAL_CONSTANT_END		EVAL_NULL_CONSTANT }
-
-typedef struct  evaluator_constant_definition
-   {
-	char *		name ;			// Constant name
-	eval_double	value ;			// Constant value
-    }  evaluator_constant_definition ;
-
-
-/*==============================================================================================================
-
-	Function definition macros, types & structures.
-
-  ==============================================================================================================*/
-# define	EVAL_NULL_FUNCTION		{ NULL, 0, 0, NULL }
-# define	EVAL_FUNCTION_NAME(func)	eval_primitive_##func
-# define	EVAL_PRIMITIVE(func)		static eval_double  EVAL_FUNCTION_NAME ( func ) ( int  argc, eval_double *  argv )
-
-# define	EVAL_FUNCTION_DEF( var )	evaluator_function_definition  var [] = {
-# define	EVAL_FUNCTION( name, minargs, maxargs, func )	\
-						{ name, minargs, maxargs, EVAL_FUNCTION_NAME ( func ) },
-# define	EVAL_FUNCTION_END		{ NULL, 0, 0, NULL } }
-
-
-typedef eval_double	( * eval_function ) ( int  argc, eval_double *  argv ) ;
-
-
-typedef struct  evaluator_function_definition
-   {
-	char *		name ;			// Function name
-	int		min_args ;		// Min arguments
-	int		max_args ;		// Max arguments
-	eval_function	func ;			// Pointer to function
-    }  evaluator_function_definition ;
-
-
-/*==============================================================================================================
-
-	Definitions for evaluator callbacks.
-
-  ==============================================================================================================*/
-
-// Status constants that can be returned by an eval_callback
-# define	EVAL_CALLBACK_OK		0			// Variable exists
-# define	EVAL_CALLBACK_UNDEFINED		-1			// Undefined variable
-
-// Declares a callback function
-# define	EVAL_CALLBACK( func )		func ( char *  vname, eval_double *  value )
-
-typedef int		( * eval_callback ) ( char *  vname, eval_double *  value ) ;
-
-
-/*==============================================================================================================
-
-	Macros & constants.
-
-  ==============================================================================================================*/
-
-// Error information
-extern int	evaluator_errno ;		
-extern char 	evaluator_error [] ;
-
-// Error codes
-# define	E_EVAL_OK					0
-# define	E_EVAL_UNEXPECTED_CHARACTER			-1		// An unexpected character has been found
-# define	E_EVAL_INVALID_NUMBER				-2		// Invalid number specified
-# define	E_EVAL_UNEXPECTED_TOKEN				-3		// A valid token has been encountered in an invalid place
-# define	E_EVAL_UNEXPECTED_NUMBER			-4		// A valid number has been encountered in an invalid place
-# define	E_EVAL_UNEXPECTED_OPERATOR			-5		// A valid operator has been encountered in an invalid place
-# define	E_EVAL_STACK_EMPTY				-6		// Internal error : stack has not enough arguments to apply the next operator
-# define	E_EVAL_UNDEFINED_OPERATOR			-7		// Internal error : an undefined operator has been found (this means that a new operator has been
-										// added, but the eval_compute() function has not been modified to process it)
-# define	E_EVAL_UNDEFINED_TOKEN_TYPE			-8		// Internal error : an undefined token type has been found (this means that a new token type has been
-										// added, but the eval_compute() function has not been modified to process it)
-# define	E_EVAL_UNBALANCED_PARENTHESES			-9		// Unbalanced parentheses
-# define	E_EVAL_UNEXPECTED_RIGHT_PARENT			-10		// Unmatched closing parenthesis
-# define	E_EVAL_UNDEFINED_CONSTANT			-11		// Undefined constant
-# define	E_EVAL_UNEXPECTED_NAME				-12		// Unexpected constant
-# define	E_EVAL_IMPLEMENTATION_ERROR			-13		// Implementation caused inconsistent result
-# define	E_EVAL_INVALID_REGISTER_INDEX			-14		// Register index out of range
-# define	E_EVAL_REGISTER_NOT_SET				-15		// No value has been assigned to the specified register
-# define	E_EVAL_UNDEFINED_FUNCTION			-16		// Undefined function
-# define	E_EVAL_UNTERMINATED_FUNCTION_CALL		-17		// Function call with unbalanced parentheses
-# define	E_EVAL_TOO_MANY_NESTED_CALLS			-18		// Too many nested function calls
-# define	E_EVAL_UNEXPECTED_ARG_SEPARATOR			-19		// Argument separator in the wrong place
-# define	E_EVAL_INVALID_FUNCTION_ARGC			-20		// Invalid number of arguments specified during a function call
-# define	E_EVAL_BAD_ARGUMENT_COUNT			-21		// Not enough or too much arguments remain on stack to process function call
-# define	E_EVAL_UNDEFINED_VARIABLE			-22		// Undefined variable
-# define	E_EVAL_VARIABLES_NOT_ALLOWED			-23		// Variables are not allowed when calling the evaluate() function
-# define	E_EVAL_UNEXPECTED_VARIABLE			-24		// Variable reference has been found in an incorrect place
-
-
-/*==============================================================================================================
- *
- *  Declarations for debug mode.
- *
- *==============================================================================================================*/
-# if	EVAL_DEBUG
-extern void	eval_dump_constants ( ) ;
-extern void	eval_dump_functions ( ) ;
-# endif
-
-
-
-
-/*==============================================================================================================
-
-        Function prototypes.
-
-  ==============================================================================================================*/
-
-extern int					evaluator_use_degrees ;
-
-extern int					evaluate				( const char *				expression,
-											  double *				result ) ;
-
-extern int					evaluate_ex				( const char *				expression,
-											  double *				result,
-											  eval_callback				callback ) ;
-
-extern void					evaluator_perror			( ) ;
-
-extern void 					evaluator_register_constants		( const evaluator_constant_definition *	definitions ) ;
-extern void 					evaluator_register_functions		( const evaluator_function_definition *	definitions ) ;
-
-extern const evaluator_constant_definition *	evaluator_get_registered_constants	( ) ;
-extern const evaluator_function_definition *	evaluator_get_registered_functions	( ) ;
-
+/**************************************************************************************************************
+
+    NAME
+        eval.h
+
+    DESCRIPTION
+        Header file for the evaluate() function.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+# ifndef	__EVAL_H__
+#	define	__EVAL_H__
+
+// Inclusion of <limits.h> is EXTREMELY important because it redefines structure alignment !
+// Without it, the evaluator_constant_definition structure is 16 bytes long, while it takes 32 bytes after 
+// <limits.h> has been included.
+// If you use the evaluator package in, say, file main.c, which do not include <limits.h>, then main.c will
+// see the evaluator_constant_definition structure as 16-bytes long, while eval.c will see it as 32-bytes long...
+// This behavior has been found with GNU C.
+# include	<limits.h>
+
+// For size_t, used by the scratch buffer functions
+# include	<stddef.h>
+
+
+/*==============================================================================================================
+ *
+ *  Limits.
+ *
+ *==============================================================================================================*/
+# ifdef		LLONG_MIN
+
+typedef		long long int		eval_int ;
+
+#	define	EVAL_INTMIN		( ( eval_double ) LLONG_MIN )
+#	define	EVAL_INTMAX		( ( eval_double ) LLONG_MAX )
+#	define	EVAL_UINTMAX		( ( eval_double ) ULLONG_MAX )
+
+# else
+
+typedef		long int		eval_int ;
+
+#	define	EVAL_INTMIN		( ( eval_double ) INT_MIN )
+#	define	EVAL_INTMAX		( ( eval_double ) INT_MAX )
+#	define	EVAL_UINTMAX		( ( eval_double ) UINT_MAX )
+
+# endif
+
+// eval_double is a long double when available, unless EVAL_USE_DOUBLE is defined ; in this case, it must be
+// defined for eval.c and for every file including eval.h
+# if	defined ( LLONG_MIN )  &&  ! defined ( EVAL_USE_DOUBLE )
+
+typedef		long double		eval_double ;
+
+#	define	EVAL_LONG_DOUBLE	1
+#	define  EVAL_FLOATMIN		( ( eval_double ) LDBL_MIN )
+#	define  EVAL_FLOATMAX		( ( eval_double ) LDBL_MAX )
+
+# else
+
+typedef		double			eval_double ;
+
+#	define	EVAL_LONG_DOUBLE	0
+#	define  EVAL_FLOATMIN		( ( eval_double ) DBL_MIN )
+#	define  EVAL_FLOATMAX		( ( eval_double ) DBL_MAX )
+
+# endif
+
+
+/*==============================================================================================================
+ *
+ *  Platform-specific defines.
+ *
+ *==============================================================================================================*/
+# ifdef		WIN32
+#	define	strcasecompare(a,b)		_stricmp ( a, b )
+# else
+#	include <strings.h>
+#	define	strcasecompare(a,b)		strcasecmp ( a, b )
+# endif
+
+// Storage class for per-thread variables
+# ifdef		_MSC_VER
+#	define	EVAL_THREAD_LOCAL		__declspec ( thread )
+# else
+#	define	EVAL_THREAD_LOCAL		__thread
+# endif
+
+
+
+/*==============================================================================================================
+
+	Constant definition structures.
+
+  ==============================================================================================================*/
+# define	EVAL_NULL_CONSTANT		{ NULL, 0 }
+# define	EVAL_CONSTANT_DEF( var )	evaluator_constant_definition  var [] = {
+# define	EVAL_CONSTANT( name, value )	{ name, value },
+# define	EVAL_CONSTANT_END		EVAL_NULL_CONSTANT }
+
+typedef struct  evaluator_constant_definition
+   {
+	char *		name ;			// Constant name
+	eval_double	value ;			// Constant value
+    }  evaluator_constant_definition ;
+
+
+/*==============================================================================================================
+
+	Function definition macros, types & structures.
+	Functions defined with EVAL_FUNCTION() have no flags : they are never computed at compile time nor
+	shared between identical subexpressions, and can be called by several threads at the same time.
+	EVAL_FUNCTION_EX() also specifies a combination of EVAL_FUNCTION_* flags and a cost hint. A function
+	can be called by several threads at the same time when it has no flags, when it is declared with
+	EVAL_FUNCTION_THREAD_SAFE, or when it is pure (EVAL_FUNCTION_PURE without EVAL_FUNCTION_VOLATILE) ; a
+	volatile function must include EVAL_FUNCTION_THREAD_SAFE to be called by several threads.
+	EVAL_FUNCTION_VECTOR() additionally registers the vector form of the primitive, declared with
+	EVAL_VECTOR_PRIMITIVE() under the same name : batch evaluation calls it once per block of rows instead
+	of calling the scalar form once per row. The scalar form is still used by the other evaluation modes,
+	and both forms must return the same results.
+
+  ==============================================================================================================*/
+# define	EVAL_NULL_FUNCTION		{ NULL, 0, 0, NULL, 0, 0, NULL }
+# define	EVAL_FUNCTION_NAME(func)	eval_primitive_##func
+# define	EVAL_PRIMITIVE(func)		static eval_double  EVAL_FUNCTION_NAME ( func ) ( int  argc, eval_double *  argv )
+# define	EVAL_VECTOR_FUNCTION_NAME(func)	eval_vector_primitive_##func
+# define	EVAL_VECTOR_PRIMITIVE(func)	static void  EVAL_VECTOR_FUNCTION_NAME ( func ) ( int  argc, int  rows, const double **  argv, double *  result )
+
+# define	EVAL_FUNCTION_DEF( var )	evaluator_function_definition  var [] = {
+# define	EVAL_FUNCTION( name, minargs, maxargs, func )	\
+						{ name, minargs, maxargs, EVAL_FUNCTION_NAME ( func ), 0, 0, NULL },
+# define	EVAL_FUNCTION_EX( name, minargs, maxargs, func, flags, cost )	\
+						{ name, minargs, maxargs, EVAL_FUNCTION_NAME ( func ), flags, cost, NULL },
+# define	EVAL_FUNCTION_VECTOR( name, minargs, maxargs, func, flags, cost )	\
+						{ name, minargs, maxargs, EVAL_FUNCTION_NAME ( func ), flags, cost, EVAL_VECTOR_FUNCTION_NAME ( func ) },
+# define	EVAL_FUNCTION_END		EVAL_NULL_FUNCTION }
+
+// Function flags
+# define	EVAL_FUNCTION_PURE		0x0001		// Same arguments always give the same result, without side effects ; implies EVAL_FUNCTION_THREAD_SAFE
+# define	EVAL_FUNCTION_VOLATILE		0x0002		// Result may change between calls with the same arguments ; overrides EVAL_FUNCTION_PURE
+# define	EVAL_FUNCTION_THREAD_SAFE	0x0004		// Can be called by several threads at the same time
+# define	EVAL_FUNCTION_ANGLE		0x0008		// Result depends on the trigonometric units of the evaluating context
+
+
+typedef eval_double	( * eval_function ) ( int  argc, eval_double *  argv ) ;
+
+// Vector form : argv [k] holds the rows values of argument #k, and result receives one value per row.
+// result may be the same array as argv [0], so all the arguments of a row must be read before its result
+// is written
+typedef void		( * eval_vector_function ) ( int  argc, int  rows, const double **  argv, double *  result ) ;
+
+
+typedef struct  evaluator_function_definition
+   {
+	char *		name ;			// Function name
+	int		min_args ;		// Min arguments
+	int		max_args ;		// Max arguments
+	eval_function	func ;			// Pointer to function
+	int		flags ;			// EVAL_FUNCTION_* flags
+	int		cost ;			// Relative cost of a call, an arithmetic operator costing 1 ; 0 if unknown
+	eval_vector_function  vfunc ;		// Vector form of the function, or NULL
+    }  evaluator_function_definition ;
+
+
+/*==============================================================================================================
+
+	Definitions for evaluator callbacks.
+
+  ==============================================================================================================*/
+
+// Status constants that can be returned by an eval_callback
+# define	EVAL_CALLBACK_OK		0			// Variable exists
+# define	EVAL_CALLBACK_UNDEFINED		-1			// Undefined variable
+
+// Declares a callback function
+# define	EVAL_CALLBACK( func )		func ( char *  vname, eval_double *  value )
+
+typedef int		( * eval_callback ) ( char *  vname, eval_double *  value ) ;
+
+
+/*==============================================================================================================
+
+	Compiled programs.
+	An expression compiled by evaluator_compile() can be run any number of times by evaluator_run() without
+	being parsed again. The structure contents are private to eval.c.
+
+  ==============================================================================================================*/
+typedef struct evaluator_program	evaluator_program ;
+
+// A set of programs loaded by evaluator_load_programs()
+typedef struct evaluator_image		evaluator_image ;
+
+// Expressions compiled together by evaluator_compile_set(), whose results are computed in a single pass
+typedef struct evaluator_expression_set	evaluator_expression_set ;
+
+// Incremental evaluator of an expression set, created by evaluator_create_incremental()
+typedef struct evaluator_incremental	evaluator_incremental ;
+
+// Flags for evaluator_compile_ex()
+# define	EVAL_COMPILE_DEFAULT		0x0000			// Compute using eval_double values
+# define	EVAL_COMPILE_DOUBLE		0x0001			// Compute using doubles, which is faster than long doubles
+# define	EVAL_COMPILE_JIT		0x0002			// Generate native code ; implies EVAL_COMPILE_DOUBLE
+
+
+/*==============================================================================================================
+
+	Program cache.
+	Programs compiled by evaluate() and evaluate_ex() are kept in a cache, so that evaluating the same
+	expression again does not require parsing it.
+
+  ==============================================================================================================*/
+typedef struct  evaluator_cache_statistics
+   {
+	unsigned long		hits ;				// Expressions found in the cache
+	unsigned long		misses ;			// Expressions that had to be compiled
+	unsigned long		evictions ;			// Programs removed from the cache to make room for new ones
+	int			count ;				// Current number of cached programs
+	int			size ;				// Maximum number of cached programs
+    }  evaluator_cache_statistics ;
+
+
+/*==============================================================================================================
+
+	Evaluator contexts.
+	A context holds the error information and options of the evaluations that are performed through it.
+	Functions taking a context as their first parameter can be called concurrently by several threads, as 
+	long as each thread uses its own context ; a NULL context designates the default context of the calling
+	thread, which is also the one used by functions that do not take a context parameter.
+	The structure contents are private to eval.c.
+
+  ==============================================================================================================*/
+typedef struct evaluator_context	evaluator_context ;
+
+
+/*==============================================================================================================
+
+	Phase statistics.
+	When eval.c is compiled with EVAL_INSTRUMENTATION set to a non-zero value, each context measures the
+	time spent in the following phases. A phase includes the phases it calls : parsing includes lexing,
+	and computing includes variable callbacks and function calls.
+	Durations are also counted in a histogram : bucket 0 counts durations of 0ns, and bucket i counts
+	durations between 2^(i-1) and 2^i - 1 nanoseconds, the last bucket also counting longer durations.
+
+  ==============================================================================================================*/
+# define	EVAL_PHASE_LEX			0			// Extraction of one token by eval_lex()
+# define	EVAL_PHASE_PARSE		1			// Parsing of one expression
+# define	EVAL_PHASE_OPTIMIZE		2			// Linking, optimizing and assembling one expression, then generating native code
+# define	EVAL_PHASE_COMPUTE		3			// One call to evaluate() or to an evaluator_run*() function
+# define	EVAL_PHASE_CALLBACK		4			// One call to a variable callback
+# define	EVAL_PHASE_FUNCTION		5			// One function call, not measured for native code
+# define	EVAL_PHASE_COUNT		6
+
+# define	EVAL_HISTOGRAM_BUCKETS		40
+
+typedef struct  evaluator_phase_statistics
+   {
+	unsigned long long	count		[ EVAL_PHASE_COUNT ] ;				// Number of measures
+	unsigned long long	nanoseconds	[ EVAL_PHASE_COUNT ] ;				// Total time
+	unsigned long long	histogram	[ EVAL_PHASE_COUNT ] [ EVAL_HISTOGRAM_BUCKETS ] ;	// Measures by duration
+    }  evaluator_phase_statistics ;
+
+
+/*==============================================================================================================
+
+	Function and operator profile, collected when the package is compiled with EVAL_PROFILER.
+	argc [i] counts the calls with i arguments ; the last bucket counts calls with EVAL_PROFILE_ARGC_BUCKETS-1
+	arguments or more.
+
+  ==============================================================================================================*/
+# define	EVAL_PROFILE_ARGC_BUCKETS	17
+
+typedef struct  evaluator_profile_entry
+   {
+	const char *		name ;						// Function name or operator symbol
+	unsigned long long	calls ;						// Number of calls
+	unsigned long long	nanoseconds ;					// Total time, not including measurement overhead
+	unsigned long long	argc		[ EVAL_PROFILE_ARGC_BUCKETS ] ;	// Calls by number of arguments
+    }  evaluator_profile_entry ;
+
+
+/*==============================================================================================================
+
+	Macros & constants.
+
+  ==============================================================================================================*/
+
+// Error information, set by the functions that use the default context of the calling thread
+extern EVAL_THREAD_LOCAL int	evaluator_errno ;		
+extern EVAL_THREAD_LOCAL char 	evaluator_error [] ;
+
+// Error codes
+# define	E_EVAL_OK					0
+# define	E_EVAL_UNEXPECTED_CHARACTER			-1		// An unexpected character has been found
+# define	E_EVAL_INVALID_NUMBER				-2		// Invalid number specified
+# define	E_EVAL_UNEXPECTED_TOKEN				-3		// A valid token has been encountered in an invalid place
+# define	E_EVAL_UNEXPECTED_NUMBER			-4		// A valid number has been encountered in an invalid place
+# define	E_EVAL_UNEXPECTED_OPERATOR			-5		// A valid operator has been encountered in an invalid place
+# define	E_EVAL_STACK_EMPTY				-6		// Internal error : stack has not enough arguments to apply the next operator
+# define	E_EVAL_UNDEFINED_OPERATOR			-7		// Internal error : an undefined operator has been found (this means that a new operator has been
+										// added, but the eval_compute() function has not been modified to process it)
+# define	E_EVAL_UNDEFINED_TOKEN_TYPE			-8		// Internal error : an undefined token type has been found (this means that a new token type has been
+										// added, but the eval_compute() function has not been modified to process it)
+# define	E_EVAL_UNBALANCED_PARENTHESES			-9		// Unbalanced parentheses
+# define	E_EVAL_UNEXPECTED_RIGHT_PARENT			-10		// Unmatched closing parenthesis
+# define	E_EVAL_UNDEFINED_CONSTANT			-11		// Undefined constant
+# define	E_EVAL_UNEXPECTED_NAME				-12		// Unexpected constant
+# define	E_EVAL_IMPLEMENTATION_ERROR			-13		// Implementation caused inconsistent result
+# define	E_EVAL_INVALID_REGISTER_INDEX			-14		// Register index out of range
+# define	E_EVAL_REGISTER_NOT_SET				-15		// No value has been assigned to the specified register
+# define	E_EVAL_UNDEFINED_FUNCTION			-16		// Undefined function
+# define	E_EVAL_UNTERMINATED_FUNCTION_CALL		-17		// Function call with unbalanced parentheses
+# define	E_EVAL_TOO_MANY_NESTED_CALLS			-18		// Too many nested function calls
+# define	E_EVAL_UNEXPECTED_ARG_SEPARATOR			-19		// Argument separator in the wrong place
+# define	E_EVAL_INVALID_FUNCTION_ARGC			-20		// Invalid number of arguments specified during a function call
+# define	E_EVAL_BAD_ARGUMENT_COUNT			-21		// Not enough or too much arguments remain on stack to process function call
+# define	E_EVAL_UNDEFINED_VARIABLE			-22		// Undefined variable
+# define	E_EVAL_VARIABLES_NOT_ALLOWED			-23		// Variables are not allowed when calling the evaluate() function
+# define	E_EVAL_UNEXPECTED_VARIABLE			-24		// Variable reference has been found in an incorrect place
+# define	E_EVAL_SCRATCH_TOO_SMALL			-25		// Scratch buffer supplied to evaluator_run_scratch() is too small or misaligned
+# define	E_EVAL_INVALID_IMAGE				-26		// File is not a program image, is corrupted or has been written by an incompatible version
+# define	E_EVAL_IO_ERROR					-27		// A program image file could not be read or written
+# define	E_EVAL_EMPTY_EXPRESSION				-28		// An expression set is empty or contains an empty expression
+# define	E_EVAL_OUT_OF_MEMORY				-29		// Memory needed to compute a batch of rows could not be allocated
+
+
+/*==============================================================================================================
+ *
+ *  Declarations for debug mode.
+ *
+ *==============================================================================================================*/
+# if	EVAL_DEBUG
+extern void	eval_dump_constants ( ) ;
+extern void	eval_dump_functions ( ) ;
+# endif
+
+
+
+
+/*==============================================================================================================
+
+        Function prototypes.
+
+  ==============================================================================================================*/
+
+extern EVAL_THREAD_LOCAL int			evaluator_use_degrees ;
+
+extern int					evaluate				( const char *				expression,
+											  double *				result ) ;
+
+extern int					evaluate_ex				( const char *				expression,
+											  double *				result,
+											  eval_callback				callback ) ;
+
+extern evaluator_program *			evaluator_compile			( const char *				expression ) ;
+
+extern evaluator_program *			evaluator_compile_ex			( const char *				expression,
+												  int					flags ) ;
+
+extern int					evaluator_run				( const evaluator_program *		program,
+											  double *				result,
+											  eval_callback				callback ) ;
+
+extern int					evaluator_run_bound			( const evaluator_program *		program,
+											  double *				result,
+											  const eval_double *			values ) ;
+
+extern size_t					evaluator_get_scratch_size		( const evaluator_program *		program ) ;
+
+extern int					evaluator_run_scratch			( const evaluator_program *		program,
+											  double *				result,
+											  const eval_double *			values,
+											  void *				scratch,
+											  size_t				scratch_size ) ;
+
+extern int					evaluator_run_batch			( const evaluator_program *		program,
+											  int					rows,
+											  const double **			columns,
+											  double *				output ) ;
+
+extern int					evaluator_run_batch_float		( const evaluator_program *		program,
+												  int					rows,
+												  const float **			columns,
+												  float *				output ) ;
+
+extern int					evaluator_run_parallel			( const evaluator_program *		program,
+												  int					rows,
+												  const double **			columns,
+												  double *				output ) ;
+
+extern void					evaluator_set_thread_count		( int					count ) ;
+extern int					evaluator_get_thread_count		( ) ;
+
+extern void					evaluator_free_program			( evaluator_program *			program ) ;
+
+extern int					evaluator_save_programs			( const char *				filename,
+											  evaluator_program **			programs,
+											  int					count ) ;
+extern evaluator_image *			evaluator_load_programs			( const char *				filename ) ;
+extern int					evaluator_get_image_program_count	( const evaluator_image *		image ) ;
+extern const evaluator_program *		evaluator_get_image_program		( const evaluator_image *		image,
+											  int					index ) ;
+extern void					evaluator_free_image			( evaluator_image *			image ) ;
+
+extern void					evaluator_set_cache_size		( int					size ) ;
+extern void					evaluator_flush_cache			( ) ;
+extern void					evaluator_get_cache_statistics		( evaluator_cache_statistics *		statistics ) ;
+
+extern int					evaluator_get_variable_count		( const evaluator_program *		program ) ;
+extern const char *				evaluator_get_variable_name		( const evaluator_program *		program,
+											  int					slot ) ;
+extern int					evaluator_get_variable_slot		( const evaluator_program *		program,
+											  const char *				name ) ;
+
+extern evaluator_expression_set *		evaluator_compile_set			( const char **				expressions,
+											  int					count,
+											  int					flags ) ;
+extern int					evaluator_run_set			( const evaluator_expression_set *	set,
+											  double *				results,
+											  eval_callback				callback ) ;
+extern int					evaluator_run_set_bound			( const evaluator_expression_set *	set,
+											  double *				results,
+											  const eval_double *			values ) ;
+extern void					evaluator_free_set			( evaluator_expression_set *		set ) ;
+extern int					evaluator_get_set_size			( const evaluator_expression_set *	set ) ;
+extern int					evaluator_get_set_variable_count	( const evaluator_expression_set *	set ) ;
+extern const char *				evaluator_get_set_variable_name		( const evaluator_expression_set *	set,
+											  int					slot ) ;
+extern int					evaluator_get_set_variable_slot		( const evaluator_expression_set *	set,
+											  const char *				name ) ;
+
+extern evaluator_incremental *			evaluator_create_incremental		( const evaluator_expression_set *	set,
+											  const eval_double *			values ) ;
+extern int					evaluator_set_incremental_variable	( evaluator_incremental *		incremental,
+											  int					slot,
+											  eval_double				value ) ;
+extern int					evaluator_update_incremental		( evaluator_incremental *		incremental,
+											  double *				results,
+											  int *					recomputed ) ;
+extern void					evaluator_free_incremental		( evaluator_incremental *		incremental ) ;
+
+extern void					evaluator_perror			( ) ;
+
+extern evaluator_context *			evaluator_create_context		( ) ;
+extern void					evaluator_free_context			( evaluator_context *			context ) ;
+extern int					evaluator_get_context_errno		( const evaluator_context *		context ) ;
+extern const char *				evaluator_get_context_error		( const evaluator_context *		context ) ;
+extern int					evaluator_get_context_statistics	( const evaluator_context *		context,
+												  evaluator_phase_statistics *		statistics ) ;
+extern void					evaluator_reset_context_statistics	( evaluator_context *			context ) ;
+extern int					evaluator_get_context_function_profile	( const evaluator_context *		context,
+												  evaluator_profile_entry *		entries,
+												  int					max_entries ) ;
+extern int					evaluator_get_context_operator_profile	( const evaluator_context *		context,
+												  evaluator_profile_entry *		entries,
+												  int					max_entries ) ;
+extern void					evaluator_reset_context_profile		( evaluator_context *			context ) ;
+extern int					evaluator_get_context_degrees		( const evaluator_context *		context ) ;
+extern void					evaluator_set_context_degrees		( evaluator_context *			context,
+												  int					use_degrees ) ;
+
+extern int					evaluate_ctx				( evaluator_context *			context,
+												  const char *				expression,
+												  double *				result,
+												  eval_callback				callback ) ;
+
+extern evaluator_program *			evaluator_compile_ctx			( evaluator_context *			context,
+												  const char *				expression ) ;
+
+extern evaluator_program *			evaluator_compile_ex_ctx		( evaluator_context *			context,
+												  const char *				expression,
+												  int					flags ) ;
+
+extern int					evaluator_run_ctx			( evaluator_context *			context,
+												  const evaluator_program *		program,
+												  double *				result,
+												  eval_callback				callback ) ;
+
+extern int					evaluator_run_bound_ctx			( evaluator_context *			context,
+												  const evaluator_program *		program,
+												  double *				result,
+												  const eval_double *			values ) ;
+
+extern int					evaluator_run_scratch_ctx		( evaluator_context *			context,
+												  const evaluator_program *		program,
+												  double *				result,
+												  const eval_double *			values,
+												  void *				scratch,
+												  size_t				scratch_size ) ;
+
+extern int					evaluator_save_programs_ctx		( evaluator_context *			context,
+												  const char *				filename,
+												  evaluator_program **			programs,
+												  int					count ) ;
+
+extern evaluator_image *			evaluator_load_programs_ctx		( evaluator_context *			context,
+												  const char *				filename ) ;
+
+extern evaluator_expression_set *		evaluator_compile_set_ctx		( evaluator_context *			context,
+												  const char **				expressions,
+												  int					count,
+												  int					flags ) ;
+
+extern int					evaluator_run_set_ctx			( evaluator_context *			context,
+												  const evaluator_expression_set *	set,
+												  double *				results,
+												  eval_callback				callback ) ;
+
+extern int					evaluator_run_set_bound_ctx		( evaluator_context *			context,
+												  const evaluator_expression_set *	set,
+												  double *				results,
+												  const eval_double *			values ) ;
+
+extern evaluator_incremental *			evaluator_create_incremental_ctx	( evaluator_context *			context,
+												  const evaluator_expression_set *	set,
+												  const eval_double *			values ) ;
+
+extern int					evaluator_update_incremental_ctx	( evaluator_context *			context,
+												  evaluator_incremental *		incremental,
+												  double *				results,
+												  int *					recomputed ) ;
+
+extern int					evaluator_run_batch_ctx			( evaluator_context *			context,
+												  const evaluator_program *		program,
+												  int					rows,
+												  const double **			columns,
+												  double *				output ) ;
+
+extern int					evaluator_run_batch_float_ctx		( evaluator_context *			context,
+												  const evaluator_program *		program,
+												  int					rows,
+												  const float **			columns,
+												  float *				output ) ;
+
+extern int					evaluator_run_parallel_ctx		( evaluator_context *			context,
+												  const evaluator_program *		program,
+												  int					rows,
+												  const double **			columns,
+												  double *				output ) ;
+
+extern void					evaluator_perror_ctx			( const evaluator_context *		context ) ;
+
+extern void 					evaluator_register_constants		( const evaluator_constant_definition *	definitions ) ;
+extern void 					evaluator_register_functions		( const evaluator_function_definition *	definitions ) ;
+
+extern const evaluator_constant_definition *	evaluator_get_registered_constants	( ) ;
+extern const evaluator_function_definition *	evaluator_get_registered_functions	( ) ;
+
 # endif		/*  __EVAL_H__  */
\ No newline at end of file
@@ -0,0 +1,368 @@
+/**************************************************************************************************************
+
+    NAME
+        evalbatch.h
+
+    DESCRIPTION
+        Columnar (batch) evaluation of compiled programs.
+	This file is included by eval.c
+
+	A program is computed over blocks of EVAL_BATCH_BLOCK_SIZE rows at a time : each stack entry is applied
+	to a whole block before the next one is processed, so that the cost of interpreting the output stack is
+	shared by all the rows of the block, and the operator loops are short, tight loops over arrays.
+
+	This file is included by eval.c once for each type of input and output columns ; the including file must
+	define the following macros, which are undefined at the end of this file :
+
+	EVAL_VALUE -
+		Type of column values, which is also the type used for computations (double or float).
+
+	EVAL_TEMPLATE(name) -
+		Builds the name of an instantiated function from its generic name.
+
+	EVAL_MATH(func) -
+		Name of the math library function computing func() for EVAL_VALUE arguments (for example, powf
+		instead of pow for floats).
+
+	EVAL_BATCH_KERNELS -
+		Non-zero if the SIMD kernels selected by eval_simd_initialize() can be used ; they operate on
+		doubles.
+
+	EVAL_BATCH_DOUBLE -
+		Non-zero if EVAL_VALUE is double ; blocks are then passed as is to the vector form of functions,
+		otherwise they are converted to double blocks first.
+
+	Functions having a vector form are called once per block ; the other ones are called once per row, their
+	arguments being converted to eval_double.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+
+/*==============================================================================================================
+
+	Number of rows processed at once. Values of a block for all the entries of the value stack should fit
+	into the L1 cache for most expressions.
+
+  ==============================================================================================================*/
+# ifndef	EVAL_BATCH_BLOCK_SIZE
+#	define	EVAL_BATCH_BLOCK_SIZE		256
+# endif
+
+
+/*==============================================================================================================
+
+    eval_batch_operator -
+        Applies the specified operator to n rows. For binary operators, a holds the left operands and b the
+	right ones ; for unary operators, a holds the operands and b is NULL.
+	output may be the same array as a or b.
+	The SIMD kernel selected by eval_simd_initialize() is used if there is one for this operator.
+	Returns 0 if the operator is unknown.
+
+  ==============================================================================================================*/
+static int	EVAL_TEMPLATE ( eval_batch_operator ) ( int  type, int  n, EVAL_VALUE *  output, const EVAL_VALUE *  a, const EVAL_VALUE *  b )
+   {
+	int		i ;
+
+
+# if	EVAL_BATCH_KERNELS
+	if  ( type  <=  OP_FACTORIAL  &&  eval_batch_kernels [ type ]  !=  NULL )
+	   {
+		eval_batch_kernels [ type ] ( n, output, a, b ) ;
+		return ( 1 ) ;
+	    }
+# endif
+
+	switch ( type )
+	   {
+		case	OP_PLUS :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  a [i] + b [i] ;
+			break ;
+
+		case	OP_MINUS :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  a [i] - b [i] ;
+			break ;
+
+		case	OP_MUL :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  a [i] * b [i] ;
+			break ;
+
+		case	OP_DIV :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  a [i] / b [i] ;
+			break ;
+
+		case	OP_IDIV :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  EVAL_MATH ( floor ) ( a [i] / b [i] ) ;
+			break ;
+
+		case	OP_POWER :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  EVAL_MATH ( pow ) ( a [i], b [i] ) ;
+			break ;
+
+		case	OP_MOD :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  EVAL_MATH ( fmod ) ( a [i], b [i] ) ;
+			break ;
+
+		case	OP_AND :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  ( EVAL_VALUE ) ( ( ( eval_int ) a [i] )  &  ( ( eval_int ) b [i] ) ) ;
+			break ;
+
+		case	OP_OR :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  ( EVAL_VALUE ) ( ( ( eval_int ) a [i] )  |  ( ( eval_int ) b [i] ) ) ;
+			break ;
+
+		case	OP_XOR :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  ( EVAL_VALUE ) ( ( ( eval_int ) a [i] )  ^  ( ( eval_int ) b [i] ) ) ;
+			break ;
+
+		case	OP_SHL :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  ( EVAL_VALUE ) ( ( ( eval_int ) a [i] )  <<  ( ( eval_int ) b [i] ) ) ;
+			break ;
+
+		case	OP_SHR :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  ( EVAL_VALUE ) ( ( ( eval_int ) a [i] )  >>  ( ( eval_int ) b [i] ) ) ;
+			break ;
+
+		case	OP_NOT :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  ( EVAL_VALUE ) ( ~ ( ( eval_int ) a [i] ) ) ;
+			break ;
+
+		case	OP_UNARY_PLUS :
+			if  ( output  !=  a )
+				memcpy ( output, a, n * sizeof ( EVAL_VALUE ) ) ;
+			break ;
+
+		case	OP_UNARY_MINUS :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  - a [i] ;
+			break ;
+
+		case	OP_FACTORIAL :
+			for  ( i = 0 ; i  <  n ; i ++ )
+				output [i]	=  ( EVAL_VALUE ) eval_factorial ( a [i] ) ;
+			break ;
+
+		default :
+			return ( 0 ) ;
+	    }
+
+	return ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_batch_compute -
+        Computes a program over rows start to end - 1. columns [slot] must point to the values of the variable
+	having the specified slot, and results are stored at the same indexes of the output array.
+	scratch must be an array of eval_batch_scratch_size ( program ) bytes.
+	Vector functions receive the argument blocks as is for double columns ; for float columns, arguments are
+	converted to double blocks, which are reserved after the scalar function arguments.
+
+  ==============================================================================================================*/
+static size_t	EVAL_TEMPLATE ( eval_batch_scratch_size ) ( const evaluator_program *  program )
+   {
+	return
+	   (
+		( program -> max_argc + 1 ) * sizeof ( eval_double ) +
+# if	! EVAL_BATCH_DOUBLE
+		( program -> max_argc + 1 ) * EVAL_BATCH_BLOCK_SIZE * sizeof ( double ) +
+		  program -> max_argc * sizeof ( double * ) +
+# endif
+		( program -> max_depth + program -> cell_count ) * EVAL_BATCH_BLOCK_SIZE * sizeof ( EVAL_VALUE ) +
+		  program -> max_depth * sizeof ( EVAL_VALUE * ) 
+	    ) ;
+    }
+
+
+static int	EVAL_TEMPLATE ( eval_batch_compute ) ( const evaluator_program *  program, int  start, int  end, const EVAL_VALUE **  columns,
+						       EVAL_VALUE *  output, void *  scratch )
+   {
+	eval_double *		function_args	=  ( eval_double * ) scratch ;
+# if	EVAL_BATCH_DOUBLE
+	EVAL_VALUE *		buffers		=  ( EVAL_VALUE * ) ( function_args + program -> max_argc + 1 ) ;	// One block per value stack entry
+# else
+	double *		vector_args	=  ( double * ) ( function_args + program -> max_argc + 1 ) ;		// Argument blocks of vector functions, then their result
+	EVAL_VALUE *		buffers		=  ( EVAL_VALUE * ) ( vector_args + ( program -> max_argc + 1 ) * EVAL_BATCH_BLOCK_SIZE ) ;
+# endif
+	EVAL_VALUE *		cells		=  buffers + program -> max_depth * EVAL_BATCH_BLOCK_SIZE ;
+	const EVAL_VALUE **	values		=  ( const EVAL_VALUE ** ) ( cells + program -> cell_count * EVAL_BATCH_BLOCK_SIZE ) ;
+# if	! EVAL_BATCH_DOUBLE
+	const double **		vector_argv	=  ( const double ** ) ( values + program -> max_depth ) ;
+# endif
+	const eval_instruction *	ip ;
+	int			top ;
+	int			first, n, j ;
+
+
+	// Ignore empty parse trees
+	if  ( program -> code  ==  NULL )
+		return ( 0 ) ;
+
+	for  ( first = start ; first  <  end ; first +=  EVAL_BATCH_BLOCK_SIZE )
+	   {
+		n	=  ( end - first  <  EVAL_BATCH_BLOCK_SIZE ) ?  end - first : EVAL_BATCH_BLOCK_SIZE ;
+		top	=  -1 ;
+
+		// values [top] points either to the block buffer of the corresponding stack entry, to a register cell
+		// or directly into an input column, which avoids copying variable values
+		for  ( ip = program -> code ; ip -> opcode  !=  OPCODE_END ; ip ++ )
+		   {
+			switch  ( ip -> opcode )
+			   {
+				case	OPCODE_NUMBER :
+				   {
+					EVAL_VALUE *	buffer	=  buffers + ( ++ top ) * EVAL_BATCH_BLOCK_SIZE ;
+					EVAL_VALUE	value	=  ( EVAL_VALUE ) ip -> fast_value ;
+
+					for  ( j = 0 ; j  <  n ; j ++ )
+						buffer [j]	=  value ;
+
+					values [ top ]	=  buffer ;
+					break ;
+				    }
+
+				case	OPCODE_VARIABLE :
+					values [ ++ top ]	=  columns [ ip -> argument ] + first ;
+					break ;
+
+				// Register values are copied, since the same register may be assigned another value while
+				// this one is still on the stack
+				case	OPCODE_REGISTER_RECALL :
+				   {
+					EVAL_VALUE *	buffer	=  buffers + ( ++ top ) * EVAL_BATCH_BLOCK_SIZE ;
+
+					memcpy ( buffer, cells + ip -> argument * EVAL_BATCH_BLOCK_SIZE, n * sizeof ( EVAL_VALUE ) ) ;
+					values [ top ]	=  buffer ;
+					break ;
+				    }
+
+				case	OPCODE_REGISTER_SAVE :
+					memcpy ( cells + ip -> argument * EVAL_BATCH_BLOCK_SIZE, values [ top ], n * sizeof ( EVAL_VALUE ) ) ;
+					break ;
+
+				// Function call : the vector form of the function computes the whole block, otherwise arguments
+				// are collected row by row
+				case	OPCODE_FUNCTION_CALL :
+				   {
+					eval_function		func	=  program -> functions [ ip -> value. function ] ;
+					eval_vector_function	vfunc	=  program -> vector_functions [ ip -> value. function ] ;
+					int			argc	=  ip -> argument ;
+					EVAL_VALUE *		buffer ;
+					int			k ;
+					EVAL_STATS_DECLARE ( function_start )
+					EVAL_PROFILE_DECLARE ( profile_start )
+
+
+					top	-=  argc - 1 ;
+					buffer	 =  buffers + top * EVAL_BATCH_BLOCK_SIZE ;
+
+					EVAL_STATS_START ( function_start ) ;
+					EVAL_PROFILE_START ( profile_start ) ;
+
+					if  ( vfunc  !=  NULL )
+					   {
+# if	EVAL_BATCH_DOUBLE
+						vfunc ( argc, n, values + top, buffer ) ;
+# else
+						double *	vector_result	=  vector_args + argc * EVAL_BATCH_BLOCK_SIZE ;
+
+						for  ( k = 0 ; k  <  argc ; k ++ )
+						   {
+							double *	arg	=  vector_args + k * EVAL_BATCH_BLOCK_SIZE ;
+
+							for  ( j = 0 ; j  <  n ; j ++ )
+								arg [j]		=  values [ top + k ] [j] ;
+
+							vector_argv [k]	=  arg ;
+						    }
+
+						vfunc ( argc, n, vector_argv, vector_result ) ;
+
+						for  ( j = 0 ; j  <  n ; j ++ )
+							buffer [j]	=  ( EVAL_VALUE ) vector_result [j] ;
+# endif
+					    }
+					else
+					   {
+						for  ( j = 0 ; j  <  n ; j ++ )
+						   {
+							for  ( k = 0 ; k  <  argc ; k ++ )
+								function_args [k]	=  values [ top + k ] [j] ;
+
+							buffer [j]	=  ( EVAL_VALUE ) func ( argc, function_args ) ;
+						    }
+					    }
+
+					EVAL_PROFILE_FUNCTION ( func, argc, profile_start, n ) ;
+					EVAL_STATS_STOP ( EVAL_PHASE_FUNCTION, function_start, n ) ;
+
+					values [ top ]	=  buffer ;
+					break ;
+				    }
+
+				// Operators
+				default :
+				   {
+					EVAL_VALUE *		buffer ;
+					EVAL_PROFILE_DECLARE ( operator_start )
+
+
+					EVAL_PROFILE_START ( operator_start ) ;
+
+					if  ( EVAL_OPCODE_IS_UNARY ( ip -> opcode ) )
+					   {
+						buffer	=  buffers + top * EVAL_BATCH_BLOCK_SIZE ;
+						EVAL_TEMPLATE ( eval_batch_operator ) ( ip -> opcode, n, buffer, values [ top ], NULL ) ;
+					    }
+					else
+					   {
+						top -- ;
+						buffer	=  buffers + top * EVAL_BATCH_BLOCK_SIZE ;
+
+						// Paranoia : Changes have been made to the supported opcode list, but not reflected here
+						if  ( ! EVAL_TEMPLATE ( eval_batch_operator ) ( ip -> opcode, n, buffer, values [ top ], values [ top + 1 ] ) )
+						   {
+							eval_error ( E_EVAL_UNDEFINED_OPERATOR,  -1, -1, "Undefined opcode '#%d' found", ip -> opcode ) ;
+							return ( 0 ) ;
+						    }
+					    }
+
+					EVAL_PROFILE_OPERATOR ( ip -> opcode, operator_start, n ) ;
+					values [ top ]	=  buffer ;
+					break ;
+				    }
+			    }
+		    }
+
+		memcpy ( output + first, values [0], n * sizeof ( EVAL_VALUE ) ) ;
+	    }
+
+	return ( 1 ) ;
+    }
+
+
+# undef		EVAL_VALUE
+# undef		EVAL_TEMPLATE
+# undef		EVAL_MATH
+# undef		EVAL_BATCH_KERNELS
+# undef		EVAL_BATCH_DOUBLE
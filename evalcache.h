@@ -0,0 +1,438 @@
+/**************************************************************************************************************
+
+    NAME
+        evalcache.h
+
+    DESCRIPTION
+        Cache of the programs compiled by the string interface (evaluate(), evaluate_ex() and evaluate_ctx()).
+	This file is included by eval.c
+
+	Programs are looked up using a normalized form of the expression text : whitespace is removed, unless
+	it separates characters that would otherwise form a single token, and names are converted to uppercase,
+	since the lexer does not distinguish case in them ; variable names, which are passed verbatim to the
+	callback, keep their case. Expressions that only differ by spacing or by the case of their constant and
+	function names thus share the same program.
+
+	The cache holds a fixed number of programs, and evicts the least recently used ones using the CLOCK
+	algorithm : a hit only sets the reference bit of the entry, so that the cache lock is held for a very
+	short time. Evicted programs may still be computed by other threads ; each cached program therefore
+	has a reference count, and is freed when the last of its users releases it.
+
+	Since programs contain the values of the constants and the addresses of the functions they use, the
+	cache is flushed when new constants or functions are registered.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+
+/*==============================================================================================================
+
+	Default number of cached programs ; each program takes at least one arena block (ARENA_BLOCK_SIZE
+	bytes). A value of zero disables the cache.
+
+  ==============================================================================================================*/
+# ifndef	EVAL_CACHE_SIZE
+#	define	EVAL_CACHE_SIZE			4096
+# endif
+
+// Expressions whose normalized form is longer than this are not cached
+# define	EVAL_CACHE_KEY_SIZE		1024
+
+
+/*==============================================================================================================
+
+	Cache structures.
+
+  ==============================================================================================================*/
+
+// A normalized expression
+typedef struct  eval_cache_key
+   {
+	char			text [ EVAL_CACHE_KEY_SIZE ] ;	// Normalized text
+	int			length ;			// Length of the normalized text, or -1 if it is too long
+	unsigned int		hash ;				// FNV-1a hash of the normalized text
+    }  eval_cache_key ;
+
+
+// A cache entry ; entries are chained by hash bucket
+typedef struct  eval_cache_entry
+   {
+	evaluator_program *	program ;			// Cached program, or NULL if the entry is free
+	char *			key ;				// Normalized text, allocated from the program arena
+	int			length ;			// Length of the normalized text
+	unsigned int		hash ;				// Hash of the normalized text
+	int			next ;				// Next entry in the same bucket, or -1
+	int			referenced ;			// CLOCK reference bit
+    }  eval_cache_entry ;
+
+
+// The cache itself
+typedef struct  eval_cache
+   {
+	eval_mutex		lock ;				// Protects everything below, and program reference counts
+	eval_cache_entry *	entries ;			// Cache entries
+	int *			buckets ;			// First entry of each bucket, or -1
+	int			size ;				// Number of entries
+	int			bucket_mask ;			// Number of buckets - 1
+	int			count ;				// Number of used entries
+	int			hand ;				// CLOCK hand
+	int			allocated ;			// Non-zero once entries and buckets have been allocated
+	unsigned long		hits ;				// Statistics
+	unsigned long		misses ;
+	unsigned long		evictions ;
+    }  eval_cache ;
+
+
+static eval_cache	eval_program_cache	=  { EVAL_MUTEX_INITIALIZER, NULL, NULL, EVAL_CACHE_SIZE, 0, 0, 0, 0, 0, 0, 0 } ;
+
+
+/*==============================================================================================================
+
+    eval_cache_normalize -
+        Builds the normalized form of the specified expression, and computes its hash. The length of the key
+	is set to -1 if the normalized expression does not fit in the key buffer.
+	Whitespace is kept, as a single space, only when removing it would merge two tokens or change the
+	meaning of the expression : between two name or number characters, between two operator characters,
+	after a '$' sign, and between the exponent character of a number and a sign.
+
+  ==============================================================================================================*/
+# define	EVAL_CACHE_IS_WORD(ch)		( EVAL_CHARACTER_CLASS ( ch )  &  CHAR_NUMBER )
+# define	EVAL_CACHE_IS_SEPARATOR(ch)	( ( ch )  ==  '('  ||  ( ch )  ==  ')'  ||  ( ch )  ==  ',' )
+
+static void	eval_cache_normalize ( const char *  str, eval_cache_key *  key )
+   {
+	char *		p		=  key -> text ;
+	char *		end		=  key -> text + sizeof ( key -> text ) - 1 ;
+	unsigned int	hash		=  2166136261u ;
+	int		space		=  0 ;			// Whitespace has been found before the current character
+	int		in_variable	=  0 ;			// The current character belongs to a variable name
+	char		previous	=  0 ;
+	char		ch ;
+
+
+	for  ( ; * str ; str ++ )
+	   {
+		ch	=  * str ;
+
+		if  ( EVAL_CHARACTER_CLASS ( ch )  &  CHAR_SPACE )
+		   {
+			space		=  1 ;
+			in_variable	=  0 ;
+			continue ;
+		    }
+
+		// Keep a single space if the characters on both sides would otherwise be joined
+		if  ( space  &&  previous )
+		   {
+			int	keep ;
+
+			if  ( EVAL_CACHE_IS_SEPARATOR ( previous )  ||  EVAL_CACHE_IS_SEPARATOR ( ch ) )
+				keep	=  0 ;
+			else if  ( EVAL_CACHE_IS_WORD ( previous ) )
+				keep	=  EVAL_CACHE_IS_WORD ( ch )  ||
+					   ( ( previous  ==  'E'  ||  previous  ==  'e' )  &&  ( ch  ==  '+'  ||  ch  ==  '-' ) ) ;
+			else
+				keep	=  ! EVAL_CACHE_IS_WORD ( ch )  ||  previous  ==  '$' ;
+
+			if  ( keep )
+			   {
+				if  ( p  >=  end )
+					goto  TooLong ;
+
+				* p ++	 =  ' ' ;
+				hash	 =  ( hash ^ ' ' ) * 16777619u ;
+			    }
+		    }
+
+		space	=  0 ;
+
+		// Variable names keep their case ; everything else is converted to uppercase
+		if  ( ch  ==  '$' )
+			in_variable	=  1 ;
+		else if  ( in_variable  &&  ! ( EVAL_CHARACTER_CLASS ( ch )  &  CHAR_NAME ) )
+			in_variable	=  0 ;
+
+		if  ( ! in_variable )
+			ch	=  EVAL_TO_UPPER ( ch ) ;
+
+		if  ( p  >=  end )
+			goto  TooLong ;
+
+		* p ++		=  ch ;
+		hash		=  ( hash ^ ( unsigned char ) ch ) * 16777619u ;
+		previous	=  ch ;
+	    }
+
+	* p		=  '\0' ;
+	key -> length	=  ( int ) ( p - key -> text ) ;
+	key -> hash	=  hash ;
+	return ;
+
+TooLong :
+	key -> length	=  -1 ;
+    }
+
+# undef		EVAL_CACHE_IS_WORD
+# undef		EVAL_CACHE_IS_SEPARATOR
+
+
+/*==============================================================================================================
+
+    eval_cache_allocate -
+        Allocates the entries and buckets of the cache, if needed. Must be called with the cache lock held.
+	Returns 0 if the cache is disabled.
+
+  ==============================================================================================================*/
+static int	eval_cache_allocate ( eval_cache *  cache )
+   {
+	int		bucket_count ;
+	int		i ;
+
+
+	if  ( cache -> allocated )
+		return ( 1 ) ;
+
+	if  ( cache -> size  <=  0 )
+		return ( 0 ) ;
+
+	// Use about two buckets per entry, so that chains stay short
+	for  ( bucket_count = 1 ; bucket_count  <  cache -> size * 2 ; bucket_count <<= 1 )
+		;
+
+	cache -> entries	=  ( eval_cache_entry * ) eval_malloc ( cache -> size * sizeof ( eval_cache_entry ) ) ;
+	cache -> buckets	=  ( int * ) eval_malloc ( bucket_count * sizeof ( int ) ) ;
+	cache -> bucket_mask	=  bucket_count - 1 ;
+	cache -> count		=  0 ;
+	cache -> hand		=  0 ;
+	cache -> allocated	=  1 ;
+
+	memset ( cache -> entries, 0, cache -> size * sizeof ( eval_cache_entry ) ) ;
+
+	for  ( i = 0 ; i  <  bucket_count ; i ++ )
+		cache -> buckets [i]	=  -1 ;
+
+	return ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_cache_unlink -
+        Removes the specified entry from the cache and returns its program if it has no other user, so that
+	the caller can free it once the lock has been released. Must be called with the cache lock held.
+
+  ==============================================================================================================*/
+static evaluator_program *	eval_cache_unlink ( eval_cache *  cache, int  index )
+   {
+	eval_cache_entry *	entry		=  cache -> entries + index ;
+	int *			link		=  cache -> buckets + ( entry -> hash & cache -> bucket_mask ) ;
+	evaluator_program *	program		=  entry -> program ;
+
+
+	while  ( * link  !=  index )
+		link	=  & cache -> entries [ * link ]. next ;
+
+	* link			=  entry -> next ;
+	entry -> program	=  NULL ;
+	cache -> count -- ;
+
+	return ( ( -- program -> cache_references  ==  0 ) ?  program : NULL ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_cache_lookup -
+        Searches the cache for the specified key. Returns the cached program, whose reference count has been
+	incremented, or NULL if the expression has not been cached yet.
+
+  ==============================================================================================================*/
+static evaluator_program *	eval_cache_lookup ( eval_cache_key *  key )
+   {
+	eval_cache *		cache		=  & eval_program_cache ;
+	evaluator_program *	program		=  NULL ;
+	eval_cache_entry *	entry ;
+	int			index ;
+
+
+	if  ( key -> length  <  0 )
+		return ( NULL ) ;
+
+	eval_mutex_lock ( & cache -> lock ) ;
+
+	if  ( eval_cache_allocate ( cache ) )
+	   {
+		for  ( index = cache -> buckets [ key -> hash & cache -> bucket_mask ] ; index  >=  0 ; index = entry -> next )
+		   {
+			entry	=  cache -> entries + index ;
+
+			if  ( entry -> hash  ==  key -> hash  &&  entry -> length  ==  key -> length  &&
+			      ! memcmp ( entry -> key, key -> text, key -> length ) )
+			   {
+				program			=  entry -> program ;
+				program -> cache_references ++ ;
+				entry -> referenced	=  1 ;
+				break ;
+			    }
+		    }
+
+		if  ( program  !=  NULL )
+			cache -> hits ++ ;
+		else
+			cache -> misses ++ ;
+	    }
+
+	eval_mutex_unlock ( & cache -> lock ) ;
+
+	return ( program ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_cache_insert -
+        Adds a newly compiled program to the cache, evicting an entry that has not been referenced since the
+	CLOCK hand last went over it if the cache is full. The program is owned by the caller, who must release
+	it using eval_cache_release(), whether it has been cached or not.
+
+  ==============================================================================================================*/
+static void	eval_cache_insert ( eval_cache_key *  key, evaluator_program *  program )
+   {
+	eval_cache *		cache		=  & eval_program_cache ;
+	evaluator_program *	evicted		=  NULL ;
+	eval_cache_entry *	entry ;
+	int			index ;
+
+
+	// Until it is cached, the caller is the only user of the program
+	program -> cache_references	=  1 ;
+
+	if  ( key -> length  <  0 )
+		return ;
+
+	eval_mutex_lock ( & cache -> lock ) ;
+
+	if  ( ! eval_cache_allocate ( cache ) )
+		goto  InsertEnd ;
+
+	// Another thread may have compiled the same expression in the meantime
+	for  ( index = cache -> buckets [ key -> hash & cache -> bucket_mask ] ; index  >=  0 ; index = entry -> next )
+	   {
+		entry	=  cache -> entries + index ;
+
+		if  ( entry -> hash  ==  key -> hash  &&  entry -> length  ==  key -> length  &&
+		      ! memcmp ( entry -> key, key -> text, key -> length ) )
+			goto  InsertEnd ;
+	    }
+
+	// Find a free entry, or evict the first unreferenced one ; referenced entries get a second chance
+	for  ( ; ; )
+	   {
+		entry	=  cache -> entries + cache -> hand ;
+		index	=  cache -> hand ;
+
+		cache -> hand	=  ( cache -> hand + 1 ) % cache -> size ;
+
+		if  ( entry -> program  ==  NULL )
+			break ;
+
+		if  ( entry -> referenced )
+		   {
+			entry -> referenced	=  0 ;
+			continue ;
+		    }
+
+		evicted		=  eval_cache_unlink ( cache, index ) ;
+		cache -> evictions ++ ;
+		break ;
+	    }
+
+	// The key is stored in the program arena, so that it is freed together with the program
+	entry -> program	=  program ;
+	entry -> key		=  ( char * ) eval_arena_alloc ( & program -> arena, key -> length + 1 ) ;
+	entry -> length		=  key -> length ;
+	entry -> hash		=  key -> hash ;
+	entry -> referenced	=  1 ;
+	entry -> next		=  cache -> buckets [ key -> hash & cache -> bucket_mask ] ;
+
+	memcpy ( entry -> key, key -> text, key -> length + 1 ) ;
+
+	cache -> buckets [ key -> hash & cache -> bucket_mask ]		=  index ;
+	cache -> count ++ ;
+	program -> cache_references ++ ;
+
+InsertEnd :
+	eval_mutex_unlock ( & cache -> lock ) ;
+
+	if  ( evicted  !=  NULL )
+		evaluator_free_program ( evicted ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_cache_release -
+        Releases a program returned by eval_cache_lookup() or given to eval_cache_insert(), and frees it if it
+	is no longer cached nor used by another thread.
+
+  ==============================================================================================================*/
+static void	eval_cache_release ( evaluator_program *  program )
+   {
+	eval_cache *		cache		=  & eval_program_cache ;
+	int			references ;
+
+
+	eval_mutex_lock ( & cache -> lock ) ;
+	references	=  -- program -> cache_references ;
+	eval_mutex_unlock ( & cache -> lock ) ;
+
+	if  ( ! references )
+		evaluator_free_program ( program ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_cache_flush -
+        Removes all the programs from the cache and, if size is not negative, changes the number of entries.
+	Programs that are still in use are freed by their last user.
+
+  ==============================================================================================================*/
+static void	eval_cache_flush ( int  size )
+   {
+	eval_cache *		cache		=  & eval_program_cache ;
+	evaluator_program *	program ;
+	int			i ;
+
+
+	eval_mutex_lock ( & cache -> lock ) ;
+
+	if  ( cache -> allocated )
+	   {
+		for  ( i = 0 ; i  <  cache -> size ; i ++ )
+		   {
+			if  ( cache -> entries [i]. program  !=  NULL  &&  ( program = eval_cache_unlink ( cache, i ) )  !=  NULL )
+				evaluator_free_program ( program ) ;
+		    }
+
+		if  ( size  >=  0 )
+		   {
+			eval_free ( cache -> entries ) ;
+			eval_free ( cache -> buckets ) ;
+			cache -> entries	=  NULL ;
+			cache -> buckets	=  NULL ;
+			cache -> allocated	=  0 ;
+		    }
+	    }
+
+	if  ( size  >=  0 )
+		cache -> size	=  size ;
+
+	eval_mutex_unlock ( & cache -> lock ) ;
+    }
@@ -0,0 +1,381 @@
+/**************************************************************************************************************
+
+    NAME
+        evalcompute.h
+
+    DESCRIPTION
+        Scalar computation engine.
+	This file is included by eval.c, once for each type used for computations ; the including file must
+	define the following macros, which are undefined at the end of this file :
+
+	EVAL_VALUE -
+		Type of the values held on the value stack (double or long double).
+
+	EVAL_TEMPLATE(name) -
+		Builds the name of an instantiated function from its generic name, so that each included copy
+		defines its own set of functions (for example, eval_compute_double() for the double type).
+
+	EVAL_NUMERIC_VALUE(ip) -
+		Value of an OPCODE_NUMBER instruction, as an EVAL_VALUE.
+
+	Computing with doubles allows the compiler to use SSE2/AVX instructions on the hot path, while long
+	doubles are computed by the x87 FPU.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+
+/*==============================================================================================================
+
+    eval_apply_operator -
+	Applies an operator to its operands : value1 is the right operand (or the only one, for unary operators)
+	and value2 is the left one.
+	Returns 0 if the operator is unknown.
+
+  ==============================================================================================================*/
+static int	EVAL_TEMPLATE ( eval_apply_operator ) ( int  type, EVAL_VALUE  value1, EVAL_VALUE  value2, EVAL_VALUE *  result )
+   {
+	switch ( type )
+	   {
+		case	OP_PLUS :
+			* result	=  value2 + value1 ;
+			break ;
+
+		case	OP_MINUS :
+			* result	=  value2 - value1 ;
+			break ;
+
+		case	OP_MUL :
+			* result	=  value1 * value2 ;
+			break ;
+
+		case	OP_DIV :
+			* result	=  value2 / value1 ;
+			break ;
+
+		case	OP_IDIV :
+			* result	=  floor ( value2 / value1 ) ;
+			break ;
+
+		case	OP_POWER :
+			* result	=  pow ( value2, value1 ) ;
+			break ;
+
+		case	OP_MOD :
+			* result	=  fmod ( value2, value1 ) ;
+			break ;
+
+		case	OP_AND :
+			* result	=  ( EVAL_VALUE ) ( ( ( eval_int ) value1 )  &  ( ( eval_int ) value2 ) );
+			break ;
+
+		case	OP_OR :
+			* result	=  ( EVAL_VALUE ) ( ( ( eval_int ) value1 )  |  ( ( eval_int ) value2 ) ) ;
+			break ;
+
+		case	OP_XOR :
+			* result	=  ( EVAL_VALUE ) ( ( ( eval_int ) value1 )  ^  ( ( eval_int ) value2 ) ) ;
+			break ;
+
+		case	OP_NOT :
+			* result	=  ( EVAL_VALUE ) ( ~( ( eval_int ) value1 ) ) ;
+			break ;
+
+		case	OP_UNARY_PLUS :
+			* result	=  value1 ;
+			break ;
+
+		case	OP_UNARY_MINUS :
+			* result	=  -value1 ;
+			break ;
+
+		case	OP_SHL :
+			* result	=  ( EVAL_VALUE ) ( ( ( eval_int ) value2 )  <<  ( ( eval_int ) value1 ) ) ;
+			break ;
+
+		case	OP_SHR :
+			* result	=  ( EVAL_VALUE ) ( ( ( eval_int ) value2 )  >>  ( ( eval_int ) value1 ) ) ;
+			break ;
+
+		case	OP_FACTORIAL :
+			* result	=  ( EVAL_VALUE ) eval_factorial ( value1 ) ;
+			break ;
+
+		default :
+			return ( 0 ) ;
+	    }
+
+	return ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_compute_scratch_size -
+	Returns the size in bytes of the scratch memory needed by eval_compute() to run the specified program :
+	function arguments come first, since eval_double may require a stricter alignment than EVAL_VALUE, then
+	stack values and register cells.
+
+  ==============================================================================================================*/
+static size_t	EVAL_TEMPLATE ( eval_compute_scratch_size ) ( const evaluator_program *  program )
+   {
+	return
+	   (
+		( program -> max_argc + 1 ) * sizeof ( eval_double ) +
+		( program -> max_depth + program -> cell_count ) * sizeof ( EVAL_VALUE )
+	    ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_compute -
+	Executes the bytecode generated by eval_assemble(), using EVAL_VALUE values.
+	Variable values, function arguments and the final result are eval_double values whatever EVAL_VALUE is.
+	For expression sets, output is an array receiving the result of each expression.
+	The value stack lives in the supplied scratch memory, which must be at least eval_compute_scratch_size()
+	bytes long ; when scratch is NULL, it is taken from a local buffer, or from the heap for large programs.
+
+	Instructions are dispatched by an indirect jump to the address of the next handler when the compiler
+	supports computed gotos (EVAL_COMPUTED_GOTO), and by a switch otherwise. eval_link() has checked that
+	the value stack can neither underflow nor overflow, so handlers do not check it.
+
+  ==============================================================================================================*/
+# if	EVAL_COMPUTED_GOTO
+#	define	EVAL_LABEL_NAME(op)		EVAL_LABEL_PASTE ( op )		// Expands op before pasting it
+#	define	EVAL_LABEL_PASTE(op)		Label_##op
+#	define	EVAL_OPCODE(op)			EVAL_LABEL_NAME ( op ) :
+#	define	EVAL_LABEL(op)			[ op ]  =  && EVAL_LABEL_NAME ( op )
+#	define	EVAL_DISPATCH			goto *  labels [ ( ++ ip ) -> opcode ]
+# else
+#	define	EVAL_OPCODE(op)			case  op :
+#	define	EVAL_DISPATCH			ip ++ ; continue
+# endif
+
+// Binary operators replace the left operand with the result ; a is the left operand and b the right one
+# define	EVAL_BINARY(op, expression)				\
+		EVAL_OPCODE ( op )					\
+		   {							\
+			EVAL_VALUE	a	=  sp [-1],		\
+					b	=  sp [0] ;		\
+			EVAL_PROFILE_DECLARE ( operator_start )		\
+									\
+			EVAL_PROFILE_START ( operator_start ) ;		\
+			* -- sp		=  expression ;			\
+			EVAL_PROFILE_OPERATOR ( op, operator_start, 1 ) ;	\
+			EVAL_DISPATCH ;					\
+		    }
+
+// Unary operators replace their operand a with the result
+# define	EVAL_UNARY(op, expression)				\
+		EVAL_OPCODE ( op )					\
+		   {							\
+			EVAL_VALUE	a	=  sp [0] ;		\
+			EVAL_PROFILE_DECLARE ( operator_start )		\
+									\
+			EVAL_PROFILE_START ( operator_start ) ;		\
+			* sp		=  expression ;			\
+			EVAL_PROFILE_OPERATOR ( op, operator_start, 1 ) ;	\
+			EVAL_DISPATCH ;					\
+		    }
+
+
+static int	EVAL_TEMPLATE ( eval_compute ) ( const evaluator_program *  program, eval_double *  output, const eval_double *  variables, eval_callback  callback,
+					    void *  scratch_memory )
+   {
+	const eval_instruction *	ip			=  program -> code ;		// Current instruction
+	EVAL_VALUE *			value_stack ;						// Stack of intermediary floating point values
+	EVAL_VALUE *			sp ;							// Top of the value stack
+	EVAL_VALUE *			cells ;							// Register values
+	eval_double *			function_args ;						// Placeholder used to store function arguments
+	eval_arena			scratch ;						// Arena for the above, when no scratch memory is supplied
+	char				scratch_buffer [ ARENA_COMPUTE_BUFFER_SIZE ] ;
+	int				status			=  0 ;				// Return code ; 1 = OK
+
+# if	EVAL_COMPUTED_GOTO
+	static const void *		labels [ OPCODE_COUNT ]	=
+	   {
+		EVAL_LABEL ( OPCODE_END ),
+		EVAL_LABEL ( OPCODE_NUMBER ),
+		EVAL_LABEL ( OPCODE_VARIABLE ),
+		EVAL_LABEL ( OPCODE_REGISTER_SAVE ),
+		EVAL_LABEL ( OPCODE_REGISTER_RECALL ),
+		EVAL_LABEL ( OPCODE_FUNCTION_CALL ),
+		EVAL_LABEL ( OPCODE_OUTPUT ),
+		EVAL_LABEL ( OP_PLUS ),
+		EVAL_LABEL ( OP_MINUS ),
+		EVAL_LABEL ( OP_MUL ),
+		EVAL_LABEL ( OP_DIV ),
+		EVAL_LABEL ( OP_IDIV ),
+		EVAL_LABEL ( OP_POWER ),
+		EVAL_LABEL ( OP_MOD ),
+		EVAL_LABEL ( OP_AND ),
+		EVAL_LABEL ( OP_OR ),
+		EVAL_LABEL ( OP_XOR ),
+		EVAL_LABEL ( OP_NOT ),
+		EVAL_LABEL ( OP_UNARY_PLUS ),
+		EVAL_LABEL ( OP_UNARY_MINUS ),
+		EVAL_LABEL ( OP_SHL ),
+		EVAL_LABEL ( OP_SHR ),
+		EVAL_LABEL ( OP_FACTORIAL )
+	    } ;
+# endif
+
+
+	// Ignore empty parse trees
+	if  ( ip  ==  NULL )
+		return ( 0 ) ;
+
+	// Use the caller's scratch memory if any ; otherwise, allocate space for a new stack, from a local buffer 
+	// when it is large enough
+	eval_arena_initialize ( & scratch, scratch_buffer, sizeof ( scratch_buffer ) ) ;
+
+	if  ( scratch_memory  !=  NULL )
+		function_args	=  ( eval_double * ) scratch_memory ;
+	else
+		function_args	=  ( eval_double * ) eval_arena_alloc ( & scratch, EVAL_TEMPLATE ( eval_compute_scratch_size ) ( program ) ) ;
+
+	value_stack	=  ( EVAL_VALUE * ) ( function_args + program -> max_argc + 1 ) ;
+	sp		=  value_stack - 1 ;
+	cells		=  value_stack + program -> max_depth ;
+
+# if	EVAL_COMPUTED_GOTO
+	goto *  labels [ ip -> opcode ] ;
+# else
+	for  ( ; ; )
+	   {
+		switch  ( ip -> opcode )
+		   {
+# endif
+		// Final result ; eval_link() has checked that only one value remains on the stack, or none for
+		// expression sets, whose results have been stored by OPCODE_OUTPUT
+		EVAL_OPCODE ( OPCODE_END )
+			if  ( sp  >=  value_stack )
+				* output	=  ( eval_double ) * sp ;
+
+			status		=  1 ;
+			goto  ComputeEnd ;
+
+		// Result of an expression of a set
+		EVAL_OPCODE ( OPCODE_OUTPUT )
+			output [ ip -> argument ]	=  ( eval_double ) * sp -- ;
+			EVAL_DISPATCH ;
+
+		// Push numeric entries onto the value stack
+		EVAL_OPCODE ( OPCODE_NUMBER )
+			* ++ sp		=  EVAL_NUMERIC_VALUE ( ip ) ;
+			EVAL_DISPATCH ;
+
+		// Variable reference ; variables bound to memory slots do not need a callback
+		EVAL_OPCODE ( OPCODE_VARIABLE )
+		   {
+			eval_double 	callback_result ;
+			int		callback_status ;
+			EVAL_STATS_DECLARE ( callback_start )
+
+			if  ( variables  !=  NULL )
+			   {
+				* ++ sp		=  ( EVAL_VALUE ) variables [ ip -> argument ] ;
+				EVAL_DISPATCH ;
+			    }
+
+			EVAL_STATS_START ( callback_start ) ;
+			callback_status		=  callback ( program -> variables [ ip -> argument ], & callback_result ) ;
+			EVAL_STATS_STOP ( EVAL_PHASE_CALLBACK, callback_start, 1 ) ;
+
+			if  ( callback_status  ==  EVAL_CALLBACK_UNDEFINED )
+			   {
+				eval_error ( E_EVAL_UNDEFINED_VARIABLE, -1, -1, "Undefined variable '%s'",
+						program -> variables [ ip -> argument ] ) ;
+				goto  ComputeEnd ;
+			    }
+
+			* ++ sp		=  ( EVAL_VALUE ) callback_result ;
+			EVAL_DISPATCH ;
+		    }
+
+		// Register numbers have been replaced with cell indexes by eval_link(), which also checked that
+		// the register has been assigned a value before
+		EVAL_OPCODE ( OPCODE_REGISTER_SAVE )
+			cells [ ip -> argument ]	=  * sp ;
+			EVAL_DISPATCH ;
+
+		EVAL_OPCODE ( OPCODE_REGISTER_RECALL )
+			* ++ sp		=  cells [ ip -> argument ] ;
+			EVAL_DISPATCH ;
+
+		// Function call ; arguments are collected in a separate array
+		EVAL_OPCODE ( OPCODE_FUNCTION_CALL )
+		   {
+			int		argc	=  ip -> argument ;
+			int		j ;
+			EVAL_STATS_DECLARE ( function_start )
+			EVAL_PROFILE_DECLARE ( profile_start )
+				
+				
+			sp	-=  argc ;
+
+			for  ( j = 0 ; j  <  argc ; j ++ )
+				function_args [j]	=  sp [ j + 1 ] ;
+
+			EVAL_STATS_START ( function_start ) ;
+			EVAL_PROFILE_START ( profile_start ) ;
+			* ++ sp		=  ( EVAL_VALUE ) program -> functions [ ip -> value. function ] ( argc, function_args ) ;
+			EVAL_PROFILE_FUNCTION ( program -> functions [ ip -> value. function ], argc, profile_start, 1 ) ;
+			EVAL_STATS_STOP ( EVAL_PHASE_FUNCTION, function_start, 1 ) ;
+			EVAL_DISPATCH ;
+		    }
+
+		// Operators
+		EVAL_BINARY ( OP_PLUS		, a + b )
+		EVAL_BINARY ( OP_MINUS		, a - b )
+		EVAL_BINARY ( OP_MUL		, b * a )
+		EVAL_BINARY ( OP_DIV		, a / b )
+		EVAL_BINARY ( OP_IDIV		, floor ( a / b ) )
+		EVAL_BINARY ( OP_POWER		, pow ( a, b ) )
+		EVAL_BINARY ( OP_MOD		, fmod ( a, b ) )
+		EVAL_BINARY ( OP_AND		, ( EVAL_VALUE ) ( ( ( eval_int ) b )  &  ( ( eval_int ) a ) ) )
+		EVAL_BINARY ( OP_OR		, ( EVAL_VALUE ) ( ( ( eval_int ) b )  |  ( ( eval_int ) a ) ) )
+		EVAL_BINARY ( OP_XOR		, ( EVAL_VALUE ) ( ( ( eval_int ) b )  ^  ( ( eval_int ) a ) ) )
+		EVAL_BINARY ( OP_SHL		, ( EVAL_VALUE ) ( ( ( eval_int ) a )  <<  ( ( eval_int ) b ) ) )
+		EVAL_BINARY ( OP_SHR		, ( EVAL_VALUE ) ( ( ( eval_int ) a )  >>  ( ( eval_int ) b ) ) )
+		EVAL_UNARY  ( OP_NOT		, ( EVAL_VALUE ) ( ~ ( ( eval_int ) a ) ) )
+		EVAL_UNARY  ( OP_UNARY_PLUS	, a )
+		EVAL_UNARY  ( OP_UNARY_MINUS	, - a )
+		EVAL_UNARY  ( OP_FACTORIAL	, ( EVAL_VALUE ) eval_factorial ( a ) )
+
+# if	! EVAL_COMPUTED_GOTO
+		// Paranoia : Changes have been made to the supported opcode list, but not reflected here
+		default :
+			eval_error ( E_EVAL_UNDEFINED_TOKEN_TYPE, -1, -1, "Undefined opcode '#%d'", ip -> opcode ) ;
+			goto  ComputeEnd ;
+		    }
+	    }
+# endif
+
+ComputeEnd :
+	// Free the value stack ; this must be done on error too, since eval_compute() may be called many times on
+	// the same compiled program. Nothing has been allocated when the caller supplied scratch memory
+	eval_arena_release ( & scratch ) ;
+
+	return ( status ) ;
+    }
+
+
+# undef		EVAL_LABEL_NAME
+# undef		EVAL_LABEL_PASTE
+# undef		EVAL_OPCODE
+# undef		EVAL_LABEL
+# undef		EVAL_DISPATCH
+# undef		EVAL_BINARY
+# undef		EVAL_UNARY
+
+# undef		EVAL_VALUE
+# undef		EVAL_TEMPLATE
+# undef		EVAL_NUMERIC_VALUE
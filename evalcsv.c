@@ -0,0 +1,1026 @@
+/**************************************************************************************************************
+
+    NAME
+        evalcsv.c
+
+    DESCRIPTION
+        Applies one or more expressions to each row of a CSV file, and writes the results to the standard
+	output. This file includes eval.c, so that its portable threading primitives can be used ; it must
+	be compiled alone :
+
+		$ cc -O2 evalcsv.c -lm -lpthread
+		$ ./a.out [options] [--] expression...
+
+	The first line of the input gives the column names ; an expression refers to the value of a column
+	of the current row through a variable having the same name, such as $price for the "price" column.
+	An expression can be prefixed with "name=", which gives the name of its output column ; otherwise,
+	the expression text itself is used. Options are :
+
+	-b size :
+		Size, in kilobytes, of the blocks of input read at once (default : 4096).
+	-d char :
+		Field delimiter (default : comma). "tab" or "\t" can be specified for tabulations.
+	-i file :
+		Input file (default : standard input).
+	-j count :
+		Number of threads used to evaluate a block of rows ; the default is one thread per processor.
+	-k :
+		Copies the input columns in front of the results.
+	-p digits :
+		Number of significant digits of the results (default : 15).
+
+	The input is processed through a pipeline of four threads, which work on different blocks at the
+	same time : the reader reads blocks of complete lines, the parser converts the fields referenced by
+	the expressions into columns of numbers, the evaluator runs each expression over the whole block with
+	evaluator_run_parallel(), and the writer formats the results. Empty or non-numeric fields, as well as
+	missing ones, give NaN values, which are written as empty fields.
+
+	Quoted fields are supported, provided that they do not contain newlines.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+# include	"eval.c"
+
+
+/*==============================================================================================================
+
+	Constants.
+
+  ==============================================================================================================*/
+# define	CSV_SLOTS		4			// Number of blocks in the pipeline
+# define	CSV_BLOCK_SIZE		4096			// Default size of a block, in kilobytes
+# define	CSV_PRECISION		15			// Default number of significant digits of results
+# define	CSV_MAX_PRECISION	17			// Digits needed to write back any double exactly
+# define	CSV_NUMBER_SIZE		32			// Max size of a formatted result
+# define	CSV_MAX_NUMBER		64			// Max length of a number handled by strtod()
+# define	CSV_OUTPUT_SIZE		( 1024 * 1024 )		// Size of the output buffer
+
+// Block states ; each pipeline stage waits for the state set by the previous one
+# define	CSV_FREE		0			// Block can be filled by the reader
+# define	CSV_READ		1			// Block contains complete lines
+# define	CSV_PARSED		2			// Referenced fields have been converted into numbers
+# define	CSV_COMPUTED		3			// Results have been computed
+
+
+/*==============================================================================================================
+
+	Structures.
+
+  ==============================================================================================================*/
+
+// A block of input lines, moving along the pipeline
+typedef struct  csv_block
+   {
+	int		state ;				// One of the CSV_* states
+	int		last ;				// Non-zero for the last block of the input
+	char *		text ;				// Block contents, always ending with a newline
+	size_t		text_size ;			// Allocated size of text
+	size_t		start ;				// Offset of the first row ; non-zero for the block containing the header
+	size_t		length ;			// Length of text
+	int		rows ;				// Number of rows
+	int		max_rows ;			// Number of rows that fit in the arrays below
+	char **		lines ;				// Start of each row, used by the -k option
+	int *		line_lengths ;			// Length of each row, excluding the newline
+	double *	values ;			// Values of the referenced columns, max_rows values per column
+	double *	results ;			// Results of the expressions, max_rows values per expression
+    }  csv_block ;
+
+// An expression applied to each row
+typedef struct  csv_expression
+   {
+	char *			name ;			// Output column name
+	char *			text ;			// Expression text
+	evaluator_program *	program ;		// Compiled expression
+	int *			columns ;		// Referenced column index of each variable slot
+	const double **		inputs ;		// Input columns of the current block, indexed by variable slot
+    }  csv_expression ;
+
+
+/*==============================================================================================================
+
+	Global variables.
+
+  ==============================================================================================================*/
+
+// Options
+static FILE *		csv_input ;
+static char		csv_delimiter		=  ',' ;
+static int		csv_keep		=  0 ;
+static int		csv_precision		=  CSV_PRECISION ;
+static size_t		csv_block_size		=  CSV_BLOCK_SIZE * 1024 ;
+
+// Expressions
+static csv_expression *	csv_expressions ;
+static int		csv_expression_count ;
+
+// Input fields : csv_field_map gives the index of the referenced column of each field, or -1
+static int *		csv_field_map ;
+static int		csv_field_count ;
+static int		csv_last_field		=  -1 ;
+static int		csv_column_count ;
+
+// Pipeline
+static csv_block	csv_blocks [ CSV_SLOTS ] ;
+static eval_mutex	csv_lock		=  EVAL_MUTEX_INITIALIZER ;
+static eval_condition	csv_changed		=  EVAL_CONDITION_INITIALIZER ;
+
+// Exact powers of ten, used for fast number conversion
+static double		csv_powers []		=
+   {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    } ;
+
+static double		csv_nan ;
+static double		csv_integer_limit ;
+
+
+/*==============================================================================================================
+
+    csv_fatal -
+        Displays an error message and exits.
+
+  ==============================================================================================================*/
+static void	csv_fatal ( char *  format, ... )
+   {
+	va_list		ap ;
+
+
+	va_start ( ap, format ) ;
+	fprintf ( stderr, "evalcsv : " ) ;
+	vfprintf ( stderr, format, ap ) ;
+	fprintf ( stderr, "\n" ) ;
+	va_end ( ap ) ;
+
+	exit ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_reserve -
+        Ensures that a buffer can hold the specified number of bytes.
+
+  ==============================================================================================================*/
+static void *	csv_reserve ( void *  buffer, size_t *  size, size_t  needed )
+   {
+	if  ( needed  <=  * size  &&  buffer  !=  NULL )
+		return ( buffer ) ;
+
+	buffer	=  realloc ( buffer, needed ) ;
+
+	if  ( buffer  ==  NULL )
+		csv_fatal ( "Out of memory" ) ;
+
+	* size	=  needed ;
+
+	return ( buffer ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_wait, csv_post -
+        Wait for a block to reach the specified state, and set the state of a block.
+
+  ==============================================================================================================*/
+static void	csv_wait ( csv_block *  block, int  state )
+   {
+	eval_mutex_lock ( & csv_lock ) ;
+
+	while  ( block -> state  !=  state )
+		eval_condition_wait ( & csv_changed, & csv_lock ) ;
+
+	eval_mutex_unlock ( & csv_lock ) ;
+    }
+
+
+static void	csv_post ( csv_block *  block, int  state )
+   {
+	eval_mutex_lock ( & csv_lock ) ;
+	block -> state	=  state ;
+	eval_condition_broadcast ( & csv_changed ) ;
+	eval_mutex_unlock ( & csv_lock ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_field -
+        Locates the field starting at p, and returns a pointer to the delimiter that follows it, or to end.
+	The field value, without its enclosing quotes, is returned in [*value_start, *value_end).
+
+  ==============================================================================================================*/
+static char *	csv_field ( char *  p, char *  end, char **  value_start, char **  value_end )
+   {
+	if  ( p  <  end  &&  * p  ==  '"' )
+	   {
+		* value_start	=  ++ p ;
+
+		// Doubled quotes stand for a quote inside the field
+		while  ( p  <  end )
+		   {
+			if  ( * p  ==  '"' )
+			   {
+				if  ( p + 1  <  end  &&  p [1]  ==  '"' )
+					p ++ ;
+				else
+					break ;
+			    }
+
+			p ++ ;
+		    }
+
+		* value_end	=  p ;
+
+		while  ( p  <  end  &&  * p  !=  csv_delimiter )
+			p ++ ;
+	    }
+	else
+	   {
+		* value_start	=  p ;
+		p		=  ( char * ) memchr ( p, csv_delimiter, end - p ) ;
+
+		if  ( p  ==  NULL )
+			p	=  end ;
+
+		* value_end	=  p ;
+	    }
+
+	return ( p ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_parse_number -
+        Converts the text in [p, end) into a number. Numbers having at most 19 significant digits and a small
+	exponent are converted exactly using integer arithmetic and a single multiplication or division ;
+	other ones are given to strtod(). Returns NaN if the text is not a number.
+
+  ==============================================================================================================*/
+static double	csv_parse_number ( const char *  p, const char *  end )
+   {
+	char			buffer [ CSV_MAX_NUMBER ] ;
+	char *			buffer_end ;
+	const char *		start ;
+	unsigned long long	mantissa	=  0 ;
+	int			digits		=  0 ;
+	int			seen		=  0 ;
+	int			exact		=  1 ;
+	int			negative	=  0 ;
+	int			exponent	=  0 ;
+	int			e		=  0 ;
+	int			e_negative	=  0 ;
+	double			value ;
+
+
+	while  ( p  <  end  &&  ( * p  ==  ' '  ||  * p  ==  '\t' ) )
+		p ++ ;
+
+	while  ( end  >  p  &&  ( end [-1]  ==  ' '  ||  end [-1]  ==  '\t' ) )
+		end -- ;
+
+	if  ( p  ==  end )
+		return ( csv_nan ) ;
+
+	start	=  p ;
+
+	if  ( * p  ==  '-'  ||  * p  ==  '+' )
+		negative	=  ( * p ++  ==  '-' ) ;
+
+	// Integer part ; leading zeros are not significant
+	for  ( ; p  <  end  &&  * p  >=  '0'  &&  * p  <=  '9' ; p ++, seen ++ )
+	   {
+		if  ( digits  <  19 )
+		   {
+			mantissa	=  mantissa * 10 + ( * p - '0' ) ;
+
+			if  ( mantissa )
+				digits ++ ;
+		    }
+		else
+		   {
+			exponent ++ ;
+			exact	=  0 ;
+		    }
+	    }
+
+	// Fractional part
+	if  ( p  <  end  &&  * p  ==  '.' )
+	   {
+		for  ( p ++ ; p  <  end  &&  * p  >=  '0'  &&  * p  <=  '9' ; p ++, seen ++ )
+		   {
+			if  ( digits  <  19 )
+			   {
+				mantissa	=  mantissa * 10 + ( * p - '0' ) ;
+				exponent -- ;
+
+				if  ( mantissa )
+					digits ++ ;
+			    }
+			else
+				exact	=  0 ;
+		    }
+	    }
+
+	// Exponent
+	if  ( seen  &&  p  <  end  &&  ( * p  ==  'e'  ||  * p  ==  'E' ) )
+	   {
+		p ++ ;
+
+		if  ( p  <  end  &&  ( * p  ==  '-'  ||  * p  ==  '+' ) )
+			e_negative	=  ( * p ++  ==  '-' ) ;
+
+		if  ( p  ==  end  ||  * p  <  '0'  ||  * p  >  '9' )
+			return ( csv_nan ) ;
+
+		for  ( ; p  <  end  &&  * p  >=  '0'  &&  * p  <=  '9' ; p ++ )
+		   {
+			if  ( e  <  100000 )
+				e	=  e * 10 + ( * p - '0' ) ;
+		    }
+
+		exponent	+=  ( e_negative ) ?  -e : e ;
+	    }
+
+	// Fast path : both the mantissa and the power of ten are exact doubles
+	if  ( seen  &&  p  ==  end  &&  exact  &&  mantissa  <=  ( 1ULL << 53 )  &&  exponent  >=  -22  &&  exponent  <=  22 )
+	   {
+		value	=  ( exponent  <  0 ) ?
+				( double ) mantissa / csv_powers [ - exponent ] :
+				( double ) mantissa * csv_powers [ exponent ] ;
+
+		return ( ( negative ) ?  - value : value ) ;
+	    }
+
+	// Slow path : long numbers, big exponents, and special values such as "inf"
+	if  ( end - start  >=  CSV_MAX_NUMBER )
+		return ( csv_nan ) ;
+
+	memcpy ( buffer, start, end - start ) ;
+	buffer [ end - start ]	=  '\0' ;
+	value			=  strtod ( buffer, & buffer_end ) ;
+
+	return ( ( buffer_end  >  buffer  &&  * buffer_end  ==  '\0' ) ?  value : csv_nan ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_format -
+        Formats a result and returns its length. Integers are formatted without printf(), which is much
+	slower ; NaN values give an empty field.
+
+  ==============================================================================================================*/
+static int	csv_format ( double  value, char *  output )
+   {
+	char			digits [ CSV_NUMBER_SIZE ] ;
+	unsigned long long	integer ;
+	int			count	=  0,
+				length	=  0 ;
+
+
+	if  ( value  !=  value )
+		return ( 0 ) ;
+
+	if  ( value  !=  floor ( value )  ||  fabs ( value )  >=  csv_integer_limit )
+		return ( sprintf ( output, "%.*g", csv_precision, value ) ) ;
+
+	if  ( value  <  0 )
+	   {
+		output [ length ++ ]	=  '-' ;
+		value			=  - value ;
+	    }
+
+	integer		=  ( unsigned long long ) value ;
+
+	do
+	   {
+		digits [ count ++ ]	=  ( char ) ( '0' + integer % 10 ) ;
+		integer		       /=  10 ;
+	    }  while  ( integer ) ;
+
+	while  ( count )
+		output [ length ++ ]	=  digits [ -- count ] ;
+
+	return ( length ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_write_name -
+        Writes a column name, quoting it if needed.
+
+  ==============================================================================================================*/
+static void	csv_write_name ( const char *  name )
+   {
+	if  ( strchr ( name, csv_delimiter )  ==  NULL  &&  strchr ( name, '"' )  ==  NULL )
+	   {
+		fputs ( name, stdout ) ;
+		return ;
+	    }
+
+	putchar ( '"' ) ;
+
+	for  ( ; * name ; name ++ )
+	   {
+		if  ( * name  ==  '"' )
+			putchar ( '"' ) ;
+
+		putchar ( * name ) ;
+	    }
+
+	putchar ( '"' ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_reader -
+        Pipeline stage that reads the input into blocks of complete lines. The incomplete line at the end of
+	a block is carried over to the next one ; a block is enlarged when it does not contain any newline.
+
+  ==============================================================================================================*/
+EVAL_THREAD_FUNCTION ( csv_reader, arg )
+   {
+	char *		carry		=  NULL ;
+	size_t		carry_size	=  0,
+			carry_length	=  0 ;
+	int		last		=  0 ;
+	int		i ;
+
+
+	( void ) arg ;
+
+	for  ( i = 0 ; ! last ; i  =  ( i + 1 ) % CSV_SLOTS )
+	   {
+		csv_block *	block	=  csv_blocks + i ;
+		size_t		length,
+				end ;
+
+
+		csv_wait ( block, CSV_FREE ) ;
+
+		// One more byte is reserved for the newline added after an unterminated last line
+		block -> text	=  ( char * ) csv_reserve ( block -> text, & block -> text_size, carry_length + csv_block_size + 1 ) ;
+		length		=  carry_length ;
+
+		if  ( carry_length )
+			memcpy ( block -> text, carry, carry_length ) ;
+		end		=  0 ;
+
+		while  ( ! last )
+		   {
+			length	+=  fread ( block -> text + length, 1, block -> text_size - 1 - length, csv_input ) ;
+
+			if  ( ferror ( csv_input ) )
+				csv_fatal ( "Read error : %s", strerror ( errno ) ) ;
+
+			if  ( length  <  block -> text_size - 1 )
+			   {
+				last	=  1 ;
+				break ;
+			    }
+
+			for  ( end = length ; end  >  0  &&  block -> text [ end - 1 ]  !=  '\n' ; end -- )
+				;
+
+			if  ( end )
+				break ;
+
+			block -> text	=  ( char * ) csv_reserve ( block -> text, & block -> text_size, block -> text_size * 2 ) ;
+		    }
+
+		if  ( last )
+		   {
+			if  ( length  &&  block -> text [ length - 1 ]  !=  '\n' )
+				block -> text [ length ++ ]	=  '\n' ;
+
+			end	=  length ;
+		    }
+
+		carry_length	=  length - end ;
+		carry		=  ( char * ) csv_reserve ( carry, & carry_size, carry_length + 1 ) ;
+		memcpy ( carry, block -> text + end, carry_length ) ;
+
+		block -> start	=  0 ;
+		block -> length	=  end ;
+		block -> last	=  last ;
+		csv_post ( block, CSV_READ ) ;
+	    }
+
+	free ( carry ) ;
+
+	EVAL_THREAD_RETURN ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_parse_block -
+        Converts the referenced fields of each row of a block into numbers.
+
+  ==============================================================================================================*/
+static void	csv_parse_block ( csv_block *  block )
+   {
+	char *		p	=  block -> text + block -> start ;
+	char *		end	=  block -> text + block -> length ;
+	char *		q ;
+	int		count	=  0 ;
+	int		row	=  0 ;
+
+
+	// Count lines first, so that arrays are allocated once
+	for  ( q = p ; ( q = ( char * ) memchr ( q, '\n', end - q ) )  !=  NULL ; q ++ )
+		count ++ ;
+
+	if  ( count  >  block -> max_rows )
+	   {
+		free ( block -> lines ) ;
+		free ( block -> line_lengths ) ;
+		free ( block -> values ) ;
+		free ( block -> results ) ;
+
+		block -> max_rows	=  count ;
+		block -> lines		=  ( char ** ) malloc ( count * sizeof ( char * ) ) ;
+		block -> line_lengths	=  ( int * ) malloc ( count * sizeof ( int ) ) ;
+		block -> values		=  ( double * ) malloc ( ( csv_column_count + 1 ) * count * sizeof ( double ) ) ;
+		block -> results	=  ( double * ) malloc ( csv_expression_count * count * sizeof ( double ) ) ;
+
+		if  ( block -> lines  ==  NULL  ||  block -> line_lengths  ==  NULL  ||  block -> values  ==  NULL  ||  block -> results  ==  NULL )
+			csv_fatal ( "Out of memory" ) ;
+	    }
+
+	for  ( ; p  <  end ; p  =  q + 1 )
+	   {
+		char *		line	=  p ;
+		char *		line_end ;
+		char *		value_start ;
+		char *		value_end ;
+		int		field ;
+
+
+		q		=  ( char * ) memchr ( p, '\n', end - p ) ;
+		line_end	=  q ;
+
+		if  ( line_end  >  p  &&  line_end [-1]  ==  '\r' )
+			line_end -- ;
+
+		// Empty lines are ignored
+		if  ( line_end  ==  p )
+			continue ;
+
+		block -> lines [ row ]		=  line ;
+		block -> line_lengths [ row ]	=  ( int ) ( line_end - line ) ;
+
+		// Fields located after the last referenced one are not even looked at
+		for  ( field = 0 ; field  <=  csv_last_field ; field ++ )
+		   {
+			if  ( p  >  line_end )
+			   {
+				if  ( csv_field_map [ field ]  >=  0 )
+					block -> values [ csv_field_map [ field ] * block -> max_rows + row ]	=  csv_nan ;
+
+				continue ;
+			    }
+
+			p	=  csv_field ( p, line_end, & value_start, & value_end ) + 1 ;
+
+			if  ( csv_field_map [ field ]  >=  0 )
+				block -> values [ csv_field_map [ field ] * block -> max_rows + row ]	=  csv_parse_number ( value_start, value_end ) ;
+		    }
+
+		row ++ ;
+	    }
+
+	block -> rows	=  row ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_parser -
+        Pipeline stage that parses blocks.
+
+  ==============================================================================================================*/
+EVAL_THREAD_FUNCTION ( csv_parser, arg )
+   {
+	int		last	=  0 ;
+	int		i ;
+
+
+	( void ) arg ;
+
+	for  ( i = 0 ; ! last ; i  =  ( i + 1 ) % CSV_SLOTS )
+	   {
+		csv_wait ( csv_blocks + i, CSV_READ ) ;
+		csv_parse_block ( csv_blocks + i ) ;
+		last	=  csv_blocks [i]. last ;
+		csv_post ( csv_blocks + i, CSV_PARSED ) ;
+	    }
+
+	EVAL_THREAD_RETURN ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_writer -
+        Pipeline stage that writes the results of each row, preceded by the row itself with the -k option.
+
+  ==============================================================================================================*/
+static char	csv_output [ CSV_OUTPUT_SIZE ] ;
+
+
+EVAL_THREAD_FUNCTION ( csv_writer, arg )
+   {
+	size_t		length		=  0 ;
+	size_t		row_size	=  ( size_t ) csv_expression_count * ( CSV_NUMBER_SIZE + 1 ) + 1 ;
+	int		last		=  0 ;
+	int		i, row, e ;
+
+
+	( void ) arg ;
+
+	for  ( i = 0 ; ! last ; i  =  ( i + 1 ) % CSV_SLOTS )
+	   {
+		csv_block *	block	=  csv_blocks + i ;
+
+
+		csv_wait ( block, CSV_COMPUTED ) ;
+
+		for  ( row = 0 ; row  <  block -> rows ; row ++ )
+		   {
+			size_t		line_length	=  ( csv_keep ) ?  block -> line_lengths [ row ] : 0 ;
+
+
+			if  ( length + line_length + row_size  >  CSV_OUTPUT_SIZE )
+			   {
+				fwrite ( csv_output, 1, length, stdout ) ;
+				length	=  0 ;
+			    }
+
+			// Rows that do not fit in the buffer are written directly
+			if  ( line_length + row_size  >  CSV_OUTPUT_SIZE )
+			   {
+				fwrite ( block -> lines [ row ], 1, line_length, stdout ) ;
+				line_length	=  0 ;
+			    }
+			else
+			   {
+				memcpy ( csv_output + length, block -> lines [ row ], line_length ) ;
+				length	+=  line_length ;
+			    }
+
+			for  ( e = 0 ; e  <  csv_expression_count ; e ++ )
+			   {
+				if  ( e  ||  csv_keep )
+					csv_output [ length ++ ]	=  csv_delimiter ;
+
+				length	+=  csv_format ( block -> results [ e * block -> max_rows + row ], csv_output + length ) ;
+			    }
+
+			csv_output [ length ++ ]	=  '\n' ;
+		    }
+
+		last	=  block -> last ;
+		csv_post ( block, CSV_FREE ) ;
+	    }
+
+	fwrite ( csv_output, 1, length, stdout ) ;
+	fflush ( stdout ) ;
+
+	if  ( ferror ( stdout ) )
+		csv_fatal ( "Write error : %s", strerror ( errno ) ) ;
+
+	EVAL_THREAD_RETURN ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_read_header -
+        Extracts the column names from the first line of the first block, and maps the variables of each
+	expression to columns. Only columns referenced by at least one expression are parsed.
+
+  ==============================================================================================================*/
+static void	csv_read_header ( csv_block *  block )
+   {
+	char *		p	=  block -> text ;
+	char *		end ;
+	char *		value_start ;
+	char *		value_end ;
+	char **		names	=  NULL ;
+	size_t		names_size	=  0 ;
+	int		e, i, j ;
+
+
+	if  ( ! block -> length )
+		csv_fatal ( "Missing header line" ) ;
+
+	end		=  ( char * ) memchr ( p, '\n', block -> length ) ;
+	block -> start	=  end - p + 1 ;
+
+	if  ( end  >  p  &&  end [-1]  ==  '\r' )
+		end -- ;
+
+	// Split the header into trimmed names
+	for  ( ; p  <=  end ; p ++ )
+	   {
+		p	=  csv_field ( p, end, & value_start, & value_end ) ;
+
+		while  ( value_start  <  value_end  &&  isspace ( ( unsigned char ) * value_start ) )
+			value_start ++ ;
+
+		while  ( value_end  >  value_start  &&  isspace ( ( unsigned char ) value_end [-1] ) )
+			value_end -- ;
+
+		names		=  ( char ** ) csv_reserve ( names, & names_size, ( csv_field_count + 1 ) * sizeof ( char * ) ) ;
+		names [ csv_field_count ]	=  ( char * ) malloc ( value_end - value_start + 1 ) ;
+		memcpy ( names [ csv_field_count ], value_start, value_end - value_start ) ;
+		names [ csv_field_count ] [ value_end - value_start ]	=  '\0' ;
+		csv_field_count ++ ;
+	    }
+
+	csv_field_map	=  ( int * ) malloc ( csv_field_count * sizeof ( int ) ) ;
+
+	for  ( i = 0 ; i  <  csv_field_count ; i ++ )
+		csv_field_map [i]	=  -1 ;
+
+	// Map variables to fields, then fields to referenced columns
+	for  ( e = 0 ; e  <  csv_expression_count ; e ++ )
+	   {
+		csv_expression *	expression	=  csv_expressions + e ;
+		int			count		=  evaluator_get_variable_count ( expression -> program ) ;
+
+
+		expression -> columns	=  ( int * ) malloc ( ( count + 1 ) * sizeof ( int ) ) ;
+		expression -> inputs	=  ( const double ** ) malloc ( ( count + 1 ) * sizeof ( double * ) ) ;
+
+		for  ( j = 0 ; j  <  count ; j ++ )
+		   {
+			const char *	variable	=  evaluator_get_variable_name ( expression -> program, j ) ;
+
+
+			for  ( i = 0 ; i  <  csv_field_count  &&  strcmp ( names [i], variable ) ; i ++ )
+				;
+
+			if  ( i  ==  csv_field_count )
+				csv_fatal ( "Unknown column '%s' in expression '%s'", variable, expression -> text ) ;
+
+			if  ( csv_field_map [i]  <  0 )
+				csv_field_map [i]	=  csv_column_count ++ ;
+
+			if  ( i  >  csv_last_field )
+				csv_last_field	=  i ;
+
+			expression -> columns [j]	=  csv_field_map [i] ;
+		    }
+	    }
+
+	for  ( i = 0 ; i  <  csv_field_count ; i ++ )
+		free ( names [i] ) ;
+
+	free ( names ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_write_header -
+        Writes the names of the output columns, preceded by the input header with the -k option.
+
+  ==============================================================================================================*/
+static void	csv_write_header ( csv_block *  block )
+   {
+	size_t		length	=  block -> start - 1 ;
+	int		e ;
+
+
+	if  ( csv_keep )
+	   {
+		if  ( length  &&  block -> text [ length - 1 ]  ==  '\r' )
+			length -- ;
+
+		fwrite ( block -> text, 1, length, stdout ) ;
+	    }
+
+	for  ( e = 0 ; e  <  csv_expression_count ; e ++ )
+	   {
+		if  ( e  ||  csv_keep )
+			putchar ( csv_delimiter ) ;
+
+		csv_write_name ( csv_expressions [e]. name ) ;
+	    }
+
+	putchar ( '\n' ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_compile -
+        Compiles an expression, of the form "[name=]expression".
+
+  ==============================================================================================================*/
+static void	csv_compile ( csv_expression *  expression, char *  argument )
+   {
+	char *		p	=  argument ;
+
+
+	while  ( isalnum ( ( unsigned char ) * p )  ||  * p  ==  '_' )
+		p ++ ;
+
+	if  ( * p  ==  '='  &&  p  >  argument )
+	   {
+		expression -> name	=  ( char * ) malloc ( p - argument + 1 ) ;
+		memcpy ( expression -> name, argument, p - argument ) ;
+		expression -> name [ p - argument ]	=  '\0' ;
+		expression -> text	=  p + 1 ;
+	    }
+	else
+	   {
+		expression -> name	=  ( char * ) malloc ( strlen ( argument ) + 1 ) ;
+		expression -> text	=  argument ;
+		strcpy ( expression -> name, argument ) ;
+	    }
+
+	expression -> program	=  evaluator_compile_ex ( expression -> text, EVAL_COMPILE_DOUBLE ) ;
+
+	if  ( expression -> program  ==  NULL )
+		csv_fatal ( "Invalid expression '%s' : %s", expression -> text, evaluator_error ) ;
+    }
+
+
+/*==============================================================================================================
+
+    csv_usage -
+        Displays the command-line syntax.
+
+  ==============================================================================================================*/
+static void	csv_usage ( )
+   {
+	fprintf ( stderr,
+		"Usage : evalcsv [-b size] [-d delimiter] [-i file] [-j threads] [-k] [-p digits] [--] [name=]expression...\n"
+		"Applies expressions to each row of a CSV file, whose columns are referenced as $name.\n" ) ;
+
+	exit ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+
+	Main program.
+
+  ==============================================================================================================*/
+int	main ( int  argc, char **  argv )
+   {
+	char *		input_file	=  NULL ;
+	eval_thread	reader,
+			parser,
+			writer ;
+	int		last		=  0 ;
+	int		i, e, v ;
+
+
+	csv_nan		=  HUGE_VAL - HUGE_VAL ;
+
+	// Options
+	for  ( i = 1 ; i  <  argc  &&  argv [i] [0]  ==  '-'  &&  argv [i] [1] ; i ++ )
+	   {
+		char *		option		=  argv [i] ;
+		char *		value		=  NULL ;
+
+
+		if  ( ! strcmp ( option, "--" ) )
+		   {
+			i ++ ;
+			break ;
+		    }
+
+		if  ( option [2] )
+			csv_usage ( ) ;
+
+		if  ( strchr ( "bdijp", option [1] ) )
+		   {
+			if  ( ++ i  ==  argc )
+				csv_usage ( ) ;
+
+			value	=  argv [i] ;
+		    }
+
+		switch  ( option [1] )
+		   {
+			case	'b' :  csv_block_size	=  ( size_t ) atoi ( value ) * 1024 ;  break ;
+			case	'i' :  input_file	=  value ;  break ;
+			case	'j' :  evaluator_set_thread_count ( atoi ( value ) ) ;  break ;
+			case	'k' :  csv_keep		=  1 ;  break ;
+			case	'p' :  csv_precision	=  atoi ( value ) ;  break ;
+
+			case	'd' :
+				if  ( ! strcmp ( value, "tab" )  ||  ! strcmp ( value, "\\t" ) )
+					csv_delimiter	=  '\t' ;
+				else if  ( value [0]  &&  ! value [1]  &&  value [0]  !=  '"'  &&  value [0]  !=  '\n' )
+					csv_delimiter	=  value [0] ;
+				else
+					csv_usage ( ) ;
+				break ;
+
+			default :
+				csv_usage ( ) ;
+		    }
+	    }
+
+	if  ( i  ==  argc  ||  ! csv_block_size  ||  csv_precision  <  1  ||  csv_precision  >  CSV_MAX_PRECISION )
+		csv_usage ( ) ;
+
+	// Integers below this limit are written the same way by csv_format() and printf()
+	for  ( csv_integer_limit = 1, v = 0 ; v  <  csv_precision ; v ++ )
+		csv_integer_limit	*=  10 ;
+
+	// Compile expressions before reading anything
+	csv_expression_count	=  argc - i ;
+	csv_expressions		=  ( csv_expression * ) calloc ( csv_expression_count, sizeof ( csv_expression ) ) ;
+
+	for  ( e = 0 ; e  <  csv_expression_count ; e ++ )
+		csv_compile ( csv_expressions + e, argv [ i + e ] ) ;
+
+	if  ( input_file  ==  NULL )
+		csv_input	=  stdin ;
+	else if  ( ( csv_input = fopen ( input_file, "rb" ) )  ==  NULL )
+		csv_fatal ( "Cannot open file '%s' : %s", input_file, strerror ( errno ) ) ;
+
+	// The header is in the first block, which tells which columns have to be parsed
+	if  ( ! eval_thread_create ( & reader, csv_reader, NULL ) )
+		csv_fatal ( "Cannot create threads" ) ;
+
+	csv_wait ( csv_blocks, CSV_READ ) ;
+	csv_read_header ( csv_blocks ) ;
+	csv_write_header ( csv_blocks ) ;
+
+	if  ( ! eval_thread_create ( & parser, csv_parser, NULL )  ||  ! eval_thread_create ( & writer, csv_writer, NULL ) )
+		csv_fatal ( "Cannot create threads" ) ;
+
+	// The main thread evaluates parsed blocks
+	for  ( i = 0 ; ! last ; i  =  ( i + 1 ) % CSV_SLOTS )
+	   {
+		csv_block *	block	=  csv_blocks + i ;
+
+
+		csv_wait ( block, CSV_PARSED ) ;
+
+		for  ( e = 0 ; e  <  csv_expression_count  &&  block -> rows ; e ++ )
+		   {
+			csv_expression *	expression	=  csv_expressions + e ;
+
+
+			for  ( v = 0 ; v  <  evaluator_get_variable_count ( expression -> program ) ; v ++ )
+				expression -> inputs [v]	=  block -> values + expression -> columns [v] * block -> max_rows ;
+
+			if  ( ! evaluator_run_parallel ( expression -> program, block -> rows, expression -> inputs,
+						block -> results + e * block -> max_rows ) )
+				csv_fatal ( "Cannot evaluate '%s' : %s", expression -> text, evaluator_error ) ;
+		    }
+
+		last	=  block -> last ;
+		csv_post ( block, CSV_COMPUTED ) ;
+	    }
+
+	eval_thread_join ( reader ) ;
+	eval_thread_join ( parser ) ;
+	eval_thread_join ( writer ) ;
+
+	if  ( csv_input  !=  stdin )
+		fclose ( csv_input ) ;
+
+	for  ( i = 0 ; i  <  CSV_SLOTS ; i ++ )
+	   {
+		free ( csv_blocks [i]. text ) ;
+		free ( csv_blocks [i]. lines ) ;
+		free ( csv_blocks [i]. line_lengths ) ;
+		free ( csv_blocks [i]. values ) ;
+		free ( csv_blocks [i]. results ) ;
+	    }
+
+	for  ( e = 0 ; e  <  csv_expression_count ; e ++ )
+	   {
+		evaluator_free_program ( csv_expressions [e]. program ) ;
+		free ( csv_expressions [e]. name ) ;
+		free ( csv_expressions [e]. columns ) ;
+		free ( csv_expressions [e]. inputs ) ;
+	    }
+
+	free ( csv_expressions ) ;
+	free ( csv_field_map ) ;
+
+	return ( 0 ) ;
+    }
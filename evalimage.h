@@ -0,0 +1,668 @@
+/**************************************************************************************************************
+
+    NAME
+        evalimage.h
+
+    DESCRIPTION
+        Saving compiled programs to a file, and loading them back without parsing them again.
+	This file is included by eval.c
+
+	An image file holds any number of programs. It is position-independent : every reference is an offset
+	from the start of the file, so that the file can be mapped in memory at any address and used in place.
+	The bytecode of each program is stored exactly as eval_compute() executes it ; loading an image thus
+	only maps the file, checks it, and allocates one program structure per saved program, whose code
+	pointer refers to the mapped bytecode.
+
+	Bytecode instructions contain no pointer. Function calls reference an entry of a resolution table,
+	which gives the name of each function called by the programs of the image ; functions are looked up by
+	name when the image is loaded, so that images remain valid when the package is rebuilt or loaded at
+	another address. Constants are not referenced, since their values are stored in the bytecode.
+
+	The layout of an image is the following, all offsets being relative to the start of the file :
+
+	- An eval_image_header structure.
+	- The program table, an array of eval_image_program structures.
+	- The resolution table, an array of eval_image_function structures.
+	- For each program, its bytecode (aligned on EVAL_IMAGE_ALIGNMENT bytes), and the offsets of its
+	  variable names.
+	- The string pool, which holds NUL-terminated function and variable names.
+
+	Values are stored in the native format of the machine that wrote the image ; the header records the
+	byte order and the sizes of eval_double values and of instructions, and images written by another
+	kind of machine, or by a build using another eval_double type, are rejected.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+# ifndef	WIN32
+#	include	<sys/mman.h>
+#	include	<sys/stat.h>
+#	include	<fcntl.h>
+#	include	<unistd.h>
+# endif
+
+# include	<errno.h>
+
+
+/*==============================================================================================================
+
+	Image file format.
+
+  ==============================================================================================================*/
+# define	EVAL_IMAGE_MAGIC		"EVALIMG"		// Magic string, including its terminating NUL
+# define	EVAL_IMAGE_VERSION		1			// Incremented each time the format changes
+# define	EVAL_IMAGE_BYTE_ORDER		0x01020304		// Reads differently on machines having another byte order
+# define	EVAL_IMAGE_ALIGNMENT		16			// Alignment of bytecode within the image
+
+// Image header
+typedef struct  eval_image_header
+   {
+	char			magic [8] ;			// EVAL_IMAGE_MAGIC
+	unsigned int		version ;			// EVAL_IMAGE_VERSION
+	unsigned int		byte_order ;			// EVAL_IMAGE_BYTE_ORDER
+	unsigned int		value_size ;			// sizeof ( eval_double )
+	unsigned int		instruction_size ;		// sizeof ( eval_instruction )
+	unsigned int		file_size ;			// Size of the whole image
+	unsigned int		program_count ;			// Number of programs
+	unsigned int		programs ;			// Offset of the program table
+	unsigned int		function_count ;		// Number of entries in the resolution table
+	unsigned int		functions ;			// Offset of the resolution table
+    }  eval_image_header ;
+
+
+// Entry of the resolution table
+typedef struct  eval_image_function
+   {
+	unsigned int		name ;				// Offset of the function name
+    }  eval_image_function ;
+
+
+// Entry of the program table ; code is zero for empty programs
+typedef struct  eval_image_program
+   {
+	unsigned int		flags ;				// EVAL_COMPILE_* flags
+	unsigned int		code ;				// Offset of the bytecode
+	unsigned int		code_size ;			// Number of instructions, not including the final OPCODE_END
+	unsigned int		variables ;			// Offset of an array of variable name offsets, indexed by slot
+	unsigned int		variable_count ;		// Number of variables
+	unsigned int		cell_count ;			// Number of register cells
+    }  eval_image_program ;
+
+
+// A loaded image
+struct  evaluator_image
+   {
+	eval_arena		arena ;				// Holds this structure, the programs and their variable tables
+	const char *		base ;				// Mapped file
+	size_t			size ;				// Size of the mapped file
+# ifdef		WIN32
+	HANDLE			file ;				// File and mapping handles
+	HANDLE			mapping ;
+# endif
+	eval_function *		functions ;			// Resolved functions, shared by all the programs
+	int *			function_flags ;		// Flags of the resolved functions
+	eval_vector_function *	vector_functions ;		// Vector forms of the resolved functions
+	evaluator_function_definition **	definitions ;		// Definitions of the resolved functions
+	evaluator_program *	programs ;			// Loaded programs
+	int			program_count ;			// Number of programs
+    } ;
+
+
+// Buffer used to build an image before writing it
+typedef struct  eval_image_buffer
+   {
+	char *			data ;
+	size_t			size ;
+	size_t			allocated ;
+    }  eval_image_buffer ;
+
+
+/*==============================================================================================================
+
+    eval_image_append -
+        Appends size bytes to an image buffer, after padding it to the specified alignment, and returns the
+	offset of the appended data. data may be NULL, in which case zeroes are appended.
+
+  ==============================================================================================================*/
+static unsigned int	eval_image_append ( eval_image_buffer *  buffer, const void *  data, size_t  size, size_t  alignment )
+   {
+	size_t		offset		=  ( buffer -> size + alignment - 1 ) & ~ ( alignment - 1 ) ;
+
+
+	if  ( offset + size  >  buffer -> allocated )
+	   {
+		while  ( offset + size  >  buffer -> allocated )
+			buffer -> allocated	=  ( buffer -> allocated ) ?  buffer -> allocated * 2 : 65536 ;
+
+		buffer -> data	=  ( char * ) eval_realloc ( buffer -> data, buffer -> allocated ) ;
+	    }
+
+	memset ( buffer -> data + buffer -> size, 0, offset - buffer -> size ) ;
+
+	if  ( data  !=  NULL )
+		memcpy ( buffer -> data + offset, data, size ) ;
+	else
+		memset ( buffer -> data + offset, 0, size ) ;
+
+	buffer -> size	=  offset + size ;
+
+	return ( ( unsigned int ) offset ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_image_save -
+        Writes the specified programs to an image file. Returns 0 if a function called by a program is no
+	longer registered, or if the file cannot be written.
+
+  ==============================================================================================================*/
+static int	eval_image_save ( const char *  filename, evaluator_program **  programs, int  count )
+   {
+	eval_image_buffer		buffer		=  { NULL, 0, 0 } ;
+	eval_function *			functions ;
+	int				function_count	=  0 ;
+	int				max_functions	=  0 ;
+	evaluator_function_definition *	defs		=  ( evaluator_function_definition * ) eval_function_definitions. data ;
+	eval_image_header *		header ;
+	eval_image_program *		record ;
+	eval_instruction *		ip ;
+	unsigned int			code, variables, name ;
+	FILE *				fp ;
+	int				status		=  0 ;
+	int				i, j, k ;
+
+
+	// Collect the distinct functions called by the programs
+	for  ( i = 0 ; i  <  count ; i ++ )
+		max_functions	+=  programs [i] -> function_count ;
+
+	functions	=  ( eval_function * ) eval_malloc ( ( max_functions + 1 ) * sizeof ( eval_function ) ) ;
+
+	for  ( i = 0 ; i  <  count ; i ++ )
+	   {
+		for  ( j = 0 ; j  <  programs [i] -> function_count ; j ++ )
+		   {
+			for  ( k = 0 ; k  <  function_count  &&  functions [k]  !=  programs [i] -> functions [j] ; k ++ )
+				;
+
+			if  ( k  ==  function_count )
+				functions [ function_count ++ ]		=  programs [i] -> functions [j] ;
+		    }
+	    }
+
+	// Reserve the header, the program table and the resolution table ; they are filled once the offsets of
+	// the data they reference are known
+	eval_image_append ( & buffer, NULL, sizeof ( eval_image_header ), EVAL_IMAGE_ALIGNMENT ) ;
+	eval_image_append ( & buffer, NULL, count * sizeof ( eval_image_program ), sizeof ( unsigned int ) ) ;
+	eval_image_append ( & buffer, NULL, function_count * sizeof ( eval_image_function ), sizeof ( unsigned int ) ) ;
+
+	// Resolution table : functions are referenced by the name they have been registered with
+	for  ( i = 0 ; i  <  function_count ; i ++ )
+	   {
+		for  ( j = 0 ; j  <  eval_function_definitions. item_count  &&  defs [j]. func  !=  functions [i] ; j ++ )
+			;
+
+		if  ( j  ==  eval_function_definitions. item_count )
+		   {
+			eval_error ( E_EVAL_UNDEFINED_FUNCTION, -1, -1, "A function called by a program is no longer registered" ) ;
+			goto  SaveEnd ;
+		    }
+
+		name	=  eval_image_append ( & buffer, defs [j]. name, strlen ( defs [j]. name ) + 1, 1 ) ;
+		( ( eval_image_function * ) ( buffer. data + sizeof ( eval_image_header ) + count * sizeof ( eval_image_program ) ) ) [i]. name	=  name ;
+	    }
+
+	// Programs ; function indexes are translated from the function table of the program to the resolution table
+	for  ( i = 0 ; i  <  count ; i ++ )
+	   {
+		evaluator_program *	program		=  programs [i] ;
+
+
+		code		=  0 ;
+
+		if  ( program -> code  !=  NULL )
+		   {
+			code	=  eval_image_append ( & buffer, program -> code, ( program -> code_size + 1 ) * sizeof ( eval_instruction ), EVAL_IMAGE_ALIGNMENT ) ;
+
+			for  ( j = 0 ; j  <  program -> code_size ; j ++ )
+			   {
+				ip	=  ( eval_instruction * ) ( buffer. data + code ) + j ;
+
+				if  ( ip -> opcode  ==  OPCODE_FUNCTION_CALL )
+				   {
+					for  ( k = 0 ; functions [k]  !=  program -> functions [ ip -> value. function ] ; k ++ )
+						;
+
+					ip -> value. function	=  k ;
+				    }
+			    }
+		    }
+
+		variables	=  eval_image_append ( & buffer, NULL, program -> variable_count * sizeof ( unsigned int ), sizeof ( unsigned int ) ) ;
+
+		for  ( j = 0 ; j  <  program -> variable_count ; j ++ )
+		   {
+			name	=  eval_image_append ( & buffer, program -> variables [j], strlen ( program -> variables [j] ) + 1, 1 ) ;
+			( ( unsigned int * ) ( buffer. data + variables ) ) [j]		=  name ;
+		    }
+
+		record			=  ( eval_image_program * ) ( buffer. data + sizeof ( eval_image_header ) ) + i ;
+		record -> flags		=  ( unsigned int ) program -> flags ;
+		record -> code		=  code ;
+		record -> code_size	=  ( unsigned int ) program -> code_size ;
+		record -> variables	=  variables ;
+		record -> variable_count=  ( unsigned int ) program -> variable_count ;
+		record -> cell_count	=  ( unsigned int ) program -> cell_count ;
+	    }
+
+	if  ( buffer. size  >  0xFFFFFFFF )
+	   {
+		eval_error ( E_EVAL_IO_ERROR, -1, -1, "Program image is too large" ) ;
+		goto  SaveEnd ;
+	    }
+
+	// Header
+	header				=  ( eval_image_header * ) buffer. data ;
+	memcpy ( header -> magic, EVAL_IMAGE_MAGIC, sizeof ( header -> magic ) ) ;
+	header -> version		=  EVAL_IMAGE_VERSION ;
+	header -> byte_order		=  EVAL_IMAGE_BYTE_ORDER ;
+	header -> value_size		=  sizeof ( eval_double ) ;
+	header -> instruction_size	=  sizeof ( eval_instruction ) ;
+	header -> file_size		=  ( unsigned int ) buffer. size ;
+	header -> program_count		=  ( unsigned int ) count ;
+	header -> programs		=  sizeof ( eval_image_header ) ;
+	header -> function_count	=  ( unsigned int ) function_count ;
+	header -> functions		=  sizeof ( eval_image_header ) + count * sizeof ( eval_image_program ) ;
+
+	// Write the image
+	if  ( ( fp = fopen ( filename, "wb" ) )  ==  NULL )
+	   {
+		eval_error ( E_EVAL_IO_ERROR, -1, -1, "Cannot create file '%s' : %s", filename, strerror ( errno ) ) ;
+		goto  SaveEnd ;
+	    }
+
+	status	=  ( fwrite ( buffer. data, 1, buffer. size, fp )  ==  buffer. size ) ;
+
+	if  ( fclose ( fp )  ||  ! status )
+	   {
+		eval_error ( E_EVAL_IO_ERROR, -1, -1, "Cannot write file '%s' : %s", filename, strerror ( errno ) ) ;
+		status	=  0 ;
+	    }
+
+SaveEnd :
+	eval_free ( functions ) ;
+
+	if  ( buffer. data  !=  NULL )
+		eval_free ( buffer. data ) ;
+
+	return ( status ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_image_map, eval_image_unmap -
+        Map/unmap an image file in memory.
+
+  ==============================================================================================================*/
+static int	eval_image_map ( evaluator_image *  image, const char *  filename )
+   {
+# ifdef		WIN32
+	LARGE_INTEGER		size ;
+
+
+	image -> file		=  CreateFileA ( filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL ) ;
+	image -> mapping	=  NULL ;
+
+	if  ( image -> file  ==  INVALID_HANDLE_VALUE )
+	   {
+		eval_error ( E_EVAL_IO_ERROR, -1, -1, "Cannot open file '%s' (error %lu)", filename, GetLastError ( ) ) ;
+		return ( 0 ) ;
+	    }
+
+	if  ( ! GetFileSizeEx ( image -> file, & size )  ||  size. QuadPart  <  ( LONGLONG ) sizeof ( eval_image_header )  ||
+	      ( image -> mapping = CreateFileMappingA ( image -> file, NULL, PAGE_READONLY, 0, 0, NULL ) )  ==  NULL  ||
+	      ( image -> base = ( const char * ) MapViewOfFile ( image -> mapping, FILE_MAP_READ, 0, 0, 0 ) )  ==  NULL )
+	   {
+		eval_error ( E_EVAL_INVALID_IMAGE, -1, -1, "Cannot map file '%s' (error %lu)", filename, GetLastError ( ) ) ;
+
+		if  ( image -> mapping  !=  NULL )
+			CloseHandle ( image -> mapping ) ;
+
+		CloseHandle ( image -> file ) ;
+		return ( 0 ) ;
+	    }
+
+	image -> size	=  ( size_t ) size. QuadPart ;
+# else
+	struct stat	st ;
+	int		fd ;
+	void *		base ;
+
+
+	if  ( ( fd = open ( filename, O_RDONLY ) )  <  0 )
+	   {
+		eval_error ( E_EVAL_IO_ERROR, -1, -1, "Cannot open file '%s' : %s", filename, strerror ( errno ) ) ;
+		return ( 0 ) ;
+	    }
+
+	if  ( fstat ( fd, & st )  ||  st. st_size  <  ( off_t ) sizeof ( eval_image_header ) )
+	   {
+		eval_error ( E_EVAL_INVALID_IMAGE, -1, -1, "File '%s' is not a program image", filename ) ;
+		close ( fd ) ;
+		return ( 0 ) ;
+	    }
+
+	base	=  mmap ( NULL, ( size_t ) st. st_size, PROT_READ, MAP_PRIVATE, fd, 0 ) ;
+	close ( fd ) ;
+
+	if  ( base  ==  MAP_FAILED )
+	   {
+		eval_error ( E_EVAL_IO_ERROR, -1, -1, "Cannot map file '%s' : %s", filename, strerror ( errno ) ) ;
+		return ( 0 ) ;
+	    }
+
+	image -> base	=  ( const char * ) base ;
+	image -> size	=  ( size_t ) st. st_size ;
+# endif
+
+	return ( 1 ) ;
+    }
+
+
+static void	eval_image_unmap ( evaluator_image *  image )
+   {
+# ifdef		WIN32
+	UnmapViewOfFile ( image -> base ) ;
+	CloseHandle ( image -> mapping ) ;
+	CloseHandle ( image -> file ) ;
+# else
+	munmap ( ( void * ) image -> base, image -> size ) ;
+# endif
+    }
+
+
+/*==============================================================================================================
+
+    eval_image_verify -
+        Checks the bytecode of a loaded program : every reference must be within bounds, and the value stack
+	must not underflow. The max stack depth and max argument count of the program are computed from its
+	bytecode, rather than taken from the image, so that a corrupted image cannot make eval_compute() access
+	memory outside of its scratch area. The cost of the program is computed using the cost hints of the
+	functions found at load time.
+
+  ==============================================================================================================*/
+static int	eval_image_verify ( const evaluator_image *  image, evaluator_program *  program )
+   {
+	const eval_instruction *		ip ;
+	const evaluator_function_definition *	def ;
+	int					depth		=  0 ;
+	int					i ;
+
+
+	program -> max_depth	=  0 ;
+	program -> max_argc	=  0 ;
+	program -> cost		=  program -> code_size ;
+
+	for  ( i = 0, ip = program -> code ; i  <  program -> code_size ; i ++, ip ++ )
+	   {
+		switch  ( ip -> opcode )
+		   {
+			case	OPCODE_NUMBER :
+				depth ++ ;
+				break ;
+
+			case	OPCODE_VARIABLE :
+				if  ( ip -> argument  <  0  ||  ip -> argument  >=  program -> variable_count )
+					return ( 0 ) ;
+
+				depth ++ ;
+				break ;
+
+			case	OPCODE_REGISTER_RECALL :
+				if  ( ip -> argument  <  0  ||  ip -> argument  >=  program -> cell_count )
+					return ( 0 ) ;
+
+				depth ++ ;
+				break ;
+
+			case	OPCODE_REGISTER_SAVE :
+				if  ( ip -> argument  <  0  ||  ip -> argument  >=  program -> cell_count  ||  depth  <  1 )
+					return ( 0 ) ;
+				break ;
+
+			// The argument count must also match the definition of the function found at load time
+			case	OPCODE_FUNCTION_CALL :
+				if  ( ip -> value. function  <  0  ||  ip -> value. function  >=  program -> function_count  ||
+				      ip -> argument  <  0  ||  ip -> argument  >  depth )
+					return ( 0 ) ;
+
+				if  ( ip -> argument  >  program -> max_argc )
+					program -> max_argc	=  ip -> argument ;
+
+				def	=  image -> definitions [ ip -> value. function ] ;
+
+				if  ( ip -> argument  <  def -> min_args  ||  ip -> argument  >  def -> max_args )
+				   {
+					eval_error ( E_EVAL_INVALID_FUNCTION_ARGC, -1, -1, "Invalid number of arguments for function '%s'", def -> name ) ;
+					return ( 0 ) ;
+				    }
+
+				depth		-=  ip -> argument - 1 ;
+				program -> cost	+=  EVAL_FUNCTION_COST ( def -> cost ) - 1 ;
+				break ;
+
+			default :
+				if  ( ip -> opcode  <  OP_PLUS  ||  ip -> opcode  >  OP_FACTORIAL )
+					return ( 0 ) ;
+
+				if  ( EVAL_OPCODE_IS_UNARY ( ip -> opcode ) )
+				   {
+					if  ( depth  <  1 )
+						return ( 0 ) ;
+				    }
+				else
+				   {
+					if  ( depth  <  2 )
+						return ( 0 ) ;
+
+					depth -- ;
+				    }
+		    }
+
+		if  ( depth  >  program -> max_depth )
+			program -> max_depth	=  depth ;
+	    }
+
+	return ( ip -> opcode  ==  OPCODE_END  &&  depth  ==  1 ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_image_free -
+        Frees a loaded image, together with its programs.
+
+  ==============================================================================================================*/
+static void	eval_image_free ( evaluator_image *  image )
+   {
+	eval_arena	arena ;
+	int		i ;
+
+
+	for  ( i = 0 ; i  <  image -> program_count ; i ++ )
+		eval_jit_free ( image -> programs + i ) ;
+
+	eval_image_unmap ( image ) ;
+
+	// The image structure is freed together with its arena
+	arena	=  image -> arena ;
+	eval_arena_release ( & arena ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_image_load -
+        Maps an image file and builds the programs it contains. Returns NULL if the file cannot be read, is
+	not a valid image, or calls a function that is not registered.
+
+  ==============================================================================================================*/
+# define	EVAL_IMAGE_CHECK(offset, length)		\
+		( ( size_t ) ( offset )  <=  image -> size  &&  ( size_t ) ( length )  <=  image -> size - ( size_t ) ( offset ) )
+
+static evaluator_image *	eval_image_load ( const char *  filename )
+   {
+	eval_arena			arena ;
+	evaluator_image *		image ;
+	const eval_image_header *	header ;
+	const eval_image_program *	record ;
+	const eval_image_function *	function ;
+	const unsigned int *		names ;
+	evaluator_program *		program ;
+	evaluator_function_definition *	def ;
+	unsigned int			i, j ;
+
+
+	eval_arena_initialize ( & arena, NULL, 0 ) ;
+	image			=  ( evaluator_image * ) eval_arena_alloc ( & arena, sizeof ( evaluator_image ) ) ;
+	memset ( image, 0, sizeof ( evaluator_image ) ) ;
+	image -> arena		=  arena ;
+
+	if  ( ! eval_image_map ( image, filename ) )
+	   {
+		arena	=  image -> arena ;
+		eval_arena_release ( & arena ) ;
+		return ( NULL ) ;
+	    }
+
+	// Check that the image has been written by a compatible build
+	header		=  ( const eval_image_header * ) image -> base ;
+
+	if  ( memcmp ( header -> magic, EVAL_IMAGE_MAGIC, sizeof ( header -> magic ) ) )
+	   {
+		eval_error ( E_EVAL_INVALID_IMAGE, -1, -1, "File '%s' is not a program image", filename ) ;
+		goto  LoadError ;
+	    }
+
+	if  ( header -> version  !=  EVAL_IMAGE_VERSION  ||  header -> byte_order  !=  EVAL_IMAGE_BYTE_ORDER  ||
+	      header -> value_size  !=  sizeof ( eval_double )  ||  header -> instruction_size  !=  sizeof ( eval_instruction ) )
+	   {
+		eval_error ( E_EVAL_INVALID_IMAGE, -1, -1, "Program image '%s' has been written by an incompatible version", filename ) ;
+		goto  LoadError ;
+	    }
+
+	if  ( header -> file_size  !=  image -> size  ||
+	      ! EVAL_IMAGE_CHECK ( header -> programs, ( size_t ) header -> program_count * sizeof ( eval_image_program ) )  ||
+	      ! EVAL_IMAGE_CHECK ( header -> functions, ( size_t ) header -> function_count * sizeof ( eval_image_function ) )  ||
+	      header -> programs  %  sizeof ( unsigned int )  ||  header -> functions  %  sizeof ( unsigned int ) )
+		goto  InvalidImage ;
+
+	// Resolve functions by name
+	image -> functions	=  ( eval_function * ) eval_arena_alloc ( & image -> arena, ( header -> function_count + 1 ) * sizeof ( eval_function ) ) ;
+	image -> function_flags	=  ( int * ) eval_arena_alloc ( & image -> arena, ( header -> function_count + 1 ) * sizeof ( int ) ) ;
+	image -> vector_functions	=  ( eval_vector_function * ) eval_arena_alloc ( & image -> arena, 
+							( header -> function_count + 1 ) * sizeof ( eval_vector_function ) ) ;
+	image -> definitions	=  ( evaluator_function_definition ** ) eval_arena_alloc ( & image -> arena,
+							( header -> function_count + 1 ) * sizeof ( evaluator_function_definition * ) ) ;
+	function		=  ( const eval_image_function * ) ( image -> base + header -> functions ) ;
+
+	for  ( i = 0 ; i  <  header -> function_count ; i ++ )
+	   {
+		if  ( function [i]. name  >=  image -> size  ||  memchr ( image -> base + function [i]. name, 0, image -> size - function [i]. name )  ==  NULL )
+			goto  InvalidImage ;
+
+		def	=  ( evaluator_function_definition * ) eval_find_primitive ( & eval_function_definitions, ( char * ) image -> base + function [i]. name ) ;
+
+		if  ( def  ==  NULL )
+		   {
+			eval_error ( E_EVAL_UNDEFINED_FUNCTION, -1, -1, "Undefined function '%s' in program image '%s'",
+					image -> base + function [i]. name, filename ) ;
+			goto  LoadError ;
+		    }
+
+		image -> functions [i]		=  def -> func ;
+		image -> function_flags [i]	=  def -> flags ;
+		image -> vector_functions [i]	=  def -> vfunc ;
+		image -> definitions [i]	=  def ;
+	    }
+
+	// Build the programs ; their bytecode is used in place
+	image -> programs	=  ( evaluator_program * ) eval_arena_alloc ( & image -> arena, ( header -> program_count + 1 ) * sizeof ( evaluator_program ) ) ;
+	record			=  ( const eval_image_program * ) ( image -> base + header -> programs ) ;
+
+	for  ( i = 0 ; i  <  header -> program_count ; i ++, record ++ )
+	   {
+		program		=  image -> programs + i ;
+		memset ( program, 0, sizeof ( evaluator_program ) ) ;
+		image -> program_count ++ ;
+
+		// Besides the cells of user registers, each cell requires at least one save instruction
+		if  ( record -> code_size  >  image -> size  ||  record -> cell_count  >  record -> code_size + MAX_REGISTERS  ||
+		      ! EVAL_IMAGE_CHECK ( record -> variables, ( size_t ) record -> variable_count * sizeof ( unsigned int ) )  ||
+		      record -> variables  %  sizeof ( unsigned int ) )
+			goto  InvalidImage ;
+
+		if  ( record -> code )
+		   {
+			if  ( ! EVAL_IMAGE_CHECK ( record -> code, ( size_t ) ( record -> code_size + 1 ) * sizeof ( eval_instruction ) )  ||
+			      record -> code  %  EVAL_IMAGE_ALIGNMENT )
+				goto  InvalidImage ;
+
+			program -> code		=  ( eval_instruction * ) ( image -> base + record -> code ) ;
+		    }
+
+		program -> code_size		=  ( int ) record -> code_size ;
+		program -> flags		=  ( int ) record -> flags ;
+		program -> cell_count		=  ( int ) record -> cell_count ;
+		program -> functions		=  image -> functions ;
+		program -> function_flags	=  image -> function_flags ;
+		program -> vector_functions	=  image -> vector_functions ;
+		program -> function_count	=  ( int ) header -> function_count ;
+		program -> image		=  image ;
+
+		// Variable names are also used in place
+		names				=  ( const unsigned int * ) ( image -> base + record -> variables ) ;
+		program -> variable_count	=  ( int ) record -> variable_count ;
+		program -> variable_max		=  program -> variable_count ;
+		program -> variables		=  ( char ** ) eval_arena_alloc ( & image -> arena, ( record -> variable_count + 1 ) * sizeof ( char * ) ) ;
+
+		for  ( j = 0 ; j  <  record -> variable_count ; j ++ )
+		   {
+			if  ( names [j]  >=  image -> size  ||  memchr ( image -> base + names [j], 0, image -> size - names [j] )  ==  NULL )
+				goto  InvalidImage ;
+
+			program -> variables [j]	=  ( char * ) image -> base + names [j] ;
+		    }
+
+		if  ( program -> code  !=  NULL  &&  ! eval_image_verify ( image, program ) )
+		   {
+			if  ( eval_context -> error_number  ==  E_EVAL_OK )
+				goto  InvalidImage ;
+
+			goto  LoadError ;
+		    }
+
+		if  ( program -> flags & EVAL_COMPILE_JIT )
+			eval_jit_compile ( program ) ;
+	    }
+
+	return ( image ) ;
+
+InvalidImage :
+	eval_error ( E_EVAL_INVALID_IMAGE, -1, -1, "Program image '%s' is corrupted", filename ) ;
+
+LoadError :
+	eval_image_free ( image ) ;
+
+	return ( NULL ) ;
+    }
+
+# undef		EVAL_IMAGE_CHECK
@@ -0,0 +1,429 @@
+/**************************************************************************************************************
+
+    NAME
+        evalincremental.h
+
+    DESCRIPTION
+        Incremental evaluation of expression sets.
+	This file is included by eval.c
+
+	An incremental evaluator turns the bytecode of an expression set into a graph whose nodes are its
+	instructions : the operands of a node are the nodes that pushed the values it consumes, and the value
+	computed by each node is kept from one evaluation to the next. Register recalls, including the ones
+	generated by eval_cse() for subexpressions shared by several expressions, have the node that saved the
+	register as operand.
+
+	When the graph is built, each node records the variables it depends on, directly or through its
+	operands ; these dependencies are then inverted, so that each variable has the list of the nodes that
+	must be recomputed when its value changes. Calls to functions whose result may change with the same
+	arguments (see EVAL_FUNCTION_IS_STABLE()) depend on a pseudo-variable that is considered to change on
+	every update, so that they are called each time. Calls to pure functions that follow the trigonometric
+	units of the context depend on a second pseudo-variable, which only changes when an update is performed
+	with units that differ from the ones of the previous computation.
+
+	Since instructions are in reverse-polish order, operands always come before the nodes that use them ;
+	an update thus recomputes the nodes marked by the changed variables in a single ascending pass, each of
+	them finding up-to-date values in its operands.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+
+/*==============================================================================================================
+
+	Incremental evaluator structure.
+	Nodes are numbered like the instructions of the set program ; the operands of node i are
+	operands [ first_operand [i] ] to operands [ first_operand [i+1] - 1 ], and the nodes depending on
+	variable slot s are dependents [ first_dependent [s] ] to dependents [ first_dependent [s+1] - 1 ],
+	in ascending order. Slot variable_count is the pseudo-variable of calls to functions that are not stable,
+	and slot variable_count + 1 the one of calls to functions that depend on trigonometric units.
+	Everything is allocated from the arena of the structure.
+
+  ==============================================================================================================*/
+struct  evaluator_incremental
+   {
+	eval_arena			arena ;				// Arena holding this structure and everything it references
+	const evaluator_expression_set *	set ;			// Expression set being computed
+	int				node_count ;			// Number of nodes, ie of instructions
+	int *				first_operand ;			// Operands of each node
+	int *				operands ;
+	int *				first_dependent ;		// Nodes depending on each variable slot
+	int *				dependents ;
+	int *				outputs ;			// Node of the OPCODE_OUTPUT instruction of each result
+	eval_double *			values ;			// Last value computed by each node
+	eval_double *			variables ;			// Current variable values, indexed by slot
+	eval_double *			function_args ;			// Arguments of function calls
+	unsigned char *			dirty ;				// Nodes to be recomputed by the next update
+	unsigned char *			changed ;			// Variables changed since the last update
+	int				use_degrees ;			// Trigonometric units of the last computation
+    } ;
+
+
+/*==============================================================================================================
+
+    eval_incremental_compute_node -
+	Computes the value of the specified node from the values of its operands. Values are rounded to double
+	after each operation when the program is computed using doubles, so that results are the same as the
+	ones of evaluator_run_set().
+
+  ==============================================================================================================*/
+static void	eval_incremental_compute_node ( evaluator_incremental *  incremental, int  node )
+   {
+	const evaluator_program *	program		=  incremental -> set -> program ;
+	const eval_instruction *	ip		=  program -> code + node ;
+	const int *			operands	=  incremental -> operands + incremental -> first_operand [ node ] ;
+	eval_double *			values		=  incremental -> values ;
+	int				use_double	=  ( program -> flags & EVAL_COMPILE_DOUBLE ) ?  1 : 0 ;
+	eval_double			value		=  0 ;
+	int				j ;
+
+
+	switch  ( ip -> opcode )
+	   {
+		case	OPCODE_NUMBER :
+			value	=  ( use_double ) ?  ( eval_double ) ip -> fast_value : ip -> value. number ;
+			break ;
+
+		case	OPCODE_VARIABLE :
+			value	=  incremental -> variables [ ip -> argument ] ;
+
+			if  ( use_double )
+				value	=  ( double ) value ;
+			break ;
+
+		// Register saves leave their operand on the stack, and recalls have the save as operand
+		case	OPCODE_REGISTER_SAVE :
+		case	OPCODE_REGISTER_RECALL :
+		case	OPCODE_OUTPUT :
+			value	=  values [ operands [0] ] ;
+			break ;
+
+		case	OPCODE_FUNCTION_CALL :
+		   {
+			eval_function	func	=  program -> functions [ ip -> value. function ] ;
+			EVAL_STATS_DECLARE ( function_start )
+			EVAL_PROFILE_DECLARE ( profile_start )
+
+
+			for  ( j = 0 ; j  <  ip -> argument ; j ++ )
+				incremental -> function_args [j]	=  values [ operands [j] ] ;
+
+			EVAL_STATS_START ( function_start ) ;
+			EVAL_PROFILE_START ( profile_start ) ;
+			value	=  func ( ip -> argument, incremental -> function_args ) ;
+			EVAL_PROFILE_FUNCTION ( func, ip -> argument, profile_start, 1 ) ;
+			EVAL_STATS_STOP ( EVAL_PHASE_FUNCTION, function_start, 1 ) ;
+
+			if  ( use_double )
+				value	=  ( double ) value ;
+			break ;
+		    }
+
+		// Operators : the right operand comes last
+		default :
+		   {
+			eval_double	right	=  values [ operands [ ( EVAL_OPCODE_IS_UNARY ( ip -> opcode ) ) ?  0 : 1 ] ],
+					left	=  values [ operands [0] ] ;
+			EVAL_PROFILE_DECLARE ( operator_start )
+
+
+			EVAL_PROFILE_START ( operator_start ) ;
+# if	EVAL_LONG_DOUBLE
+			if  ( use_double )
+			   {
+				double		result	=  0 ;
+
+
+				eval_apply_operator_double ( ip -> opcode, ( double ) right, ( double ) left, & result ) ;
+				value	=  result ;
+			    }
+			else
+# endif
+				eval_apply_operator ( ip -> opcode, right, left, & value ) ;
+
+			EVAL_PROFILE_OPERATOR ( ip -> opcode, operator_start, 1 ) ;
+			break ;
+		    }
+	    }
+
+	values [ node ]		=  value ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_incremental_update -
+	Recomputes the nodes depending on the variables that changed since the last update, as well as the ones
+	calling functions that are not stable, and the ones calling angle functions when the trigonometric units
+	of the evaluating context changed ; then stores all the results into the results array. When
+	recomputed is not NULL, it receives the indexes of the results that have been recomputed.
+	Returns the number of recomputed results.
+
+  ==============================================================================================================*/
+static int	eval_incremental_update ( evaluator_incremental *  incremental, double *  results, int *  recomputed )
+   {
+	int		variable_count	=  incremental -> set -> program -> variable_count ;
+	int		low		=  incremental -> node_count,
+			high		=  -1 ;
+	int		count		=  0 ;
+	int		first, last, i, j ;
+
+
+	// Mark the nodes depending on each changed variable ; the pseudo-variable of functions that are not stable
+	// always changes, and the one of angle functions changes with the units of the context
+	incremental -> changed [ variable_count ]	=  1 ;
+
+	if  ( eval_use_degrees  !=  incremental -> use_degrees )
+	   {
+		incremental -> changed [ variable_count + 1 ]	=  1 ;
+		incremental -> use_degrees			=  eval_use_degrees ;
+	    }
+
+	for  ( i = 0 ; i  <=  variable_count + 1 ; i ++ )
+	   {
+		first	=  incremental -> first_dependent [i] ;
+		last	=  incremental -> first_dependent [ i + 1 ] - 1 ;
+
+		if  ( ! incremental -> changed [i]  ||  first  >  last )
+			continue ;
+
+		incremental -> changed [i]	=  0 ;
+
+		for  ( j = first ; j  <=  last ; j ++ )
+			incremental -> dirty [ incremental -> dependents [j] ]	=  1 ;
+
+		if  ( incremental -> dependents [ first ]  <  low )
+			low	=  incremental -> dependents [ first ] ;
+
+		if  ( incremental -> dependents [ last ]  >  high )
+			high	=  incremental -> dependents [ last ] ;
+	    }
+
+	// Operands come before the nodes using them, so a single pass recomputes everything in order
+	for  ( i = low ; i  <=  high ; i ++ )
+	   {
+		if  ( ! incremental -> dirty [i] )
+			continue ;
+
+		incremental -> dirty [i]	=  0 ;
+		eval_incremental_compute_node ( incremental, i ) ;
+
+		if  ( incremental -> set -> program -> code [i]. opcode  ==  OPCODE_OUTPUT )
+		   {
+			if  ( recomputed  !=  NULL )
+				recomputed [ count ]	=  incremental -> set -> program -> code [i]. argument ;
+
+			count ++ ;
+		    }
+	    }
+
+	for  ( i = 0 ; i  <  incremental -> set -> count ; i ++ )
+		results [i]	=  ( double ) incremental -> values [ incremental -> outputs [i] ] ;
+
+	return ( count ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_incremental_create -
+	Builds the graph of an expression set and computes all of its nodes using the specified variable values.
+
+  ==============================================================================================================*/
+static evaluator_incremental *	eval_incremental_create ( const evaluator_expression_set *  set, const eval_double *  values )
+   {
+	const evaluator_program *	program		=  set -> program ;
+	evaluator_incremental *		incremental ;
+	eval_arena			arena ;
+	eval_arena			scratch ;
+	char				scratch_buffer [ ARENA_COMPILE_BUFFER_SIZE ] ;
+	int				node_count	=  program -> code_size ;
+	int				slot_count	=  program -> variable_count + 2 ;
+	int				words		=  ( slot_count + 63 ) / 64 ;
+	unsigned long long *		masks ;
+	int *				stack ;
+	int *				cells ;
+	int *				next ;
+	int				top		=  -1 ;
+	int				argc, slot, i, j, k ;
+
+
+	eval_arena_initialize ( & arena, NULL, 0 ) ;
+	incremental		=  ( evaluator_incremental * ) eval_arena_alloc ( & arena, sizeof ( evaluator_incremental ) ) ;
+	incremental -> arena	=  arena ;
+	incremental -> set	=  set ;
+	incremental -> use_degrees	=  eval_use_degrees ;
+
+	incremental -> node_count	=  node_count ;
+	incremental -> first_operand	=  ( int * ) eval_arena_alloc ( & incremental -> arena, ( node_count + 1 ) * sizeof ( int ) ) ;
+	incremental -> operands		=  ( int * ) eval_arena_alloc ( & incremental -> arena, ( 2 * node_count + 1 ) * sizeof ( int ) ) ;
+	incremental -> first_dependent	=  ( int * ) eval_arena_alloc ( & incremental -> arena, ( slot_count + 1 ) * sizeof ( int ) ) ;
+	incremental -> outputs		=  ( int * ) eval_arena_alloc ( & incremental -> arena, set -> count * sizeof ( int ) ) ;
+	incremental -> values		=  ( eval_double * ) eval_arena_alloc ( & incremental -> arena, ( node_count + 1 ) * sizeof ( eval_double ) ) ;
+	incremental -> variables	=  ( eval_double * ) eval_arena_alloc ( & incremental -> arena, slot_count * sizeof ( eval_double ) ) ;
+	incremental -> function_args	=  ( eval_double * ) eval_arena_alloc ( & incremental -> arena, ( program -> max_argc + 1 ) * sizeof ( eval_double ) ) ;
+	incremental -> dirty		=  ( unsigned char * ) eval_arena_alloc ( & incremental -> arena, node_count + 1 ) ;
+	incremental -> changed		=  ( unsigned char * ) eval_arena_alloc ( & incremental -> arena, slot_count ) ;
+
+	for  ( i = 0 ; i  <  program -> variable_count ; i ++ )
+		incremental -> variables [i]	=  values [i] ;
+
+	memset ( incremental -> changed, 0, slot_count ) ;
+	memset ( incremental -> dirty, 0, node_count + 1 ) ;
+
+	// Simulate the value stack to find the operands of each node ; a node has one operand per value it pops,
+	// plus one for register recalls, so that operands [] holds at most two entries per node. Dependencies
+	// are collected in a bit mask per node
+	eval_arena_initialize ( & scratch, scratch_buffer, sizeof ( scratch_buffer ) ) ;
+	stack	=  ( int * ) eval_arena_alloc ( & scratch, ( program -> max_depth + 1 ) * sizeof ( int ) ) ;
+	cells	=  ( int * ) eval_arena_alloc ( & scratch, ( program -> cell_count + 1 ) * sizeof ( int ) ) ;
+	next	=  ( int * ) eval_arena_alloc ( & scratch, ( slot_count + 1 ) * sizeof ( int ) ) ;
+	masks	=  ( unsigned long long * ) eval_arena_alloc ( & scratch, ( node_count + 1 ) * words * sizeof ( unsigned long long ) ) ;
+
+	memset ( masks, 0, ( node_count + 1 ) * words * sizeof ( unsigned long long ) ) ;
+	k	=  0 ;
+
+	for  ( i = 0 ; i  <  node_count ; i ++ )
+	   {
+		const eval_instruction *	ip		=  program -> code + i ;
+		unsigned long long *		mask		=  masks + i * words ;
+
+
+		incremental -> first_operand [i]	=  k ;
+
+		switch  ( ip -> opcode )
+		   {
+			case	OPCODE_NUMBER :
+				argc	=  0 ;
+				break ;
+
+			case	OPCODE_VARIABLE :
+				argc				=  0 ;
+				mask [ ip -> argument / 64 ]   |=  1ULL  <<  ( ip -> argument % 64 ) ;
+				break ;
+
+			case	OPCODE_REGISTER_SAVE :
+				argc				=  1 ;
+				cells [ ip -> argument ]	=  i ;
+				break ;
+
+			// The operand of a register recall is the last save of its cell, which eval_link() has
+			// checked to come first
+			case	OPCODE_REGISTER_RECALL :
+				argc				=  0 ;
+				incremental -> operands [ k ++ ]	=  cells [ ip -> argument ] ;
+
+				for  ( j = 0 ; j  <  words ; j ++ )
+					mask [j]	|=  masks [ cells [ ip -> argument ] * words + j ] ;
+				break ;
+
+			case	OPCODE_OUTPUT :
+				argc					=  1 ;
+				incremental -> outputs [ ip -> argument ]	=  i ;
+				break ;
+
+			case	OPCODE_FUNCTION_CALL :
+				argc	=  ip -> argument ;
+
+				if  ( ! EVAL_FUNCTION_IS_STABLE ( program -> function_flags [ ip -> value. function ] ) )
+					slot	=  program -> variable_count ;
+				else if  ( program -> function_flags [ ip -> value. function ]  &  EVAL_FUNCTION_ANGLE )
+					slot	=  program -> variable_count + 1 ;
+				else
+					break ;
+
+				mask [ slot / 64 ]   |=  1ULL  <<  ( slot % 64 ) ;
+				break ;
+
+			default :
+				argc	=  ( EVAL_OPCODE_IS_UNARY ( ip -> opcode ) ) ?  1 : 2 ;
+				break ;
+		    }
+
+		// Pop the operands, in the order they were pushed
+		top	-=  argc ;
+
+		for  ( j = 1 ; j  <=  argc ; j ++ )
+		   {
+			int	operand		=  stack [ top + j ] ;
+			int	w ;
+
+
+			incremental -> operands [ k ++ ]	=  operand ;
+
+			for  ( w = 0 ; w  <  words ; w ++ )
+				mask [w]	|=  masks [ operand * words + w ] ;
+		    }
+
+		// Everything pushes its value, except outputs
+		if  ( ip -> opcode  !=  OPCODE_OUTPUT )
+			stack [ ++ top ]	=  i ;
+	    }
+
+	incremental -> first_operand [ node_count ]	=  k ;
+
+	// Invert the dependencies : count the nodes depending on each slot, then list them ; nodes are scanned in
+	// ascending order, so that the lists are sorted
+	memset ( incremental -> first_dependent, 0, ( slot_count + 1 ) * sizeof ( int ) ) ;
+
+	for  ( i = 0 ; i  <  node_count * words ; i ++ )
+	   {
+		for  ( j = 0 ; j  <  64  &&  masks [i]  >>  j ; j ++ )
+		   {
+			if  ( masks [i]  &  ( 1ULL  <<  j ) )
+				incremental -> first_dependent [ ( i % words ) * 64 + j + 1 ] ++ ;
+		    }
+	    }
+
+	for  ( j = 0 ; j  <  slot_count ; j ++ )
+	   {
+		incremental -> first_dependent [ j + 1 ]   +=  incremental -> first_dependent [j] ;
+		next [j]				=  incremental -> first_dependent [j] ;
+	    }
+
+	incremental -> dependents	=  ( int * ) eval_arena_alloc ( & incremental -> arena, ( incremental -> first_dependent [ slot_count ] + 1 ) * sizeof ( int ) ) ;
+
+	for  ( i = 0 ; i  <  node_count * words ; i ++ )
+	   {
+		for  ( j = 0 ; j  <  64  &&  masks [i]  >>  j ; j ++ )
+		   {
+			if  ( masks [i]  &  ( 1ULL  <<  j ) )
+				incremental -> dependents [ next [ ( i % words ) * 64 + j ] ++ ]	=  i / words ;
+		    }
+	    }
+
+	eval_arena_release ( & scratch ) ;
+
+	// Compute every node once
+	for  ( i = 0 ; i  <  node_count ; i ++ )
+		eval_incremental_compute_node ( incremental, i ) ;
+
+	return ( incremental ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_incremental_set_variable -
+	Changes the value of a variable ; the nodes depending on it will be recomputed by the next update if
+	the value is different from the current one.
+
+  ==============================================================================================================*/
+static void	eval_incremental_set_variable ( evaluator_incremental *  incremental, int  slot, eval_double  value )
+   {
+	eval_double	current		=  incremental -> variables [ slot ] ;
+
+
+	// NaN values are never equal, even to themselves
+	if  ( value  ==  current  ||  ( value  !=  value  &&  current  !=  current ) )
+		return ;
+
+	incremental -> variables [ slot ]	=  value ;
+	incremental -> changed [ slot ]		=  1 ;
+    }
@@ -0,0 +1,435 @@
+/**************************************************************************************************************
+
+    NAME
+        evaljit.h
+
+    DESCRIPTION
+        Native code generation for programs compiled with the EVAL_COMPILE_JIT flag.
+	This file is included by eval.c
+
+	The bytecode of a program is translated into x86-64 code, which is stored in an executable memory
+	area. Since the depth of the value stack is known for each instruction, every value stack entry is
+	assigned a fixed location in the stack frame of the generated function ; the value on top of the stack
+	is always held in the xmm0 register :
+	- Numeric values are loaded as immediate operands
+	- The +, -, *, / and unary minus operators are applied inline, using SSE2 instructions
+	- Other operators call a helper which uses the eval_apply_operator_double() function
+	- Function calls are resolved when the program is compiled, and the arguments are passed directly from
+	  the value stack area. When eval_double is a long double, arguments are converted by a helper
+	- Register cells are located after the value stack entries
+
+	The generated function has the following prototype :
+
+		void  code ( const double *  variables, double *  output ) ;
+
+	Programs that cannot be translated (for example, because a function is called with too many arguments)
+	are computed by the interpreter. Code generation is available on x86-64 processors running
+	an operating system that follows the System V calling conventions ; define the EVAL_NO_JIT macro to
+	disable it.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+
+/*==============================================================================================================
+
+	Platform support.
+
+  ==============================================================================================================*/
+# if	! defined ( EVAL_NO_JIT )  &&  defined ( __x86_64__ )  &&  ! defined ( WIN32 )  &&  ! defined ( _WIN32 )
+#	define	EVAL_JIT		1
+#	include	<sys/mman.h>
+# else
+#	define	EVAL_JIT		0
+# endif
+
+
+# if	EVAL_JIT
+
+// Max number of arguments of a function call, and max number of variables, when values have to be converted
+// from eval_double values
+# define	EVAL_JIT_MAX_ARGS		64
+# define	EVAL_JIT_MAX_VARIABLES		64
+
+// Size increment of the code buffer
+# define	EVAL_JIT_BUFFER_INCREMENT	1024
+
+// Generated function
+typedef void	( * eval_jit_function ) ( const double *  variables, double *  output ) ;
+
+// Code buffer, before being copied to executable memory
+typedef struct  eval_jit_buffer
+   {
+	unsigned char *		data ;
+	int			size ;
+	int			max ;
+    }  eval_jit_buffer ;
+
+
+/*==============================================================================================================
+
+    eval_jit_emit, eval_jit_emit_int32, eval_jit_emit_int64 -
+        Append bytes to a code buffer.
+
+  ==============================================================================================================*/
+static void	eval_jit_emit ( eval_jit_buffer *  buffer, const char *  bytes, int  count )
+   {
+	if  ( buffer -> size + count  >  buffer -> max )
+	   {
+		buffer -> max	=  NEXT_INCREMENT ( buffer -> size + count, EVAL_JIT_BUFFER_INCREMENT ) ;
+
+		if  ( buffer -> data  ==  NULL )
+			buffer -> data	=  ( unsigned char * ) eval_malloc ( buffer -> max ) ;
+		else
+			buffer -> data	=  ( unsigned char * ) eval_realloc ( buffer -> data, buffer -> max ) ;
+	    }
+
+	memcpy ( buffer -> data + buffer -> size, bytes, count ) ;
+	buffer -> size	+=  count ;
+    }
+
+
+static void	eval_jit_emit_int32 ( eval_jit_buffer *  buffer, int  value )
+   {
+	eval_jit_emit ( buffer, ( const char * ) & value, sizeof ( value ) ) ;
+    }
+
+
+static void	eval_jit_emit_int64 ( eval_jit_buffer *  buffer, unsigned long long  value )
+   {
+	eval_jit_emit ( buffer, ( const char * ) & value, sizeof ( value ) ) ;
+    }
+
+
+// Instructions referencing a value stack entry or a register cell, located at [rsp + 8 * slot]
+# define	EVAL_JIT_SLOT(buffer, opcode, slot)	( eval_jit_emit ( buffer, opcode, sizeof ( opcode ) - 1 ), eval_jit_emit_int32 ( buffer, ( slot ) * 8 ) )
+# define	EVAL_JIT_LOAD(buffer, slot)		EVAL_JIT_SLOT ( buffer, "\xF2\x0F\x10\x84\x24", slot )		// movsd xmm0, [rsp+disp32]
+# define	EVAL_JIT_STORE(buffer, slot)		EVAL_JIT_SLOT ( buffer, "\xF2\x0F\x11\x84\x24", slot )		// movsd [rsp+disp32], xmm0
+
+// Loads a 64-bit immediate value into rax, then calls the function it points to
+# define	EVAL_JIT_CALL(buffer, func)		\
+		( eval_jit_emit ( buffer, "\x48\xB8", 2 ), eval_jit_emit_int64 ( buffer, ( unsigned long long ) ( size_t ) ( func ) ), \
+		  eval_jit_emit ( buffer, "\xFF\xD0", 2 ) )
+
+
+/*==============================================================================================================
+
+    eval_jit_unary, eval_jit_binary, eval_jit_call -
+        Helpers called by the generated code for operators that are not applied inline, and for function
+	calls when eval_double is not a double.
+
+  ==============================================================================================================*/
+static double	eval_jit_unary ( int  type, double  value )
+   {
+	double		result	=  0 ;
+
+	eval_apply_operator_double ( type, value, 0, & result ) ;
+
+	return ( result ) ;
+    }
+
+
+static double	eval_jit_binary ( int  type, double  left, double  right )
+   {
+	double		result	=  0 ;
+
+	eval_apply_operator_double ( type, right, left, & result ) ;
+
+	return ( result ) ;
+    }
+
+
+# if	EVAL_LONG_DOUBLE
+static double	eval_jit_call ( eval_function  func, int  argc, const double *  argv )
+   {
+	eval_double	args [ EVAL_JIT_MAX_ARGS ] ;
+	int		i ;
+
+
+	for  ( i = 0 ; i  <  argc ; i ++ )
+		args [i]	=  argv [i] ;
+
+	return ( ( double ) func ( argc, args ) ) ;
+    }
+# endif
+
+
+/*==============================================================================================================
+
+    eval_jit_compile -
+        Generates native code for the specified program. Returns 0 if the program cannot be translated, in
+	which case it will be computed by the interpreter.
+
+  ==============================================================================================================*/
+static int	eval_jit_compile ( evaluator_program *  program )
+   {
+	eval_jit_buffer		buffer		=  { NULL, 0, 0 } ;
+	const eval_instruction *	ip ;
+	int			frame_size ;
+	int			top		=  -1 ;
+	int			status		=  1 ;
+	void *			code ;
+
+
+	if  ( program -> code  ==  NULL )
+		return ( 0 ) ;
+
+# if	EVAL_LONG_DOUBLE
+	if  ( program -> variable_count  >  EVAL_JIT_MAX_VARIABLES )
+		return ( 0 ) ;
+# endif
+
+	// Frame size, including alignment : rsp must be a multiple of 16 when calling a function
+	frame_size	=  ( ( ( program -> max_depth + program -> cell_count ) * 8 + 15 ) & ~15 ) + 8 ;
+
+	// push rbx ; push r12 ; mov rbx, rdi ; mov r12, rsi ; sub rsp, frame_size
+	eval_jit_emit ( & buffer, "\x53\x41\x54\x48\x89\xFB\x49\x89\xF4\x48\x81\xEC", 12 ) ;
+	eval_jit_emit_int32 ( & buffer, frame_size ) ;
+
+	for  ( ip = program -> code ; ip -> opcode  !=  OPCODE_END  &&  status ; ip ++ )
+	   {
+		switch  ( ip -> opcode )
+		   {
+			// mov rax, imm64 ; movq xmm0, rax
+			case	OPCODE_NUMBER :
+				if  ( top  >=  0 )
+					EVAL_JIT_STORE ( & buffer, top ) ;
+
+				eval_jit_emit ( & buffer, "\x48\xB8", 2 ) ;
+				eval_jit_emit ( & buffer, ( const char * ) & ip -> fast_value, 8 ) ;
+				eval_jit_emit ( & buffer, "\x66\x48\x0F\x6E\xC0", 5 ) ;
+				top ++ ;
+				break ;
+
+			// movsd xmm0, [rbx+disp32]
+			case	OPCODE_VARIABLE :
+				if  ( top  >=  0 )
+					EVAL_JIT_STORE ( & buffer, top ) ;
+
+				eval_jit_emit ( & buffer, "\xF2\x0F\x10\x83", 4 ) ;
+				eval_jit_emit_int32 ( & buffer, ip -> argument * 8 ) ;
+				top ++ ;
+				break ;
+
+			case	OPCODE_REGISTER_RECALL :
+				if  ( top  >=  0 )
+					EVAL_JIT_STORE ( & buffer, top ) ;
+
+				EVAL_JIT_LOAD ( & buffer, program -> max_depth + ip -> argument ) ;
+				top ++ ;
+				break ;
+
+			case	OPCODE_REGISTER_SAVE :
+				EVAL_JIT_STORE ( & buffer, program -> max_depth + ip -> argument ) ;
+				break ;
+
+			// Arguments are passed as a pointer to the first one, which is located in the value stack area
+			case	OPCODE_FUNCTION_CALL :
+			   {
+				eval_function		func	=  program -> functions [ ip -> value. function ] ;
+				int			argc	=  ip -> argument ;
+
+
+				if  ( top  >=  0 )
+					EVAL_JIT_STORE ( & buffer, top ) ;
+
+				top	-=  argc - 1 ;
+
+# if	EVAL_LONG_DOUBLE
+				if  ( argc  >  EVAL_JIT_MAX_ARGS )
+				   {
+					status	=  0 ;
+					break ;
+				    }
+
+				// mov rdi, func ; mov esi, argc ; lea rdx, [rsp+disp32] ; call eval_jit_call
+				eval_jit_emit ( & buffer, "\x48\xBF", 2 ) ;
+				eval_jit_emit_int64 ( & buffer, ( unsigned long long ) ( size_t ) func ) ;
+				eval_jit_emit ( & buffer, "\xBE", 1 ) ;
+				eval_jit_emit_int32 ( & buffer, argc ) ;
+				EVAL_JIT_SLOT ( & buffer, "\x48\x8D\x94\x24", top ) ;
+				EVAL_JIT_CALL ( & buffer, eval_jit_call ) ;
+# else
+				// mov edi, argc ; lea rsi, [rsp+disp32] ; call func
+				eval_jit_emit ( & buffer, "\xBF", 1 ) ;
+				eval_jit_emit_int32 ( & buffer, argc ) ;
+				EVAL_JIT_SLOT ( & buffer, "\x48\x8D\xB4\x24", top ) ;
+				EVAL_JIT_CALL ( & buffer, func ) ;
+# endif
+				break ;
+			    }
+
+			// Operators ; unknown opcodes are left to the interpreter
+			default :
+			   {
+				if  ( ip -> opcode  <  OP_PLUS  ||  ip -> opcode  >  OP_FACTORIAL )
+				   {
+					status	=  0 ;
+					break ;
+				    }
+
+				if  ( EVAL_OPCODE_IS_UNARY ( ip -> opcode ) )
+				   {
+					switch  ( ip -> opcode )
+					   {
+						case	OP_UNARY_PLUS :
+							break ;
+
+						// mov rax, 0x8000000000000000 ; movq xmm1, rax ; xorpd xmm0, xmm1
+						case	OP_UNARY_MINUS :
+							eval_jit_emit ( & buffer, "\x48\xB8", 2 ) ;
+							eval_jit_emit_int64 ( & buffer, 0x8000000000000000ULL ) ;
+							eval_jit_emit ( & buffer, "\x66\x48\x0F\x6E\xC8\x66\x0F\x57\xC1", 9 ) ;
+							break ;
+
+						// mov edi, type ; call eval_jit_unary
+						default :
+							eval_jit_emit ( & buffer, "\xBF", 1 ) ;
+							eval_jit_emit_int32 ( & buffer, ip -> opcode ) ;
+							EVAL_JIT_CALL ( & buffer, eval_jit_unary ) ;
+					    }
+
+					break ;
+				    }
+
+				// The right operand is in xmm0, and the left one at the location of the previous entry
+				top -- ;
+
+				switch  ( ip -> opcode )
+				   {
+					// addsd xmm0, [rsp+disp32]
+					case	OP_PLUS :
+						EVAL_JIT_SLOT ( & buffer, "\xF2\x0F\x58\x84\x24", top ) ;
+						break ;
+
+					// mulsd xmm0, [rsp+disp32]
+					case	OP_MUL :
+						EVAL_JIT_SLOT ( & buffer, "\xF2\x0F\x59\x84\x24", top ) ;
+						break ;
+
+					// movsd xmm1, xmm0 ; movsd xmm0, [rsp+disp32] ; subsd/divsd xmm0, xmm1
+					case	OP_MINUS :
+						eval_jit_emit ( & buffer, "\xF2\x0F\x10\xC8", 4 ) ;
+						EVAL_JIT_LOAD ( & buffer, top ) ;
+						eval_jit_emit ( & buffer, "\xF2\x0F\x5C\xC1", 4 ) ;
+						break ;
+
+					case	OP_DIV :
+						eval_jit_emit ( & buffer, "\xF2\x0F\x10\xC8", 4 ) ;
+						EVAL_JIT_LOAD ( & buffer, top ) ;
+						eval_jit_emit ( & buffer, "\xF2\x0F\x5E\xC1", 4 ) ;
+						break ;
+
+					// movsd xmm1, xmm0 ; movsd xmm0, [rsp+disp32] ; mov edi, type ; call eval_jit_binary
+					default :
+						eval_jit_emit ( & buffer, "\xF2\x0F\x10\xC8", 4 ) ;
+						EVAL_JIT_LOAD ( & buffer, top ) ;
+						eval_jit_emit ( & buffer, "\xBF", 1 ) ;
+						eval_jit_emit_int32 ( & buffer, ip -> opcode ) ;
+						EVAL_JIT_CALL ( & buffer, eval_jit_binary ) ;
+				    }
+
+				break ;
+			    }
+		    }
+	    }
+
+	if  ( status )
+	   {
+		// movsd [r12], xmm0 ; add rsp, frame_size ; pop r12 ; pop rbx ; ret
+		eval_jit_emit ( & buffer, "\xF2\x41\x0F\x11\x04\x24\x48\x81\xC4", 9 ) ;
+		eval_jit_emit_int32 ( & buffer, frame_size ) ;
+		eval_jit_emit ( & buffer, "\x41\x5C\x5B\xC3", 4 ) ;
+
+		// Copy the code to executable memory
+		code	=  mmap ( NULL, buffer. size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) ;
+
+		if  ( code  !=  MAP_FAILED )
+		   {
+			memcpy ( code, buffer. data, buffer. size ) ;
+
+			if  ( ! mprotect ( code, buffer. size, PROT_READ | PROT_EXEC ) )
+			   {
+				program -> jit_code	=  code ;
+				program -> jit_size	=  buffer. size ;
+			    }
+			else
+			   {
+				munmap ( code, buffer. size ) ;
+				status	=  0 ;
+			    }
+		    }
+		else
+			status	=  0 ;
+	    }
+
+	if  ( buffer. data  !=  NULL )
+		eval_free ( buffer. data ) ;
+
+	return ( status ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_jit_run -
+        Runs the native code of a program. variables may be NULL if the program does not reference any
+	variable.
+
+  ==============================================================================================================*/
+static int	eval_jit_run ( const evaluator_program *  program, eval_double *  output, const eval_double *  variables )
+   {
+	double		result ;
+
+# if	EVAL_LONG_DOUBLE
+	double		values [ EVAL_JIT_MAX_VARIABLES ] ;
+	int		i ;
+
+
+	for  ( i = 0 ; i  <  program -> variable_count ; i ++ )
+		values [i]	=  ( double ) variables [i] ;
+
+	( ( eval_jit_function ) program -> jit_code ) ( values, & result ) ;
+# else
+	( ( eval_jit_function ) program -> jit_code ) ( variables, & result ) ;
+# endif
+
+	* output	=  result ;
+
+	return ( 1 ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_jit_free -
+        Frees the native code of a program.
+
+  ==============================================================================================================*/
+static void	eval_jit_free ( evaluator_program *  program )
+   {
+	if  ( program -> jit_code  !=  NULL )
+		munmap ( program -> jit_code, program -> jit_size ) ;
+    }
+
+
+# else		/*  EVAL_JIT  */
+
+// Without a code generator, programs are always interpreted
+static int	eval_jit_compile ( evaluator_program *  program )
+   {
+	( void ) program ;
+
+	return ( 0 ) ;
+    }
+
+
+# define	eval_jit_free(program)
+
+# endif		/*  EVAL_JIT  */
@@ -0,0 +1,510 @@
+/**************************************************************************************************************
+
+    NAME
+        evalsimd.h
+
+    DESCRIPTION
+        AVX2 and AVX-512 kernels for the operators applied by the batch evaluation engine (evalbatch.h).
+	This file is included by eval.c
+
+	Each kernel applies one operator to an array of rows. The kernels to be used are selected once, when
+	the package is initialized, depending on the instruction sets supported by the processor ; operators
+	having no kernel for the current processor (or no kernel at all, such as the power operator which
+	requires a call to the math library) fall back to the scalar loops of evalbatch.h.
+
+	AVX2 does not provide double <-> 64-bit integer conversions ; the AVX2 kernels for bitwise operators
+	perform them using the "magic number" trick when all the operands of a vector are less than 2^51 in
+	absolute value, and fall back to scalar code otherwise. The AVX-512 kernels convert operands using
+	native instructions, but also fall back to scalar code for vectors holding values that do not fit into
+	a 64-bit integer, or shift counts outside the 0..63 range, since the results of the vector instructions
+	differ from the ones of the scalar code for such values.
+
+	The modulo kernels compute x - trunc ( x / y ) * y using a fused multiply-add, which gives the exact
+	result of fmod() when the truncated quotient is right ; since the division is rounded, the quotient may
+	be off by one when x / y is close to an integer, which shows in a remainder that is not smaller than y 
+	in absolute value or does not have the sign of x. Such vectors, as well as quotients of 2^51 or more,
+	infinities and NaNs, are computed by scalar code. AVX2 kernels are thus only used by processors that
+	also support FMA, which all AVX2 processors do in practice.
+
+	Define the EVAL_NO_SIMD macro to disable SIMD kernels.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+
+/*==============================================================================================================
+
+	Kernel type & dispatch table.
+	A kernel receives the same parameters as the eval_batch_operator() function.
+
+  ==============================================================================================================*/
+typedef void	( * eval_batch_kernel ) ( int  n, double *  output, const double *  a, const double *  b ) ;
+
+static eval_batch_kernel	eval_batch_kernels	[ OP_FACTORIAL + 1 ] ;
+
+
+/*==============================================================================================================
+
+	Compiler support.
+
+  ==============================================================================================================*/
+# if	! defined ( EVAL_NO_SIMD )  &&  ( defined ( __x86_64__ )  ||  defined ( __i386__ )  ||  defined ( _M_X64 ) )
+#	define	EVAL_SIMD		1
+# else
+#	define	EVAL_SIMD		0
+# endif
+
+
+# if	EVAL_SIMD
+
+# include	<immintrin.h>
+
+# if	defined ( __GNUC__ )
+#	define	EVAL_TARGET_AVX2		__attribute__ (( target ( "avx2,fma" ) ))
+#	define	EVAL_TARGET_AVX512		__attribute__ (( target ( "avx512f,avx512dq" ) ))
+# else
+#	include	<intrin.h>
+#	define	EVAL_TARGET_AVX2
+#	define	EVAL_TARGET_AVX512
+# endif
+
+
+// 2^51, the limit for exact double <-> integer conversions using the magic number below
+# define	EVAL_SIMD_INT_LIMIT		2251799813685248.0
+// 2^63, the limit for double -> 64-bit integer conversions
+# define	EVAL_SIMD_INT64_LIMIT		9223372036854775808.0
+// 2^52 + 2^51 : adding it to an integral double in the range ]-2^51..2^51[ puts the integer value in the low
+// order bits of the mantissa
+# define	EVAL_SIMD_INT_MAGIC		6755399441055744.0
+
+
+/*==============================================================================================================
+
+	Kernel generators.
+	vexpr is the vector expression computed from x and y (the vectors of left and right operands), sexpr the
+	scalar expression computed for the remaining rows from a [i] and b [i]. The *_UNARY_KERNEL macros build
+	the kernels of unary operators, which only have x and a [i].
+
+  ==============================================================================================================*/
+# define	EVAL_AVX2_KERNEL( name, vexpr, sexpr )							\
+	static EVAL_TARGET_AVX2 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		int		i ;									\
+													\
+		for  ( i = 0 ; i + 4  <=  n ; i += 4 )							\
+		   {											\
+			__m256d		x	=  _mm256_loadu_pd ( a + i ) ;				\
+			__m256d		y	=  _mm256_loadu_pd ( b + i ) ;				\
+													\
+			_mm256_storeu_pd ( output + i, vexpr ) ;					\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  sexpr ;								\
+	    }
+
+
+# define	EVAL_AVX2_UNARY_KERNEL( name, vexpr, sexpr )						\
+	static EVAL_TARGET_AVX2 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		int		i ;									\
+													\
+		( void ) b ;										\
+													\
+		for  ( i = 0 ; i + 4  <=  n ; i += 4 )							\
+		   {											\
+			__m256d		x	=  _mm256_loadu_pd ( a + i ) ;				\
+													\
+			_mm256_storeu_pd ( output + i, vexpr ) ;					\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  sexpr ;								\
+	    }
+
+
+# define	EVAL_AVX2_BITWISE_KERNEL( name, iexpr, sexpr )						\
+	static EVAL_TARGET_AVX2 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		__m256d		sign	=  _mm256_set1_pd ( -0.0 ),						\
+				limit	=  _mm256_set1_pd ( EVAL_SIMD_INT_LIMIT ),				\
+				magic	=  _mm256_set1_pd ( EVAL_SIMD_INT_MAGIC ) ;				\
+		__m256i		imagic	=  _mm256_castpd_si256 ( magic ) ;					\
+		int		i, j ;									\
+													\
+		for  ( i = 0 ; i + 4  <=  n ; i += 4 )							\
+		   {											\
+			__m256d		x	=  _mm256_round_pd ( _mm256_loadu_pd ( a + i ), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ) ;	\
+			__m256d		y	=  _mm256_round_pd ( _mm256_loadu_pd ( b + i ), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ) ;	\
+			__m256d		in_range	=  _mm256_and_pd (				\
+							_mm256_cmp_pd ( _mm256_andnot_pd ( sign, x ), limit, _CMP_LT_OQ ),	\
+							_mm256_cmp_pd ( _mm256_andnot_pd ( sign, y ), limit, _CMP_LT_OQ ) ) ;	\
+													\
+			if  ( _mm256_movemask_pd ( in_range )  ==  0x0F )				\
+			   {										\
+				__m256i		xi	=  _mm256_sub_epi64 ( _mm256_castpd_si256 ( _mm256_add_pd ( x, magic ) ), imagic ) ;	\
+				__m256i		yi	=  _mm256_sub_epi64 ( _mm256_castpd_si256 ( _mm256_add_pd ( y, magic ) ), imagic ) ;	\
+				__m256i		r	=  iexpr ;					\
+													\
+				_mm256_storeu_pd ( output + i, 						\
+					_mm256_sub_pd ( _mm256_castsi256_pd ( _mm256_add_epi64 ( r, imagic ) ), magic ) ) ;	\
+			    }										\
+			else										\
+			   {										\
+				for  ( j = i ; j  <  i + 4 ; j ++ )					\
+					output [j]	=  sexpr ( j ) ;					\
+			    }										\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  sexpr ( i ) ;							\
+	    }
+
+
+# define	EVAL_AVX2_BITWISE_UNARY_KERNEL( name, iexpr, sexpr )					\
+	static EVAL_TARGET_AVX2 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		__m256d		sign	=  _mm256_set1_pd ( -0.0 ),						\
+				limit	=  _mm256_set1_pd ( EVAL_SIMD_INT_LIMIT ),				\
+				magic	=  _mm256_set1_pd ( EVAL_SIMD_INT_MAGIC ) ;				\
+		__m256i		imagic	=  _mm256_castpd_si256 ( magic ) ;					\
+		int		i, j ;									\
+													\
+		( void ) b ;										\
+													\
+		for  ( i = 0 ; i + 4  <=  n ; i += 4 )							\
+		   {											\
+			__m256d		x	=  _mm256_round_pd ( _mm256_loadu_pd ( a + i ), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ) ;	\
+			__m256d		in_range	=  _mm256_cmp_pd ( _mm256_andnot_pd ( sign, x ), limit, _CMP_LT_OQ ) ;	\
+													\
+			if  ( _mm256_movemask_pd ( in_range )  ==  0x0F )				\
+			   {										\
+				__m256i		xi	=  _mm256_sub_epi64 ( _mm256_castpd_si256 ( _mm256_add_pd ( x, magic ) ), imagic ) ;	\
+				__m256i		r	=  iexpr ;					\
+													\
+				_mm256_storeu_pd ( output + i, 						\
+					_mm256_sub_pd ( _mm256_castsi256_pd ( _mm256_add_epi64 ( r, imagic ) ), magic ) ) ;	\
+			    }										\
+			else										\
+			   {										\
+				for  ( j = i ; j  <  i + 4 ; j ++ )					\
+					output [j]	=  sexpr ( j ) ;					\
+			    }										\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  sexpr ( i ) ;							\
+	    }
+
+
+# define	EVAL_AVX512_KERNEL( name, vexpr, sexpr )						\
+	static EVAL_TARGET_AVX512 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		int		i ;									\
+													\
+		for  ( i = 0 ; i + 8  <=  n ; i += 8 )							\
+		   {											\
+			__m512d		x	=  _mm512_loadu_pd ( a + i ) ;				\
+			__m512d		y	=  _mm512_loadu_pd ( b + i ) ;				\
+													\
+			_mm512_storeu_pd ( output + i, vexpr ) ;					\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  sexpr ;								\
+	    }
+
+
+# define	EVAL_AVX512_UNARY_KERNEL( name, vexpr, sexpr )						\
+	static EVAL_TARGET_AVX512 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		int		i ;									\
+													\
+		( void ) b ;										\
+													\
+		for  ( i = 0 ; i + 8  <=  n ; i += 8 )							\
+		   {											\
+			__m512d		x	=  _mm512_loadu_pd ( a + i ) ;				\
+													\
+			_mm512_storeu_pd ( output + i, vexpr ) ;					\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  sexpr ;								\
+	    }
+
+
+// icheck is an additional condition on the converted operands xi and yi, which must be true for the vector
+// expression to be used
+# define	EVAL_AVX512_BITWISE_KERNEL( name, iexpr, icheck, sexpr )				\
+	static EVAL_TARGET_AVX512 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		__m512d		sign	=  _mm512_set1_pd ( -0.0 ),						\
+				limit	=  _mm512_set1_pd ( EVAL_SIMD_INT64_LIMIT ) ;				\
+		int		i, j ;									\
+													\
+		for  ( i = 0 ; i + 8  <=  n ; i += 8 )							\
+		   {											\
+			__m512d		x	=  _mm512_loadu_pd ( a + i ) ;				\
+			__m512d		y	=  _mm512_loadu_pd ( b + i ) ;				\
+			__mmask8	in_range	=  _mm512_cmp_pd_mask ( _mm512_andnot_pd ( sign, x ), limit, _CMP_LT_OQ )  &	\
+							   _mm512_cmp_pd_mask ( _mm512_andnot_pd ( sign, y ), limit, _CMP_LT_OQ ) ;	\
+			__m512i		xi	=  _mm512_cvttpd_epi64 ( x ) ;				\
+			__m512i		yi	=  _mm512_cvttpd_epi64 ( y ) ;				\
+													\
+			if  ( in_range  ==  0xFF  &&  ( icheck ) )					\
+				_mm512_storeu_pd ( output + i, _mm512_cvtepi64_pd ( iexpr ) ) ;		\
+			else										\
+			   {										\
+				for  ( j = i ; j  <  i + 8 ; j ++ )					\
+					output [j]	=  sexpr ( j ) ;					\
+			    }										\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  sexpr ( i ) ;							\
+	    }
+
+
+# define	EVAL_AVX512_BITWISE_UNARY_KERNEL( name, iexpr, sexpr )				\
+	static EVAL_TARGET_AVX512 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		__m512d		sign	=  _mm512_set1_pd ( -0.0 ),						\
+				limit	=  _mm512_set1_pd ( EVAL_SIMD_INT64_LIMIT ) ;				\
+		int		i, j ;									\
+													\
+		( void ) b ;										\
+													\
+		for  ( i = 0 ; i + 8  <=  n ; i += 8 )							\
+		   {											\
+			__m512d		x	=  _mm512_loadu_pd ( a + i ) ;				\
+			__mmask8	in_range	=  _mm512_cmp_pd_mask ( _mm512_andnot_pd ( sign, x ), limit, _CMP_LT_OQ ) ;	\
+			__m512i		xi	=  _mm512_cvttpd_epi64 ( x ) ;				\
+													\
+			if  ( in_range  ==  0xFF )							\
+				_mm512_storeu_pd ( output + i, _mm512_cvtepi64_pd ( iexpr ) ) ;		\
+			else										\
+			   {										\
+				for  ( j = i ; j  <  i + 8 ; j ++ )					\
+					output [j]	=  sexpr ( j ) ;					\
+			    }										\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  sexpr ( i ) ;							\
+	    }
+
+
+// Remainder of x / y, or scalar fallback when its quotient has not been truncated correctly
+# define	EVAL_AVX2_MOD_KERNEL( name )								\
+	static EVAL_TARGET_AVX2 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		__m256d		sign	=  _mm256_set1_pd ( -0.0 ),						\
+				limit	=  _mm256_set1_pd ( EVAL_SIMD_INT_LIMIT ),				\
+				zero	=  _mm256_setzero_pd ( ) ;						\
+		int		i, j ;									\
+													\
+		for  ( i = 0 ; i + 4  <=  n ; i += 4 )							\
+		   {											\
+			__m256d		x	=  _mm256_loadu_pd ( a + i ) ;				\
+			__m256d		y	=  _mm256_loadu_pd ( b + i ) ;				\
+			__m256d		q	=  _mm256_div_pd ( x, y ) ;				\
+			__m256d		r	=  _mm256_fnmadd_pd ( _mm256_round_pd ( q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ), y, x ) ;	\
+			__m256d		valid	=  _mm256_and_pd (					\
+							_mm256_cmp_pd ( _mm256_andnot_pd ( sign, q ), limit, _CMP_LT_OQ ),	\
+							_mm256_cmp_pd ( _mm256_andnot_pd ( sign, r ), _mm256_andnot_pd ( sign, y ), _CMP_LT_OQ ) ) ;	\
+			__m256d		wrong_sign	=  _mm256_andnot_pd ( _mm256_cmp_pd ( r, zero, _CMP_EQ_OQ ), _mm256_xor_pd ( r, x ) ) ;	\
+													\
+			if  ( _mm256_movemask_pd ( valid )  ==  0x0F  &&  ! _mm256_movemask_pd ( wrong_sign ) )	\
+				_mm256_storeu_pd ( output + i, _mm256_or_pd ( r, _mm256_and_pd ( x, sign ) ) ) ;	\
+			else										\
+			   {										\
+				for  ( j = i ; j  <  i + 4 ; j ++ )					\
+					output [j]	=  fmod ( a [j], b [j] ) ;				\
+			    }										\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  fmod ( a [i], b [i] ) ;						\
+	    }
+
+
+# define	EVAL_AVX512_MOD_KERNEL( name )								\
+	static EVAL_TARGET_AVX512 void  name ( int  n, double *  output, const double *  a, const double *  b )	\
+	   {												\
+		__m512d		sign	=  _mm512_set1_pd ( -0.0 ),						\
+				limit	=  _mm512_set1_pd ( EVAL_SIMD_INT_LIMIT ),				\
+				zero	=  _mm512_setzero_pd ( ) ;						\
+		int		i, j ;									\
+													\
+		for  ( i = 0 ; i + 8  <=  n ; i += 8 )							\
+		   {											\
+			__m512d		x	=  _mm512_loadu_pd ( a + i ) ;				\
+			__m512d		y	=  _mm512_loadu_pd ( b + i ) ;				\
+			__m512d		q	=  _mm512_div_pd ( x, y ) ;				\
+			__m512d		r	=  _mm512_fnmadd_pd ( _mm512_roundscale_pd ( q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ), y, x ) ;	\
+			__mmask8	valid	=  _mm512_cmp_pd_mask ( _mm512_andnot_pd ( sign, q ), limit, _CMP_LT_OQ )  &	\
+						   _mm512_cmp_pd_mask ( _mm512_andnot_pd ( sign, r ), _mm512_andnot_pd ( sign, y ), _CMP_LT_OQ ) ;	\
+			__mmask8	wrong_sign	=  _mm512_movepi64_mask ( _mm512_castpd_si512 ( _mm512_xor_pd ( r, x ) ) )  &	\
+							   ~ _mm512_cmp_pd_mask ( r, zero, _CMP_EQ_OQ ) ;	\
+													\
+			if  ( valid  ==  0xFF  &&  ! wrong_sign )					\
+				_mm512_storeu_pd ( output + i, _mm512_or_pd ( r, _mm512_and_pd ( x, sign ) ) ) ;	\
+			else										\
+			   {										\
+				for  ( j = i ; j  <  i + 8 ; j ++ )					\
+					output [j]	=  fmod ( a [j], b [j] ) ;				\
+			    }										\
+		    }											\
+													\
+		for  ( ; i  <  n ; i ++ )								\
+			output [i]	=  fmod ( a [i], b [i] ) ;						\
+	    }
+
+
+// Shift counts accepted by the AVX-512 shift kernels
+# define	EVAL_AVX512_SHIFT_CHECK		( _mm512_cmplt_epu64_mask ( yi, _mm512_set1_epi64 ( 64 ) )  ==  0xFF )
+
+// Scalar expressions for bitwise operators, with the same semantics as eval_compute()
+# define	EVAL_SCALAR_AND( i )		( double ) ( ( ( eval_int ) a [i] )  &  ( ( eval_int ) b [i] ) )
+# define	EVAL_SCALAR_OR( i )		( double ) ( ( ( eval_int ) a [i] )  |  ( ( eval_int ) b [i] ) )
+# define	EVAL_SCALAR_XOR( i )		( double ) ( ( ( eval_int ) a [i] )  ^  ( ( eval_int ) b [i] ) )
+# define	EVAL_SCALAR_NOT( i )		( double ) ( ~ ( ( eval_int ) a [i] ) )
+# define	EVAL_SCALAR_SHL( i )		( double ) ( ( ( eval_int ) a [i] )  <<  ( ( eval_int ) b [i] ) )
+# define	EVAL_SCALAR_SHR( i )		( double ) ( ( ( eval_int ) a [i] )  >>  ( ( eval_int ) b [i] ) )
+
+
+/*==============================================================================================================
+
+	AVX2 kernels.
+	There are no AVX2 kernels for shifts, since AVX2 has no 64-bit arithmetic right shift.
+
+  ==============================================================================================================*/
+EVAL_AVX2_KERNEL ( eval_avx2_plus	, _mm256_add_pd ( x, y )			, a [i] + b [i] )
+EVAL_AVX2_KERNEL ( eval_avx2_minus	, _mm256_sub_pd ( x, y )			, a [i] - b [i] )
+EVAL_AVX2_KERNEL ( eval_avx2_mul	, _mm256_mul_pd ( x, y )			, a [i] * b [i] )
+EVAL_AVX2_KERNEL ( eval_avx2_div	, _mm256_div_pd ( x, y )			, a [i] / b [i] )
+EVAL_AVX2_KERNEL ( eval_avx2_idiv	, _mm256_floor_pd ( _mm256_div_pd ( x, y ) )	, floor ( a [i] / b [i] ) )
+EVAL_AVX2_UNARY_KERNEL ( eval_avx2_negate	, _mm256_xor_pd ( x, _mm256_set1_pd ( -0.0 ) )	, - a [i] )
+EVAL_AVX2_MOD_KERNEL ( eval_avx2_mod )
+
+EVAL_AVX2_BITWISE_KERNEL ( eval_avx2_and, _mm256_and_si256 ( xi, yi )					, EVAL_SCALAR_AND )
+EVAL_AVX2_BITWISE_KERNEL ( eval_avx2_or	, _mm256_or_si256  ( xi, yi )					, EVAL_SCALAR_OR  )
+EVAL_AVX2_BITWISE_KERNEL ( eval_avx2_xor, _mm256_xor_si256 ( xi, yi )					, EVAL_SCALAR_XOR )
+EVAL_AVX2_BITWISE_UNARY_KERNEL ( eval_avx2_not, _mm256_xor_si256 ( xi, _mm256_set1_epi64x ( -1 ) )		, EVAL_SCALAR_NOT )
+
+
+/*==============================================================================================================
+
+	AVX-512 kernels (requires the F and DQ extensions).
+
+  ==============================================================================================================*/
+EVAL_AVX512_KERNEL ( eval_avx512_plus	, _mm512_add_pd ( x, y )			, a [i] + b [i] )
+EVAL_AVX512_KERNEL ( eval_avx512_minus	, _mm512_sub_pd ( x, y )			, a [i] - b [i] )
+EVAL_AVX512_KERNEL ( eval_avx512_mul	, _mm512_mul_pd ( x, y )			, a [i] * b [i] )
+EVAL_AVX512_KERNEL ( eval_avx512_div	, _mm512_div_pd ( x, y )			, a [i] / b [i] )
+EVAL_AVX512_KERNEL ( eval_avx512_idiv	, _mm512_roundscale_pd ( _mm512_div_pd ( x, y ), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC ),
+										  floor ( a [i] / b [i] ) )
+EVAL_AVX512_UNARY_KERNEL ( eval_avx512_negate	, _mm512_xor_pd ( x, _mm512_set1_pd ( -0.0 ) )	, - a [i] )
+EVAL_AVX512_MOD_KERNEL ( eval_avx512_mod )
+
+EVAL_AVX512_BITWISE_KERNEL ( eval_avx512_and	, _mm512_and_si512  ( xi, yi )			, 1			, EVAL_SCALAR_AND )
+EVAL_AVX512_BITWISE_KERNEL ( eval_avx512_or	, _mm512_or_si512   ( xi, yi )			, 1			, EVAL_SCALAR_OR  )
+EVAL_AVX512_BITWISE_KERNEL ( eval_avx512_xor	, _mm512_xor_si512  ( xi, yi )			, 1			, EVAL_SCALAR_XOR )
+EVAL_AVX512_BITWISE_UNARY_KERNEL ( eval_avx512_not, _mm512_xor_si512  ( xi, _mm512_set1_epi64 ( -1 ) )			, EVAL_SCALAR_NOT )
+EVAL_AVX512_BITWISE_KERNEL ( eval_avx512_shl	, _mm512_sllv_epi64 ( xi, yi )			, EVAL_AVX512_SHIFT_CHECK	, EVAL_SCALAR_SHL )
+EVAL_AVX512_BITWISE_KERNEL ( eval_avx512_shr	, _mm512_srav_epi64 ( xi, yi )			, EVAL_AVX512_SHIFT_CHECK	, EVAL_SCALAR_SHR )
+
+
+/*==============================================================================================================
+
+    eval_simd_supports -
+        Checks for AVX2 and FMA (level 1) or AVX-512 F+DQ (level 2) support, including OS support for saving the
+	corresponding registers.
+
+  ==============================================================================================================*/
+static int	eval_simd_supports ( int  level )
+   {
+# if	defined ( __GNUC__ )
+	__builtin_cpu_init ( ) ;
+
+	if  ( level  ==  1 )
+		return ( __builtin_cpu_supports ( "avx2" )  &&  __builtin_cpu_supports ( "fma" ) ) ;
+	else
+		return ( __builtin_cpu_supports ( "avx512f" )  &&  __builtin_cpu_supports ( "avx512dq" ) ) ;
+# else
+	int			info [4] ;
+	unsigned __int64	xcr0 ;
+
+
+	__cpuid ( info, 0 ) ;
+
+	if  ( info [0]  <  7 )
+		return ( 0 ) ;
+
+	// FMA, OSXSAVE and AVX
+	__cpuid ( info, 1 ) ;
+
+	if  ( ( info [2]  &  ( ( 1 << 12 ) | ( 1 << 27 ) | ( 1 << 28 ) ) )  !=  ( ( 1 << 12 ) | ( 1 << 27 ) | ( 1 << 28 ) ) )
+		return ( 0 ) ;
+
+	xcr0	=  _xgetbv ( 0 ) ;
+	__cpuidex ( info, 7, 0 ) ;
+
+	if  ( level  ==  1 )
+		return ( ( xcr0  &  0x06 )  ==  0x06  &&  ( info [1]  &  ( 1 << 5 ) ) ) ;
+	else
+		return ( ( xcr0  &  0xE6 )  ==  0xE6  &&  ( info [1]  &  ( 1 << 16 ) )  &&  ( info [1]  &  ( 1 << 17 ) ) ) ;
+# endif
+    }
+
+# endif		/*  EVAL_SIMD  */
+
+
+/*==============================================================================================================
+
+    eval_simd_initialize -
+        Selects the kernels to be used for the current processor. Called once by eval_initialize().
+
+  ==============================================================================================================*/
+static void	eval_simd_initialize ( )
+   {
+# if	EVAL_SIMD
+	if  ( eval_simd_supports ( 2 ) )
+	   {
+		eval_batch_kernels [ OP_PLUS		]	=  eval_avx512_plus ;
+		eval_batch_kernels [ OP_MINUS		]	=  eval_avx512_minus ;
+		eval_batch_kernels [ OP_MUL		]	=  eval_avx512_mul ;
+		eval_batch_kernels [ OP_DIV		]	=  eval_avx512_div ;
+		eval_batch_kernels [ OP_IDIV		]	=  eval_avx512_idiv ;
+		eval_batch_kernels [ OP_MOD		]	=  eval_avx512_mod ;
+		eval_batch_kernels [ OP_UNARY_MINUS	]	=  eval_avx512_negate ;
+		eval_batch_kernels [ OP_AND		]	=  eval_avx512_and ;
+		eval_batch_kernels [ OP_OR		]	=  eval_avx512_or ;
+		eval_batch_kernels [ OP_XOR		]	=  eval_avx512_xor ;
+		eval_batch_kernels [ OP_NOT		]	=  eval_avx512_not ;
+		eval_batch_kernels [ OP_SHL		]	=  eval_avx512_shl ;
+		eval_batch_kernels [ OP_SHR		]	=  eval_avx512_shr ;
+	    }
+	else if  ( eval_simd_supports ( 1 ) )
+	   {
+		eval_batch_kernels [ OP_PLUS		]	=  eval_avx2_plus ;
+		eval_batch_kernels [ OP_MINUS		]	=  eval_avx2_minus ;
+		eval_batch_kernels [ OP_MUL		]	=  eval_avx2_mul ;
+		eval_batch_kernels [ OP_DIV		]	=  eval_avx2_div ;
+		eval_batch_kernels [ OP_IDIV		]	=  eval_avx2_idiv ;
+		eval_batch_kernels [ OP_MOD		]	=  eval_avx2_mod ;
+		eval_batch_kernels [ OP_UNARY_MINUS	]	=  eval_avx2_negate ;
+		eval_batch_kernels [ OP_AND		]	=  eval_avx2_and ;
+		eval_batch_kernels [ OP_OR		]	=  eval_avx2_or ;
+		eval_batch_kernels [ OP_XOR		]	=  eval_avx2_xor ;
+		eval_batch_kernels [ OP_NOT		]	=  eval_avx2_not ;
+	    }
+# endif
+    }
@@ -0,0 +1,351 @@
+/**************************************************************************************************************
+
+    NAME
+        evalstats.h
+
+    DESCRIPTION
+        Measurement of the time spent in each phase of the evaluation, and in each function and operator.
+	This file is included by eval.c
+
+	When EVAL_INSTRUMENTATION is non-zero, the EVAL_STATS_* macros read a nanosecond clock before and after
+	each phase, and add the elapsed time to the statistics of the current context. When EVAL_PROFILER is
+	non-zero, the EVAL_PROFILE_* macros do the same for each function call and each operator, and also
+	count calls by number of arguments. Otherwise, these macros expand to nothing, so that measures have
+	no cost at all.
+
+	A measure may cover several operations ; batch evaluation, for example, calls a function once for each
+	row of a block, and measures the whole block. The histogram then receives one entry per operation,
+	in the bucket of the average duration.
+
+	Pool threads used by evaluator_run_parallel() have their own context ; their statistics and profile
+	are added to the context of the calling thread once all the rows have been computed.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+# if	EVAL_INSTRUMENTATION  ||  EVAL_PROFILER
+
+# ifndef	WIN32
+#	include	<time.h>
+# endif
+
+
+// Nanoseconds
+typedef unsigned long long	eval_stats_time ;
+
+
+/*==============================================================================================================
+
+    eval_stats_now -
+        Returns the value of a monotonic clock, in nanoseconds.
+
+  ==============================================================================================================*/
+static eval_stats_time	eval_stats_now ( )
+   {
+# ifdef		WIN32
+	static LARGE_INTEGER	frequency ;
+	LARGE_INTEGER		counter ;
+
+
+	if  ( ! frequency. QuadPart )
+		QueryPerformanceFrequency ( & frequency ) ;
+
+	QueryPerformanceCounter ( & counter ) ;
+
+	// Split the conversion, so that it does not overflow
+	return ( ( eval_stats_time ) ( counter. QuadPart / frequency. QuadPart ) * 1000000000ULL +
+		 ( eval_stats_time ) ( counter. QuadPart % frequency. QuadPart ) * 1000000000ULL / ( eval_stats_time ) frequency. QuadPart ) ;
+# else
+	struct timespec		now ;
+
+
+	clock_gettime ( CLOCK_MONOTONIC, & now ) ;
+
+	return ( ( eval_stats_time ) now. tv_sec * 1000000000ULL + ( eval_stats_time ) now. tv_nsec ) ;
+# endif
+    }
+
+# endif		/*  EVAL_INSTRUMENTATION  ||  EVAL_PROFILER  */
+
+
+# if	EVAL_INSTRUMENTATION
+
+
+/*==============================================================================================================
+
+    eval_stats_record -
+        Adds a measure of count operations, which took elapsed nanoseconds, to the statistics of the
+	current context.
+
+  ==============================================================================================================*/
+static void	eval_stats_record ( int  phase, eval_stats_time  elapsed, int  count )
+   {
+	evaluator_phase_statistics *	statistics	=  & eval_context -> statistics ;
+	eval_stats_time			average		=  elapsed / count ;
+	int				bucket		=  0 ;
+
+
+	while  ( average  &&  bucket  <  EVAL_HISTOGRAM_BUCKETS - 1 )
+	   {
+		average		>>=  1 ;
+		bucket ++ ;
+	    }
+
+	statistics -> count [ phase ]			+=  count ;
+	statistics -> nanoseconds [ phase ]		+=  elapsed ;
+	statistics -> histogram [ phase ] [ bucket ]	+=  count ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_stats_merge -
+        Adds the statistics of one context to another one, and resets them.
+
+  ==============================================================================================================*/
+static void	eval_stats_merge ( evaluator_phase_statistics *  target, evaluator_phase_statistics *  source )
+   {
+	int		i, j ;
+
+
+	for  ( i = 0 ; i  <  EVAL_PHASE_COUNT ; i ++ )
+	   {
+		target -> count [i]		+=  source -> count [i] ;
+		target -> nanoseconds [i]	+=  source -> nanoseconds [i] ;
+
+		for  ( j = 0 ; j  <  EVAL_HISTOGRAM_BUCKETS ; j ++ )
+			target -> histogram [i] [j]	+=  source -> histogram [i] [j] ;
+	    }
+
+	memset ( source, 0, sizeof ( evaluator_phase_statistics ) ) ;
+    }
+
+
+/*==============================================================================================================
+
+	Measurement macros. EVAL_STATS_DECLARE() declares the variable holding the start time of a measure,
+	and must be used without a trailing semicolon.
+
+  ==============================================================================================================*/
+# define	EVAL_STATS_DECLARE( start )			eval_stats_time  start ;
+# define	EVAL_STATS_START( start )			( start = eval_stats_now ( ) )
+# define	EVAL_STATS_STOP( phase, start, count )		eval_stats_record ( phase, eval_stats_now ( ) - start, count )
+
+# else		/*  EVAL_INSTRUMENTATION  */
+
+# define	EVAL_STATS_DECLARE( start )
+# define	EVAL_STATS_START( start )			( ( void ) 0 )
+# define	EVAL_STATS_STOP( phase, start, count )		( ( void ) 0 )
+
+# endif		/*  EVAL_INSTRUMENTATION  */
+
+
+# if	EVAL_PROFILER
+
+// Initial number of slots of the function profile of a context
+# define	EVAL_PROFILE_INITIAL_SLOTS	64
+
+// Names of the operators, indexed by opcode
+static const char *		eval_profile_operator_names []	=
+   {
+	NULL,
+	"+", "-", "*", "/", "\\", "**", "%", "&", "|", "^", "~", "+", "-", "<<", ">>", "!"
+    } ;
+
+// Time taken by reading the clock twice, which is deducted from each measure
+static eval_stats_time		eval_profile_overhead ;
+
+
+/*==============================================================================================================
+
+    eval_profile_initialize -
+        Measures the cost of reading the clock ; called once by eval_initialize().
+
+  ==============================================================================================================*/
+static void	eval_profile_initialize ( )
+   {
+	eval_stats_time		start, elapsed ;
+	int			i ;
+
+
+	eval_profile_overhead	=  ( eval_stats_time ) -1 ;
+
+	for  ( i = 0 ; i  <  100 ; i ++ )
+	   {
+		start	=  eval_stats_now ( ) ;
+		elapsed	=  eval_stats_now ( ) - start ;
+
+		if  ( elapsed  <  eval_profile_overhead )
+			eval_profile_overhead	=  elapsed ;
+	    }
+    }
+
+
+/*==============================================================================================================
+
+    eval_profile_add -
+        Adds a measure of count calls with argc arguments, which took elapsed nanoseconds, to a profile entry.
+
+  ==============================================================================================================*/
+static void	eval_profile_add ( evaluator_profile_entry *  entry, int  argc, eval_stats_time  elapsed, int  count )
+   {
+	entry -> calls			+=  count ;
+	entry -> nanoseconds		+=  ( elapsed  >  eval_profile_overhead ) ?  elapsed - eval_profile_overhead : 0 ;
+	entry -> argc [ ( argc  <  EVAL_PROFILE_ARGC_BUCKETS - 1 ) ?  argc : EVAL_PROFILE_ARGC_BUCKETS - 1 ]	+=  count ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_profile_lookup -
+        Returns the profile entry of the specified function in the hash table of a context, creating it if
+	needed. The table is kept at most half full, so that lookups are short.
+
+  ==============================================================================================================*/
+static evaluator_profile_entry *	eval_profile_lookup ( evaluator_context *  context, eval_function  function )
+   {
+	eval_profile_slot *	slots ;
+	size_t			mask ;
+	size_t			i ;
+
+
+	if  ( 2 * ( context -> function_profile_count + 1 )  >  context -> function_profile_size )
+	   {
+		eval_profile_slot *	old_slots	=  context -> function_profile ;
+		int			old_size	=  context -> function_profile_size ;
+		int			size		=  ( old_size ) ?  old_size * 2 : EVAL_PROFILE_INITIAL_SLOTS ;
+		int			j ;
+
+
+		slots	=  ( eval_profile_slot * ) eval_malloc ( size * sizeof ( eval_profile_slot ) ) ;
+		memset ( slots, 0, size * sizeof ( eval_profile_slot ) ) ;
+
+		context -> function_profile		=  slots ;
+		context -> function_profile_size	=  size ;
+		context -> function_profile_count	=  0 ;
+
+		for  ( j = 0 ; j  <  old_size ; j ++ )
+		   {
+			if  ( old_slots [j]. function  !=  NULL )
+				* eval_profile_lookup ( context, old_slots [j]. function )	=  old_slots [j]. entry ;
+		    }
+
+		if  ( old_slots  !=  NULL )
+			eval_free ( old_slots ) ;
+	    }
+
+	slots	=  context -> function_profile ;
+	mask	=  ( size_t ) context -> function_profile_size - 1 ;
+	i	=  ( ( size_t ) function  >>  4 ) * 2654435761u  &  mask ;
+
+	while  ( slots [i]. function  !=  NULL  &&  slots [i]. function  !=  function )
+		i	=  ( i + 1 )  &  mask ;
+
+	if  ( slots [i]. function  ==  NULL )
+	   {
+		slots [i]. function	=  function ;
+		context -> function_profile_count ++ ;
+	    }
+
+	return ( & slots [i]. entry ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_profile_function, eval_profile_operator -
+        Add a measure of count calls to a function or an operator to the profile of the current context.
+
+  ==============================================================================================================*/
+static void	eval_profile_function ( eval_function  function, int  argc, eval_stats_time  elapsed, int  count )
+   {
+	eval_profile_add ( eval_profile_lookup ( eval_context, function ), argc, elapsed, count ) ;
+    }
+
+
+static void	eval_profile_operator ( int  opcode, eval_stats_time  elapsed, int  count )
+   {
+	eval_profile_add ( eval_context -> operator_profile + opcode, ( EVAL_OPCODE_IS_UNARY ( opcode ) ) ?  1 : 2, elapsed, count ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_profile_reset -
+        Clears the profile of a context, and frees its function table.
+
+  ==============================================================================================================*/
+static void	eval_profile_reset ( evaluator_context *  context )
+   {
+	if  ( context -> function_profile  !=  NULL )
+		eval_free ( context -> function_profile ) ;
+
+	context -> function_profile		=  NULL ;
+	context -> function_profile_size	=  0 ;
+	context -> function_profile_count	=  0 ;
+	memset ( context -> operator_profile, 0, sizeof ( context -> operator_profile ) ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_profile_merge -
+        Adds the profile of one context to another one, and resets it.
+
+  ==============================================================================================================*/
+static void	eval_profile_sum ( evaluator_profile_entry *  target, const evaluator_profile_entry *  source )
+   {
+	int		i ;
+
+
+	target -> calls		+=  source -> calls ;
+	target -> nanoseconds	+=  source -> nanoseconds ;
+
+	for  ( i = 0 ; i  <  EVAL_PROFILE_ARGC_BUCKETS ; i ++ )
+		target -> argc [i]	+=  source -> argc [i] ;
+    }
+
+
+static void	eval_profile_merge ( evaluator_context *  target, evaluator_context *  source )
+   {
+	int		i ;
+
+
+	for  ( i = 0 ; i  <  OPCODE_COUNT ; i ++ )
+		eval_profile_sum ( target -> operator_profile + i, source -> operator_profile + i ) ;
+
+	for  ( i = 0 ; i  <  source -> function_profile_size ; i ++ )
+	   {
+		if  ( source -> function_profile [i]. function  !=  NULL )
+			eval_profile_sum ( eval_profile_lookup ( target, source -> function_profile [i]. function ), & source -> function_profile [i]. entry ) ;
+	    }
+
+	eval_profile_reset ( source ) ;
+    }
+
+
+/*==============================================================================================================
+
+	Profiling macros. EVAL_PROFILE_DECLARE() declares the variable holding the start time of a measure,
+	and must be used without a trailing semicolon.
+
+  ==============================================================================================================*/
+# define	EVAL_PROFILE_DECLARE( start )				eval_stats_time  start ;
+# define	EVAL_PROFILE_START( start )				( start = eval_stats_now ( ) )
+# define	EVAL_PROFILE_FUNCTION( function, argc, start, count )	eval_profile_function ( function, argc, eval_stats_now ( ) - start, count )
+# define	EVAL_PROFILE_OPERATOR( opcode, start, count )		eval_profile_operator ( opcode, eval_stats_now ( ) - start, count )
+
+# else		/*  EVAL_PROFILER  */
+
+# define	EVAL_PROFILE_DECLARE( start )
+# define	EVAL_PROFILE_START( start )				( ( void ) 0 )
+# define	EVAL_PROFILE_FUNCTION( function, argc, start, count )	( ( void ) 0 )
+# define	EVAL_PROFILE_OPERATOR( opcode, start, count )		( ( void ) 0 )
+
+# endif		/*  EVAL_PROFILER  */
@@ -0,0 +1,496 @@
+/**************************************************************************************************************
+
+    NAME
+        evalthreads.h
+
+    DESCRIPTION
+        Thread pool for parallel batch evaluation.
+	This file is included by eval.c
+
+	The rows given to evaluator_run_parallel() are split into chunks, whose input and output values fit
+	into the processor cache. Chunks are claimed one after the other, through an atomic counter, by the
+	calling thread and by the threads of a pool which is created the first time it is needed and kept
+	for subsequent calls. Each pool thread owns a scratch area for eval_batch_compute(), which is only
+	reallocated when a program needs a bigger one.
+
+	Only one parallel evaluation can use the pool at a time ; other threads calling evaluator_run_parallel()
+	meanwhile (or callbacks running on pool threads) evaluate their rows without using the pool.
+
+	The calling thread also computes all the rows by itself when the estimated cost of the job, ie the number
+	of rows multiplied by the cost of the program, is too small to pay for waking up the pool, or when the
+	program calls a function that is not thread-safe.
+
+    AUTHOR
+        Christian Vigh, 09/2015.
+
+    HISTORY
+    [Version : 1.0]    [Date : 2015/09/17]     [Author : CV]
+        Initial version.
+
+ **************************************************************************************************************/
+
+# ifndef	WIN32
+#	include	<unistd.h>
+# endif
+
+
+/*==============================================================================================================
+
+	Number of bytes of input and output values processed by a chunk of rows. The default value fits into
+	the L2 cache of most processors.
+
+  ==============================================================================================================*/
+# ifndef	EVAL_PARALLEL_CHUNK_SIZE
+#	define	EVAL_PARALLEL_CHUNK_SIZE	( 128 * 1024 )
+# endif
+
+// Minimum number of chunks per thread, so that threads that are faster than others can claim more chunks
+# define	EVAL_PARALLEL_CHUNKS_PER_THREAD		4
+
+// Minimum cost of a job for the pool to be used, an arithmetic operator on one row costing 1
+# ifndef	EVAL_PARALLEL_MIN_COST
+#	define	EVAL_PARALLEL_MIN_COST		( 64 * 1024 )
+# endif
+
+
+/*==============================================================================================================
+
+	Portable threading primitives.
+
+  ==============================================================================================================*/
+# ifdef		WIN32
+	typedef HANDLE				eval_thread ;
+	typedef SRWLOCK				eval_mutex ;
+	typedef CONDITION_VARIABLE		eval_condition ;
+	typedef LPTHREAD_START_ROUTINE		eval_thread_function ;
+
+#	define	EVAL_MUTEX_INITIALIZER		SRWLOCK_INIT
+#	define	EVAL_CONDITION_INITIALIZER	CONDITION_VARIABLE_INIT
+#	define	eval_mutex_lock( m )		AcquireSRWLockExclusive ( m )
+#	define	eval_mutex_unlock( m )		ReleaseSRWLockExclusive ( m )
+#	define	eval_condition_wait( c, m )	SleepConditionVariableSRW ( c, m, INFINITE, 0 )
+#	define	eval_condition_broadcast( c )	WakeAllConditionVariable ( c )
+#	define	eval_atomic_increment( p )	( InterlockedIncrement ( p ) - 1 )
+
+#	define	EVAL_THREAD_FUNCTION( name, arg )	static DWORD WINAPI  name ( LPVOID  arg )
+#	define	EVAL_THREAD_RETURN			return ( 0 )
+# else
+	typedef pthread_t			eval_thread ;
+	typedef pthread_mutex_t			eval_mutex ;
+	typedef pthread_cond_t			eval_condition ;
+	typedef void *				( * eval_thread_function ) ( void * ) ;
+
+#	define	EVAL_MUTEX_INITIALIZER		PTHREAD_MUTEX_INITIALIZER
+#	define	EVAL_CONDITION_INITIALIZER	PTHREAD_COND_INITIALIZER
+#	define	eval_mutex_lock( m )		pthread_mutex_lock ( m )
+#	define	eval_mutex_unlock( m )		pthread_mutex_unlock ( m )
+#	define	eval_condition_wait( c, m )	pthread_cond_wait ( c, m )
+#	define	eval_condition_broadcast( c )	pthread_cond_broadcast ( c )
+#	define	eval_atomic_increment( p )	__sync_fetch_and_add ( p, 1 )
+
+#	define	EVAL_THREAD_FUNCTION( name, arg )	static void *  name ( void *  arg )
+#	define	EVAL_THREAD_RETURN			return ( NULL )
+# endif
+
+
+static int	eval_thread_create ( eval_thread *  thread, eval_thread_function  function, void *  arg )
+   {
+# ifdef		WIN32
+	* thread	=  CreateThread ( NULL, 0, function, arg, 0, NULL ) ;
+
+	return ( * thread  !=  NULL ) ;
+# else
+	return ( ! pthread_create ( thread, NULL, function, arg ) ) ;
+# endif
+    }
+
+
+static void	eval_thread_join ( eval_thread  thread )
+   {
+# ifdef		WIN32
+	WaitForSingleObject ( thread, INFINITE ) ;
+	CloseHandle ( thread ) ;
+# else
+	pthread_join ( thread, NULL ) ;
+# endif
+    }
+
+
+static int	eval_processor_count ( )
+   {
+	int		count ;
+
+# ifdef		WIN32
+	count	=  ( int ) GetActiveProcessorCount ( ALL_PROCESSOR_GROUPS ) ;
+# else
+	count	=  ( int ) sysconf ( _SC_NPROCESSORS_ONLN ) ;
+# endif
+
+	return ( ( count  <  1 ) ?  1 : count ) ;
+    }
+
+
+/*==============================================================================================================
+
+	Pool structures.
+
+  ==============================================================================================================*/
+
+// A parallel evaluation request
+typedef struct  eval_parallel_job
+   {
+	const evaluator_program *	program ;			// Program to be computed
+	int				rows ;				// Total number of rows
+	const double **			columns ;			// Input columns, indexed by variable slot
+	double *			output ;			// Output column
+	int				chunk_rows ;			// Number of rows in a chunk
+	int				chunk_count ;			// Number of chunks
+	int				use_degrees ;			// Trigonometric units of the calling context
+	volatile long			next_chunk ;			// Next chunk to be claimed
+	volatile long			failed ;			// Set to 1 when a chunk could not be computed
+	int				error_number ;			// Error information for the first failed chunk
+	char				error_message [ 1024 ] ;
+    }  eval_parallel_job ;
+
+
+// A pool thread
+typedef struct  eval_worker
+   {
+	eval_thread			thread ;			// Thread handle
+	unsigned int			generation ;			// Last job generation seen by this thread
+	void *				scratch ;			// Scratch area for eval_batch_compute()
+	size_t				scratch_size ;			// Size of the scratch area, in bytes
+	evaluator_context		context ;			// Context receiving errors on this thread
+    }  eval_worker ;
+
+
+// The pool itself
+static struct
+   {
+	eval_mutex			lock ;				// Protects the fields below
+	eval_condition			wakeup ;			// Signaled when a job is submitted or on shutdown
+	eval_condition			done ;				// Signaled when the last thread has finished a job
+	int				requested_threads ;		// Thread count set by evaluator_set_thread_count() (0 = processor count)
+	int				worker_count ;			// Number of running pool threads (the calling thread is not counted)
+	eval_worker *			workers ;			// Pool threads
+	eval_parallel_job *		job ;				// Job being processed
+	unsigned int			generation ;			// Incremented each time a job is submitted
+	int				active ;			// Pool threads that have not finished the current job yet
+	int				busy ;				// Non-zero when a thread is using the pool
+	int				shutdown ;			// Non-zero when pool threads must exit
+    }  eval_pool	=  { EVAL_MUTEX_INITIALIZER, EVAL_CONDITION_INITIALIZER, EVAL_CONDITION_INITIALIZER, 0, 0, NULL, NULL, 0, 0, 0, 0 } ;
+
+
+/*==============================================================================================================
+
+    eval_parallel_fail -
+        Marks a job as failed, keeping the error information of the current context if no other thread failed
+	before.
+
+  ==============================================================================================================*/
+static void	eval_parallel_fail ( eval_parallel_job *  job )
+   {
+	eval_mutex_lock ( & eval_pool. lock ) ;
+
+	if  ( ! job -> failed )
+	   {
+		job -> error_number	=  eval_context -> error_number ;
+		strcpy ( job -> error_message, eval_context -> error_message ) ;
+		job -> failed		=  1 ;
+	    }
+
+	eval_mutex_unlock ( & eval_pool. lock ) ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_parallel_run_chunks -
+        Claims chunks of the specified job and computes them, until there are no chunks left or a chunk failed.
+	scratch must be at least eval_batch_scratch_size ( job -> program ) bytes.
+
+  ==============================================================================================================*/
+static void	eval_parallel_run_chunks ( eval_parallel_job *  job, void *  scratch )
+   {
+	long		chunk ;
+	int		start, end ;
+
+
+	while  ( ! job -> failed  &&  ( chunk = eval_atomic_increment ( & job -> next_chunk ) )  <  job -> chunk_count )
+	   {
+		start	=  ( int ) chunk * job -> chunk_rows ;
+		end	=  ( job -> rows - start  <  job -> chunk_rows ) ?  job -> rows : start + job -> chunk_rows ;
+
+		if  ( ! eval_batch_compute ( job -> program, start, end, job -> columns, job -> output, scratch ) )
+			eval_parallel_fail ( job ) ;
+	    }
+    }
+
+
+/*==============================================================================================================
+
+    eval_worker_main -
+        Main loop of a pool thread : waits for a job, then computes chunks of it.
+
+  ==============================================================================================================*/
+EVAL_THREAD_FUNCTION ( eval_worker_main, arg )
+   {
+	eval_worker *		worker		=  ( eval_worker * ) arg ;
+	eval_parallel_job *	job ;
+	void *			scratch ;
+	size_t			size ;
+
+
+	eval_context	=  & worker -> context ;
+
+	eval_mutex_lock ( & eval_pool. lock ) ;
+
+	while  ( 1 )
+	   {
+		while  ( ! eval_pool. shutdown  &&  worker -> generation  ==  eval_pool. generation )
+			eval_condition_wait ( & eval_pool. wakeup, & eval_pool. lock ) ;
+
+		if  ( eval_pool. shutdown )
+			break ;
+
+		worker -> generation	=  eval_pool. generation ;
+		job			=  eval_pool. job ;
+
+		eval_mutex_unlock ( & eval_pool. lock ) ;
+
+		// Grow the scratch area if needed ; a thread that cannot do it leaves its share of the work to the others
+		size	=  eval_batch_scratch_size ( job -> program ) ;
+
+		if  ( size  >  worker -> scratch_size )
+		   {
+			scratch		=  eval_realloc ( worker -> scratch, size ) ;
+
+			if  ( scratch  !=  NULL )
+			   {
+				worker -> scratch	=  scratch ;
+				worker -> scratch_size	=  size ;
+			    }
+		    }
+
+		if  ( size  <=  worker -> scratch_size )
+		   {
+			eval_use_degrees	=  job -> use_degrees ;
+			eval_parallel_run_chunks ( job, worker -> scratch ) ;
+		    }
+
+		eval_mutex_lock ( & eval_pool. lock ) ;
+
+		if  ( ! -- eval_pool. active )
+			eval_condition_broadcast ( & eval_pool. done ) ;
+	    }
+
+	eval_mutex_unlock ( & eval_pool. lock ) ;
+
+	EVAL_THREAD_RETURN ;
+    }
+
+
+/*==============================================================================================================
+
+    eval_pool_resize -
+        Stops the running pool threads, if any, then starts the specified number of new ones.
+	Must be called by the thread that has set the eval_pool. busy flag, without holding the pool lock.
+
+  ==============================================================================================================*/
+static void	eval_pool_resize ( int  count )
+   {
+	int		i ;
+
+
+	// Stop existing threads
+	if  ( eval_pool. worker_count )
+	   {
+		eval_mutex_lock ( & eval_pool. lock ) ;
+		eval_pool. shutdown	=  1 ;
+		eval_condition_broadcast ( & eval_pool. wakeup ) ;
+		eval_mutex_unlock ( & eval_pool. lock ) ;
+
+		for  ( i = 0 ; i  <  eval_pool. worker_count ; i ++ )
+		   {
+			eval_thread_join ( eval_pool. workers [i]. thread ) ;
+
+			if  ( eval_pool. workers [i]. scratch  !=  NULL )
+				eval_free ( eval_pool. workers [i]. scratch ) ;
+		    }
+
+		eval_free ( eval_pool. workers ) ;
+		eval_pool. workers	=  NULL ;
+		eval_pool. worker_count	=  0 ;
+		eval_pool. shutdown	=  0 ;
+	    }
+
+	if  ( count  <=  0 )
+		return ;
+
+	// Then start new ones ; threads that could not be created are simply not used
+	eval_pool. workers	=  ( eval_worker * ) eval_malloc ( count * sizeof ( eval_worker ) ) ;
+
+	if  ( eval_pool. workers  ==  NULL )
+		return ;
+
+	for  ( i = 0 ; i  <  count ; i ++ )
+	   {
+		eval_worker *	worker	=  eval_pool. workers + eval_pool. worker_count ;
+
+
+		worker -> generation			=  eval_pool. generation ;
+		worker -> scratch			=  NULL ;
+		worker -> scratch_size			=  0 ;
+		worker -> context. error_number		=  E_EVAL_OK ;
+		* worker -> context. error_message	=  '\0' ;
+		worker -> context. use_degrees		=  0 ;
+# if	EVAL_INSTRUMENTATION
+		memset ( & worker -> context. statistics, 0, sizeof ( worker -> context. statistics ) ) ;
+# endif
+# if	EVAL_PROFILER
+		worker -> context. function_profile	=  NULL ;
+		eval_profile_reset ( & worker -> context ) ;
+# endif
+
+		if  ( ! eval_thread_create ( & worker -> thread, eval_worker_main, worker ) )
+			break ;
+
+		eval_pool. worker_count ++ ;
+	    }
+    }
+
+
+/*==============================================================================================================
+
+    eval_parallel_compute -
+        Computes a program over the specified number of rows, using the thread pool if possible.
+
+  ==============================================================================================================*/
+static int	eval_parallel_compute ( const evaluator_program *  program, int  rows, const double **  columns, double *  output )
+   {
+	eval_parallel_job	job ;
+	int			thread_count ;
+	int			chunk_rows ;
+	void *			scratch ;
+	int			use_pool ;
+	int			i ;
+
+
+	eval_mutex_lock ( & eval_pool. lock ) ;
+	thread_count	=  eval_pool. requested_threads ;
+	eval_mutex_unlock ( & eval_pool. lock ) ;
+
+	if  ( thread_count  <=  0 )
+		thread_count	=  eval_processor_count ( ) ;
+
+	// Small jobs, and programs calling functions that are not thread-safe, are computed by the calling thread
+	if  ( ( double ) rows * program -> cost  <  EVAL_PARALLEL_MIN_COST )
+		thread_count	=  1 ;
+
+	for  ( i = 0 ; i  <  program -> function_count ; i ++ )
+	   {
+		if  ( ! EVAL_FUNCTION_IS_THREAD_SAFE ( program -> function_flags [i] ) )
+			thread_count	=  1 ;
+	    }
+
+	// Chunk size is given by the number of input and output values that fit into EVAL_PARALLEL_CHUNK_SIZE bytes,
+	// but chunks must be small enough for each thread to receive several of them
+	chunk_rows	=  EVAL_PARALLEL_CHUNK_SIZE / ( ( program -> variable_count + 1 ) * sizeof ( double ) ) ;
+
+	if  ( chunk_rows  >  rows / ( thread_count * EVAL_PARALLEL_CHUNKS_PER_THREAD ) )
+		chunk_rows	=  rows / ( thread_count * EVAL_PARALLEL_CHUNKS_PER_THREAD ) ;
+
+	chunk_rows	-=  chunk_rows % EVAL_BATCH_BLOCK_SIZE ;
+
+	if  ( chunk_rows  <  EVAL_BATCH_BLOCK_SIZE )
+		chunk_rows	=  EVAL_BATCH_BLOCK_SIZE ;
+
+	job. program		=  program ;
+	job. rows		=  rows ;
+	job. columns		=  columns ;
+	job. output		=  output ;
+	job. chunk_rows		=  chunk_rows ;
+	job. chunk_count	=  ( rows + chunk_rows - 1 ) / chunk_rows ;
+	job. use_degrees	=  eval_use_degrees ;
+	job. next_chunk		=  0 ;
+	job. failed		=  0 ;
+
+	// Try to acquire the pool ; if it is already in use, the calling thread will compute all the chunks
+	use_pool	=  0 ;
+
+	if  ( thread_count  >  1  &&  job. chunk_count  >  1 )
+	   {
+		eval_mutex_lock ( & eval_pool. lock ) ;
+
+		if  ( ! eval_pool. busy )
+		   {
+			eval_pool. busy		=  1 ;
+			use_pool		=  1 ;
+		    }
+
+		eval_mutex_unlock ( & eval_pool. lock ) ;
+	    }
+
+	if  ( use_pool )
+	   {
+		if  ( eval_pool. worker_count  !=  thread_count - 1 )
+			eval_pool_resize ( thread_count - 1 ) ;
+
+		eval_mutex_lock ( & eval_pool. lock ) ;
+		eval_pool. job		=  & job ;
+		eval_pool. active	=  eval_pool. worker_count ;
+		eval_pool. generation ++ ;
+		eval_condition_broadcast ( & eval_pool. wakeup ) ;
+		eval_mutex_unlock ( & eval_pool. lock ) ;
+	    }
+
+	// The calling thread takes its share of the work ; if it cannot, the job fails and pool threads stop
+	// claiming chunks
+	scratch		=  eval_malloc ( eval_batch_scratch_size ( program ) ) ;
+
+	if  ( scratch  ==  NULL )
+	   {
+		eval_error ( E_EVAL_OUT_OF_MEMORY, -1, -1, "Cannot allocate the scratch memory needed to compute a batch" ) ;
+		eval_parallel_fail ( & job ) ;
+	    }
+	else
+	   {
+		eval_parallel_run_chunks ( & job, scratch ) ;
+		eval_free ( scratch ) ;
+	    }
+
+	// Wait for pool threads to complete
+	if  ( use_pool )
+	   {
+		eval_mutex_lock ( & eval_pool. lock ) ;
+
+		while  ( eval_pool. active )
+			eval_condition_wait ( & eval_pool. done, & eval_pool. lock ) ;
+
+# if	EVAL_INSTRUMENTATION
+		// Pool threads are idle until the next job, so their statistics can be collected
+		for  ( i = 0 ; i  <  eval_pool. worker_count ; i ++ )
+			eval_stats_merge ( & eval_context -> statistics, & eval_pool. workers [i]. context. statistics ) ;
+# endif
+
+# if	EVAL_PROFILER
+		// Same for their profile, which also releases their function tables
+		for  ( i = 0 ; i  <  eval_pool. worker_count ; i ++ )
+			eval_profile_merge ( eval_context, & eval_pool. workers [i]. context ) ;
+# endif
+
+		eval_pool. job		=  NULL ;
+		eval_pool. busy		=  0 ;
+		eval_mutex_unlock ( & eval_pool. lock ) ;
+	    }
+
+	if  ( job. failed )
+	   {
+		eval_context -> error_number	=  job. error_number ;
+		strcpy ( eval_context -> error_message, job. error_message ) ;
+
+		return ( 0 ) ;
+	    }
+
+	return ( 1 ) ;
+    }